@@ -10,7 +10,7 @@
 *********************************************************************/
 
 #ifndef DES_H
-#define DESH
+#define DES_H
 
 /*************************** HEADER FILES ***************************/
 #include <stddef.h>
@@ -21,6 +21,7 @@
 /**************************** DATA TYPES ****************************/
 typedef unsigned char BYTE;             // 8-bit byte
 typedef unsigned int  WORD;             // 32-bit word, change to "long" for 16-bit machines
+typedef unsigned long long QWORD;       // 64-bit word
 
 typedef enum {
 	DES_ENCRYPT,
@@ -28,6 +29,10 @@ typedef enum {
 } DES_MODE;
 
 /*********************** FUNCTION DECLARATIONS **********************/
+void IP(WORD state[], const BYTE in[]);
+void InvIP(WORD state[], BYTE in[]);
+WORD f(WORD state, const BYTE key[]);
+
 void des_key_setup(const BYTE key[], BYTE schedule[][6], DES_MODE mode);
 void des_crypt(const BYTE in[], BYTE out[], const BYTE key[][6]);
 
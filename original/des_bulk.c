@@ -0,0 +1,252 @@
+/*********************************************************************
+* Filename:   des_bulk.c
+* Copyright:
+* Disclaimer: This code is presented "as is" without any guarantees.
+* Details:    Multi-block DES and triple DES in ECB and CTR mode. The
+              tables are built once from the functions of des.c: f(0,K)
+              is the XOR of the 8 S-Box/P-Box outputs for the 6 bit key
+              pieces, IP() and InvIP() are linear in their input bytes.
+              DES_BULK_LANES blocks go through the rounds together, so
+              their table lookups overlap. CTR mode splits big buffers
+              into chunks that are the work items of parallel_run().
+*********************************************************************/
+
+/*************************** HEADER FILES ***************************/
+#include <stdlib.h>
+#include <memory.h>
+#include <pthread.h>
+#include "des_bulk.h"
+#include "des_parallel.h"
+
+/****************************** MACROS ******************************/
+// The 6 bits of "a" that the expansion feeds into S-Box "s" (0..7)
+#define EXPANDED(a,s) ((((a) << ((4*(s)+31) & 31)) | ((a) >> ((33-4*(s)) & 31))) >> 26)
+
+/**************************** DATA TYPES ****************************/
+typedef struct {
+	const BYTE *in;
+	BYTE *out;
+	size_t length;
+	QWORD counter;
+	const DES_BULK_KEY *key;
+} CTR_JOB;
+
+/**************************** VARIABLES *****************************/
+static WORD sp[8][64];                  // f() is sp[0][E0 ^ K0] ^ ... ^ sp[7][E7 ^ K7]
+static QWORD ip[8][256];                // IP() of one input byte, state[0] in the high half
+static QWORD inv_ip[8][256];            // InvIP() of one state byte, output byte 0 in the high byte
+static pthread_once_t tables_once = PTHREAD_ONCE_INIT;
+
+/*********************** FUNCTION DEFINITIONS ***********************/
+static void qword_to_block(QWORD word, BYTE block[])
+{
+	int i;
+
+	for (i = DES_BLOCK_SIZE - 1; i >= 0; --i, word >>= 8)
+		block[i] = word & 0xFF;
+}
+
+static QWORD block_to_qword(const BYTE block[])
+{
+	QWORD word = 0;
+	int i;
+
+	for (i = 0; i < DES_BLOCK_SIZE; ++i)
+		word = (word << 8) | block[i];
+	return word;
+}
+
+static void build_tables(void)
+{
+	BYTE block[DES_BLOCK_SIZE], key[6];
+	WORD state[2], zero;
+	int s, x, i;
+
+	// f(0,K) has the pieces sp[s][K_s] ^ sp[s][0] of all S-Boxes, f(0,0) is folded into sp[0]
+	memset(key, 0, sizeof(key));
+	zero = f(0, key);
+	for (s = 0; s < 8; ++s) {
+		for (x = 0; x < 64; ++x) {
+			qword_to_block((QWORD)x << (42 - 6 * s), block);
+			memcpy(key, &block[2], sizeof(key));
+			sp[s][x] = f(0, key) ^ ((s > 0) ? zero : 0);
+		}
+	}
+
+	for (i = 0; i < DES_BLOCK_SIZE; ++i) {
+		for (x = 0; x < 256; ++x) {
+			memset(block, 0, sizeof(block));
+			block[i] = x;
+			IP(state, block);
+			ip[i][x] = ((QWORD)state[0] << 32) | state[1];
+
+			state[0] = (i < 4) ? (WORD)x << (24 - 8 * i) : 0;
+			state[1] = (i < 4) ? 0 : (WORD)x << (56 - 8 * i);
+			InvIP(state, block);
+			inv_ip[i][x] = block_to_qword(block);
+		}
+	}
+}
+
+static inline QWORD initial_permutation(QWORD block)
+{
+	return ip[0][block >> 56] | ip[1][(block >> 48) & 0xFF] | ip[2][(block >> 40) & 0xFF] | ip[3][(block >> 32) & 0xFF] |
+	       ip[4][(block >> 24) & 0xFF] | ip[5][(block >> 16) & 0xFF] | ip[6][(block >> 8) & 0xFF] | ip[7][block & 0xFF];
+}
+
+static inline QWORD final_permutation(QWORD state)
+{
+	return inv_ip[0][state >> 56] | inv_ip[1][(state >> 48) & 0xFF] | inv_ip[2][(state >> 40) & 0xFF] | inv_ip[3][(state >> 32) & 0xFF] |
+	       inv_ip[4][(state >> 24) & 0xFF] | inv_ip[5][(state >> 16) & 0xFF] | inv_ip[6][(state >> 8) & 0xFF] | inv_ip[7][state & 0xFF];
+}
+
+static inline WORD f_sp(WORD r, const BYTE k[])
+{
+	return sp[0][EXPANDED(r,0) ^ k[0]] ^ sp[1][EXPANDED(r,1) ^ k[1]] ^ sp[2][EXPANDED(r,2) ^ k[2]] ^ sp[3][EXPANDED(r,3) ^ k[3]] ^
+	       sp[4][EXPANDED(r,4) ^ k[4]] ^ sp[5][EXPANDED(r,5) ^ k[5]] ^ sp[6][EXPANDED(r,6) ^ k[6]] ^ sp[7][EXPANDED(r,7) ^ k[7]];
+}
+
+// The rounds of des_crypt() (or three of them) for DES_BULK_LANES states after IP()
+static inline void crypt_lanes(QWORD state[], const DES_BULK_KEY *key)
+{
+	WORD l[DES_BULK_LANES], r[DES_BULK_LANES], t;
+	int i, j;
+
+	for (j = 0; j < DES_BULK_LANES; ++j) {
+		l[j] = state[j] >> 32;
+		r[j] = (WORD)state[j];
+	}
+	for (i = 0; i < key->rounds; ++i) {
+		for (j = 0; j < DES_BULK_LANES; ++j) {
+			t = r[j];
+			r[j] = l[j] ^ f_sp(r[j], key->subkey[i]);
+			l[j] = t;
+		}
+		// the last round of every DES does not swap, the next DES starts on the same state
+		if (i % 16 == 15) {
+			for (j = 0; j < DES_BULK_LANES; ++j) {
+				t = l[j];
+				l[j] = r[j];
+				r[j] = t;
+			}
+		}
+	}
+	for (j = 0; j < DES_BULK_LANES; ++j)
+		state[j] = ((QWORD)l[j] << 32) | r[j];
+}
+
+// ECB on 64-bit blocks, a last group of less than DES_BULK_LANES blocks is padded
+static void crypt_words(const QWORD in[], QWORD out[], size_t number_of_blocks, const DES_BULK_KEY *key)
+{
+	QWORD state[DES_BULK_LANES];
+	size_t i;
+	int j, lanes;
+
+	for (i = 0; i < number_of_blocks; i += lanes) {
+		lanes = (number_of_blocks - i < DES_BULK_LANES) ? (int)(number_of_blocks - i) : DES_BULK_LANES;
+		for (j = 0; j < DES_BULK_LANES; ++j)
+			state[j] = (j < lanes) ? initial_permutation(in[i + j]) : 0;
+		crypt_lanes(state, key);
+		for (j = 0; j < lanes; ++j)
+			out[i + j] = final_permutation(state[j]);
+	}
+}
+
+static void subkey_pieces(const BYTE schedule[], BYTE subkey[])
+{
+	QWORD k = 0;
+	int i;
+
+	for (i = 0; i < 6; ++i)
+		k = (k << 8) | schedule[i];
+	for (i = 0; i < 8; ++i)
+		subkey[i] = (k >> (42 - 6 * i)) & 0x3F;
+}
+
+void des_bulk_key_setup(const BYTE key[], DES_BULK_KEY *bulk, DES_MODE mode)
+{
+	BYTE schedule[16][6];
+	int i;
+
+	pthread_once(&tables_once, build_tables);
+	des_key_setup(key, schedule, mode);
+	for (i = 0; i < 16; ++i)
+		subkey_pieces(schedule[i], bulk->subkey[i]);
+	bulk->rounds = 16;
+}
+
+void three_des_bulk_key_setup(const BYTE key[], DES_BULK_KEY *bulk, DES_MODE mode)
+{
+	BYTE schedule[3][16][6];
+	int i;
+
+	pthread_once(&tables_once, build_tables);
+	three_des_key_setup(key, schedule, mode);
+	for (i = 0; i < 48; ++i)
+		subkey_pieces(schedule[i / 16][i % 16], bulk->subkey[i]);
+	bulk->rounds = 48;
+}
+
+void des_ecb_encrypt_blocks(const BYTE in[][DES_BLOCK_SIZE], BYTE out[][DES_BLOCK_SIZE], size_t number_of_blocks, const DES_BULK_KEY *key)
+{
+	QWORD words[DES_BULK_BATCH];
+	size_t i, j, batch;
+
+	for (i = 0; i < number_of_blocks; i += batch) {
+		batch = (number_of_blocks - i < DES_BULK_BATCH) ? number_of_blocks - i : DES_BULK_BATCH;
+		for (j = 0; j < batch; ++j)
+			words[j] = block_to_qword(in[i + j]);
+		crypt_words(words, words, batch, key);
+		for (j = 0; j < batch; ++j)
+			qword_to_block(words[j], out[i + j]);
+	}
+}
+
+// Bytes offset .. offset+length-1 of the key stream, offset is a multiple of the block size
+static void ctr_range(const BYTE in[], BYTE out[], size_t offset, size_t length, QWORD counter, const DES_BULK_KEY *key)
+{
+	QWORD stream[DES_BULK_BATCH];
+	BYTE block[DES_BLOCK_SIZE];
+	size_t i, j, b, batch, blocks = (length + DES_BLOCK_SIZE - 1) / DES_BLOCK_SIZE;
+
+	counter += offset / DES_BLOCK_SIZE;
+	for (i = 0; i < blocks; i += batch) {
+		batch = (blocks - i < DES_BULK_BATCH) ? blocks - i : DES_BULK_BATCH;
+		for (j = 0; j < batch; ++j)
+			stream[j] = counter + i + j;
+		crypt_words(stream, stream, batch, key);
+		for (j = 0; j < batch; ++j) {
+			qword_to_block(stream[j], block);
+			for (b = 0; b < DES_BLOCK_SIZE && (i + j) * DES_BLOCK_SIZE + b < length; ++b)
+				out[offset + (i + j) * DES_BLOCK_SIZE + b] = in[offset + (i + j) * DES_BLOCK_SIZE + b] ^ block[b];
+		}
+	}
+}
+
+// XORs the key stream into chunk "item" of the buffer
+static int ctr_chunk(void *arg, int worker, QWORD item)
+{
+	CTR_JOB *job = arg;
+	size_t offset = item * DES_BULK_CHUNK;
+
+	ctr_range(job->in, job->out, offset, (job->length - offset < DES_BULK_CHUNK) ? job->length - offset : DES_BULK_CHUNK,
+	          job->counter, job->key);
+	return 0;
+}
+
+int des_ctr_xor(const BYTE in[], BYTE out[], size_t length, const BYTE counter[], const DES_BULK_KEY *key, int threads)
+{
+	CTR_JOB job;
+
+	if (key->rounds != 16 && key->rounds != 48)
+		return -1;
+	if (length < DES_BULK_PARALLEL_MIN)
+		threads = 1;
+
+	job.in = in;
+	job.out = out;
+	job.length = length;
+	job.counter = block_to_qword(counter);
+	job.key = key;
+	return parallel_run(ctr_chunk, &job, (length + DES_BULK_CHUNK - 1) / DES_BULK_CHUNK, threads);
+}
@@ -0,0 +1,44 @@
+/*********************************************************************
+* Filename:   des_bulk.h
+* Copyright:
+* Disclaimer: This code is presented "as is" without any guarantees.
+* Details:    Defines the API for multi-block DES and triple DES in
+              ECB and CTR mode. The blocks are kept in 64-bit words,
+              the S-Box and P-Box of a round are 8 table lookups and
+              IP/InvIP are byte tables, all built from IP(), InvIP()
+              and f() in des.c. Triple DES runs the 48 rounds on one
+              state, the InvIP/IP pairs between the stages cancel.
+              Like des_crypt(), the direction of ECB is the one of the
+              key setup.
+*********************************************************************/
+
+#ifndef DES_BULK_H
+#define DES_BULK_H
+
+/*************************** HEADER FILES ***************************/
+#include <stddef.h>
+#include "des.h"
+
+/****************************** MACROS ******************************/
+#define DES_BULK_LANES 4                // blocks interleaved in the rounds loop
+#define DES_BULK_BATCH 64               // counter blocks generated at once in CTR mode
+#define DES_BULK_CHUNK 65536            // bytes per work item of the threads in CTR mode
+#define DES_BULK_PARALLEL_MIN (1 << 20) // smaller CTR buffers are done by the calling thread
+
+/**************************** DATA TYPES ****************************/
+typedef struct {
+	BYTE subkey[48][8];                 // the 6 bit pieces of the subkeys, S-Box 1 first
+	int rounds;                         // 16 for DES, 48 for triple DES
+} DES_BULK_KEY;
+
+/*********************** FUNCTION DECLARATIONS **********************/
+void des_bulk_key_setup(const BYTE key[], DES_BULK_KEY *bulk, DES_MODE mode);
+// The 24 key bytes of three_des_key_setup()
+void three_des_bulk_key_setup(const BYTE key[], DES_BULK_KEY *bulk, DES_MODE mode);
+void des_ecb_encrypt_blocks(const BYTE in[][DES_BLOCK_SIZE], BYTE out[][DES_BLOCK_SIZE], size_t number_of_blocks, const DES_BULK_KEY *key);
+// out = in ^ E(counter) || E(counter + 1) || ..., the counter is a big endian 64-bit number.
+// The key has to be an encryption key of DES or triple DES, the same call decrypts. Buffers
+// of DES_BULK_PARALLEL_MIN bytes or more are split over "threads" threads (0 is all cores).
+int des_ctr_xor(const BYTE in[], BYTE out[], size_t length, const BYTE counter[], const DES_BULK_KEY *key, int threads);
+
+#endif   // DES_BULK_H
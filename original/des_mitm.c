@@ -0,0 +1,294 @@
+/*********************************************************************
+* Filename:   des_mitm.c
+* Copyright:
+* Disclaimer: This code is presented "as is" without any guarantees.
+* Details:    Meet-in-the-middle attacks on double DES and two-key
+              triple DES. The forward key space is split into passes
+              that fit the memory: a pass computes the middle values of
+              its keys in parallel, puts them into an open addressing
+              hash table (linear probing, at most half full) and then
+              all backward keys are looked up in parallel. A match in
+              the middle is checked with a second pair.
+*********************************************************************/
+
+/*************************** HEADER FILES ***************************/
+#include <stdlib.h>
+#include <memory.h>
+#include <time.h>
+#include <pthread.h>
+#include "des_mitm.h"
+#include "des_parallel.h"
+
+/****************************** MACROS ******************************/
+#define MITM_EMPTY 0xFFFFFFFF           // index of a free table entry
+
+/**************************** DATA TYPES ****************************/
+typedef struct {
+	QWORD middle;
+	WORD index;                         // forward key relative to the first key of the pass
+} MITM_ENTRY;
+
+typedef enum {
+	MITM_DOUBLE,
+	MITM_TRIPLE
+} MITM_ATTACK;
+
+typedef enum {
+	STAGE_CHOSEN,                       // the chosen plaintexts D_K1(0) of a pass
+	STAGE_FORWARD,                      // the middle values of a pass
+	STAGE_BACKWARD                      // the lookups of all backward keys
+} MITM_STAGE;
+
+typedef struct {
+	MITM_ATTACK attack;
+	const BYTE (*plain)[DES_BLOCK_SIZE];
+	const BYTE (*cipher)[DES_BLOCK_SIZE];
+	MITM_KEYSPACE k1;
+	MITM_KEYSPACE k2;
+	MITM_STAGE stage;
+	QWORD first;                        // forward keys first .. first+count-1 are in the table
+	QWORD count;
+	BYTE (*buffer)[DES_BLOCK_SIZE];
+	MITM_ENTRY *table;
+	QWORD table_mask;
+	QWORD number_of_keys;
+	QWORD candidates;                   // shared, atomic add
+	QWORD looked_up;                    // shared, atomic add
+	int found;                          // shared, stops all workers
+	BYTE key[2 * DES_BLOCK_SIZE];
+	pthread_mutex_t lock;
+} MITM_JOB;
+
+/**************************** VARIABLES *****************************/
+static const BYTE zero_block[DES_BLOCK_SIZE];
+
+/*********************** FUNCTION DEFINITIONS ***********************/
+static double seconds_since(const struct timespec *start)
+{
+	struct timespec now;
+
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return (now.tv_sec - start->tv_sec) + (now.tv_nsec - start->tv_nsec) / 1e9;
+}
+
+static QWORD block_word(const BYTE block[])
+{
+	QWORD word = 0;
+	int i;
+
+	for (i = 0; i < DES_BLOCK_SIZE; ++i)
+		word = (word << 8) | block[i];
+	return word;
+}
+
+void mitm_key(const MITM_KEYSPACE *space, QWORD index, BYTE key[])
+{
+	int i, bits;
+
+	// 7 bits per byte from the last byte on, the lowest bit of a byte is the parity bit
+	memcpy(key, space->base_key, DES_BLOCK_SIZE);
+	for (i = DES_BLOCK_SIZE - 1, bits = space->key_bits; i >= 0 && bits > 0; --i, bits -= 7, index >>= 7) {
+		if (bits >= 7)
+			key[i] = (key[i] & 0x01) | ((index & 0x7F) << 1);
+		else
+			key[i] = (key[i] & ~(((1 << bits) - 1) << 1)) | ((index & ((1 << bits) - 1)) << 1);
+	}
+}
+
+static void single_crypt(const MITM_KEYSPACE *space, QWORD index, DES_MODE mode, const BYTE in[], BYTE out[])
+{
+	BYTE key[DES_BLOCK_SIZE], schedule[16][6];
+
+	mitm_key(space, index, key);
+	des_key_setup(key, schedule, mode);
+	des_crypt(in, out, schedule);
+}
+
+static QWORD table_slot(const MITM_JOB *job, QWORD middle)
+{
+	return (middle * 0x9E3779B97F4A7C15ULL >> 32) & job->table_mask;
+}
+
+// Checks the keys of a match in the middle on the other pair
+static int verify(const MITM_JOB *job, QWORD i, QWORD j, BYTE key[])
+{
+	BYTE schedule[16][6], three_schedule[3][16][6], three_key[3 * DES_BLOCK_SIZE], buf[DES_BLOCK_SIZE];
+
+	mitm_key(&job->k1, i, &key[0]);
+	mitm_key(&job->k2, j, &key[DES_BLOCK_SIZE]);
+	if (job->attack == MITM_DOUBLE) {
+		des_key_setup(&key[0], schedule, DES_ENCRYPT);
+		des_crypt(job->plain[1], buf, schedule);
+		des_key_setup(&key[DES_BLOCK_SIZE], schedule, DES_ENCRYPT);
+		des_crypt(buf, buf, schedule);
+		return !memcmp(buf, job->cipher[1], DES_BLOCK_SIZE);
+	}
+	memcpy(three_key, key, 2 * DES_BLOCK_SIZE);
+	memcpy(&three_key[2 * DES_BLOCK_SIZE], key, DES_BLOCK_SIZE);
+	three_des_key_setup(three_key, three_schedule, DES_ENCRYPT);
+	three_des_crypt(job->plain[0], buf, three_schedule);
+	return !memcmp(buf, job->cipher[0], DES_BLOCK_SIZE);
+}
+
+static void backward_key(MITM_JOB *job, QWORD j, QWORD *candidates)
+{
+	BYTE middle[DES_BLOCK_SIZE], key[2 * DES_BLOCK_SIZE];
+	QWORD m, slot;
+
+	if (job->attack == MITM_DOUBLE)
+		single_crypt(&job->k2, j, DES_DECRYPT, job->cipher[0], middle);
+	else
+		single_crypt(&job->k2, j, DES_DECRYPT, zero_block, middle);
+	m = block_word(middle);
+
+	for (slot = table_slot(job, m); job->table[slot].index != MITM_EMPTY; slot = (slot + 1) & job->table_mask) {
+		if (job->table[slot].middle != m)
+			continue;
+		++*candidates;
+		if (verify(job, job->first + job->table[slot].index, j, key)) {
+			pthread_mutex_lock(&job->lock);
+			if (!job->found) {
+				memcpy(job->key, key, sizeof(job->key));
+				__atomic_store_n(&job->found, 1, __ATOMIC_RELAXED);
+			}
+			pthread_mutex_unlock(&job->lock);
+		}
+	}
+}
+
+// Runs the keys of chunk "item" through the stage, stops the other workers once the key is found
+static int mitm_chunk(void *arg, int worker, QWORD item)
+{
+	MITM_JOB *job = arg;
+	QWORD i, end, candidates = 0;
+
+	if (__atomic_load_n(&job->found, __ATOMIC_RELAXED))
+		return 1;
+	i = item * MITM_CHUNK_SIZE;
+	end = (i + MITM_CHUNK_SIZE < job->number_of_keys) ? i + MITM_CHUNK_SIZE : job->number_of_keys;
+	for ( ; i < end; ++i) {
+		if (job->stage == STAGE_CHOSEN)
+			single_crypt(&job->k1, job->first + i, DES_DECRYPT, zero_block, job->buffer[i]);
+		else if (job->stage == STAGE_FORWARD && job->attack == MITM_DOUBLE)
+			single_crypt(&job->k1, job->first + i, DES_ENCRYPT, job->plain[0], job->buffer[i]);
+		else if (job->stage == STAGE_FORWARD)
+			single_crypt(&job->k1, job->first + i, DES_DECRYPT, job->buffer[i], job->buffer[i]);
+		else
+			backward_key(job, i, &candidates);
+	}
+	if (job->stage == STAGE_BACKWARD) {
+		__atomic_fetch_add(&job->candidates, candidates, __ATOMIC_RELAXED);
+		__atomic_fetch_add(&job->looked_up, end - item * MITM_CHUNK_SIZE, __ATOMIC_RELAXED);
+	}
+	return __atomic_load_n(&job->found, __ATOMIC_RELAXED);
+}
+
+// Runs one stage over number_of_keys keys
+static void run_stage(MITM_JOB *job, MITM_STAGE stage, QWORD number_of_keys, int threads)
+{
+	job->stage = stage;
+	job->number_of_keys = number_of_keys;
+	parallel_run(mitm_chunk, job, (number_of_keys + MITM_CHUNK_SIZE - 1) / MITM_CHUNK_SIZE, threads);
+}
+
+static int mitm_attack(MITM_JOB *job, MITM_ORACLE oracle, void *arg, size_t memory, int threads, BYTE key[], MITM_STATS *stats)
+{
+	struct timespec start;
+	QWORD forward_keys, backward_keys, capacity, pass, i;
+	MITM_STATS local;
+
+	if (job->k1.key_bits < 1 || job->k1.key_bits > MITM_MAX_KEY_BITS || job->k2.key_bits < 1 || job->k2.key_bits > MITM_MAX_KEY_BITS)
+		return -1;
+	forward_keys = 1ULL << job->k1.key_bits;
+	backward_keys = 1ULL << job->k2.key_bits;
+
+	// a table of "capacity" entries holds capacity / 2 keys of a pass, their middle values
+	// are computed into a buffer first
+	for (capacity = 2; capacity < 2 * forward_keys && 2 * capacity * (sizeof(MITM_ENTRY) + DES_BLOCK_SIZE / 2) <= memory; capacity *= 2)
+		;
+	if (capacity * (sizeof(MITM_ENTRY) + DES_BLOCK_SIZE / 2) > memory)
+		return -1;
+	pass = capacity / 2;
+	job->table = malloc(capacity * sizeof(MITM_ENTRY));
+	job->buffer = malloc(pass * DES_BLOCK_SIZE);
+	if (job->table == NULL || job->buffer == NULL) {
+		free(job->table);
+		free(job->buffer);
+		return -1;
+	}
+	job->table_mask = capacity - 1;
+	job->candidates = 0;
+	job->looked_up = 0;
+	job->found = 0;
+	pthread_mutex_init(&job->lock, NULL);
+
+	memset(&local, 0, sizeof(local));
+	local.memory = capacity * sizeof(MITM_ENTRY) + pass * DES_BLOCK_SIZE;
+	for (job->first = 0; job->first < forward_keys && !job->found; job->first += job->count) {
+		job->count = (forward_keys - job->first < pass) ? forward_keys - job->first : pass;
+		++local.passes;
+
+		clock_gettime(CLOCK_MONOTONIC, &start);
+		if (job->attack == MITM_TRIPLE) {
+			run_stage(job, STAGE_CHOSEN, job->count, threads);
+			oracle((const BYTE (*)[DES_BLOCK_SIZE])job->buffer, job->buffer, (int)job->count, arg);
+		}
+		run_stage(job, STAGE_FORWARD, job->count, threads);
+		memset(job->table, 0xFF, capacity * sizeof(MITM_ENTRY));
+		for (i = 0; i < job->count; ++i) {
+			QWORD m = block_word(job->buffer[i]), slot;
+
+			for (slot = table_slot(job, m); job->table[slot].index != MITM_EMPTY; slot = (slot + 1) & job->table_mask)
+				;
+			job->table[slot].middle = m;
+			job->table[slot].index = (WORD)i;
+		}
+		local.forward_keys += job->count;
+		local.forward_seconds += seconds_since(&start);
+
+		clock_gettime(CLOCK_MONOTONIC, &start);
+		run_stage(job, STAGE_BACKWARD, backward_keys, threads);
+		local.backward_seconds += seconds_since(&start);
+	}
+	local.backward_keys = job->looked_up;
+	local.candidates = job->candidates;
+
+	if (job->found)
+		memcpy(key, job->key, 2 * DES_BLOCK_SIZE);
+	if (stats != NULL)
+		*stats = local;
+	pthread_mutex_destroy(&job->lock);
+	free(job->table);
+	free(job->buffer);
+	return job->found;
+}
+
+int mitm_double_des(const BYTE plain[][DES_BLOCK_SIZE], const BYTE cipher[][DES_BLOCK_SIZE], const MITM_KEYSPACE *k1_space,
+                    const MITM_KEYSPACE *k2_space, size_t memory, int threads, BYTE key[], MITM_STATS *stats)
+{
+	MITM_JOB job;
+
+	memset(&job, 0, sizeof(job));
+	job.attack = MITM_DOUBLE;
+	job.plain = plain;
+	job.cipher = cipher;
+	job.k1 = *k1_space;
+	job.k2 = *k2_space;
+	return mitm_attack(&job, NULL, NULL, memory, threads, key, stats);
+}
+
+int mitm_two_key_triple_des(MITM_ORACLE oracle, void *arg, const BYTE plain[], const BYTE cipher[], const MITM_KEYSPACE *k1_space,
+                            const MITM_KEYSPACE *k2_space, size_t memory, int threads, BYTE key[], MITM_STATS *stats)
+{
+	MITM_JOB job;
+
+	if (oracle == NULL)
+		return -1;
+	memset(&job, 0, sizeof(job));
+	job.attack = MITM_TRIPLE;
+	job.plain = (const BYTE (*)[DES_BLOCK_SIZE])plain;
+	job.cipher = (const BYTE (*)[DES_BLOCK_SIZE])cipher;
+	job.k1 = *k1_space;
+	job.k2 = *k2_space;
+	return mitm_attack(&job, oracle, arg, memory, threads, key, stats);
+}
@@ -0,0 +1,58 @@
+/*********************************************************************
+* Filename:   des_mitm.h
+* Copyright:
+* Disclaimer: This code is presented "as is" without any guarantees.
+* Details:    Defines the API for the meet-in-the-middle attacks on
+              double DES and two-key triple DES (EDE) with restricted
+              key spaces. Only the lowest key_bits of the 56 key bits
+              of a DES key vary (7 per key byte, from the last byte
+              on), the other bits are the ones of a base key. The
+              attacks return the 16 bytes K1 || K2.
+*********************************************************************/
+
+#ifndef DES_MITM_H
+#define DES_MITM_H
+
+/*************************** HEADER FILES ***************************/
+#include <stddef.h>
+#include "des.h"
+
+/****************************** MACROS ******************************/
+#define MITM_MAX_KEY_BITS 31
+#define MITM_CHUNK_SIZE 4096            // keys per work item
+
+/**************************** DATA TYPES ****************************/
+typedef struct {
+	BYTE base_key[DES_BLOCK_SIZE];
+	int key_bits;
+} MITM_KEYSPACE;
+
+typedef struct {
+	int passes;                         // the forward key space is split to fit the memory
+	size_t memory;                      // bytes of the hash table and the pass buffer
+	QWORD forward_keys;
+	QWORD backward_keys;
+	QWORD candidates;                   // matches in the middle checked on the other pair
+	double forward_seconds;
+	double backward_seconds;
+} MITM_STATS;
+
+// Chosen plaintext encryption oracle of the two-key triple DES attack
+typedef void (*MITM_ORACLE)(const BYTE in[][DES_BLOCK_SIZE], BYTE out[][DES_BLOCK_SIZE], int number_of_blocks, void *arg);
+
+/*********************** FUNCTION DECLARATIONS **********************/
+// The key with the number "index" of a key space
+void mitm_key(const MITM_KEYSPACE *space, QWORD index, BYTE key[]);
+// C = E_K2(E_K1(P)) with the known pairs 0 and 1. The middle values E_K1(P0) go into a hash
+// table of at most "memory" bytes, D_K2(C0) is looked up and a match is checked on pair 1.
+// Returns 1 and the key if it was found, 0 if not and -1 for bad parameters. threads 0 is
+// all cores, stats may be NULL.
+int mitm_double_des(const BYTE plain[][DES_BLOCK_SIZE], const BYTE cipher[][DES_BLOCK_SIZE], const MITM_KEYSPACE *k1_space,
+                    const MITM_KEYSPACE *k2_space, size_t memory, int threads, BYTE key[], MITM_STATS *stats);
+// C = E_K1(D_K2(E_K1(P))) with the chosen plaintexts of Merkle and Hellman: for every K1 the
+// oracle encrypts D_K1(0), so the value after the first encryption is 0, and D_K1(C) goes into
+// the table. D_K2(0) is looked up and a match is checked on the known pair.
+int mitm_two_key_triple_des(MITM_ORACLE oracle, void *arg, const BYTE plain[], const BYTE cipher[], const MITM_KEYSPACE *k1_space,
+                            const MITM_KEYSPACE *k2_space, size_t memory, int threads, BYTE key[], MITM_STATS *stats);
+
+#endif   // DES_MITM_H
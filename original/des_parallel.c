@@ -0,0 +1,92 @@
+/*********************************************************************
+* Filename:   des_parallel.c
+* Copyright:
+* Disclaimer: This code is presented "as is" without any guarantees.
+* Details:    Worker pool of the multi-threaded functions. The threads
+              take the items from a shared counter, the calling thread
+              is worker 0.
+*********************************************************************/
+
+/*************************** HEADER FILES ***************************/
+#include <unistd.h>
+#include <pthread.h>
+#include "des_parallel.h"
+
+/**************************** DATA TYPES ****************************/
+typedef struct {
+	PARALLEL_ITEM_FUNC func;
+	void *arg;
+	QWORD number_of_items;
+	QWORD next_item;                    // shared, taken with an atomic add
+	int stop;                           // set once an item asked to start no more items
+	int error;
+} PARALLEL_POOL;
+
+typedef struct {
+	PARALLEL_POOL *pool;
+	int worker;
+} POOL_THREAD;
+
+/*********************** FUNCTION DEFINITIONS ***********************/
+int parallel_threads(int threads)
+{
+	if (threads <= 0)
+		threads = (int)sysconf(_SC_NPROCESSORS_ONLN);
+	if (threads < 1)
+		threads = 1;
+	if (threads > PARALLEL_MAX_THREADS)
+		threads = PARALLEL_MAX_THREADS;
+	return threads;
+}
+
+static void *pool_run(void *arg)
+{
+	POOL_THREAD *thread = arg;
+	PARALLEL_POOL *pool = thread->pool;
+	QWORD item;
+	int result;
+
+	while (!__atomic_load_n(&pool->stop, __ATOMIC_RELAXED)
+	       && (item = __atomic_fetch_add(&pool->next_item, 1, __ATOMIC_RELAXED)) < pool->number_of_items) {
+		result = pool->func(pool->arg, thread->worker, item);
+		if (result < 0)
+			__atomic_store_n(&pool->error, 1, __ATOMIC_RELAXED);
+		else if (result > 0)
+			__atomic_store_n(&pool->stop, 1, __ATOMIC_RELAXED);
+	}
+	return NULL;
+}
+
+int parallel_run(PARALLEL_ITEM_FUNC func, void *arg, QWORD number_of_items, int threads)
+{
+	PARALLEL_POOL pool;
+	POOL_THREAD thread[PARALLEL_MAX_THREADS];
+	pthread_t id[PARALLEL_MAX_THREADS];
+	int i, started;
+
+	pool.func = func;
+	pool.arg = arg;
+	pool.number_of_items = number_of_items;
+	pool.next_item = 0;
+	pool.stop = 0;
+	pool.error = 0;
+	if (number_of_items == 0)
+		return 0;
+	threads = parallel_threads(threads);
+	if ((QWORD)threads > number_of_items)
+		threads = (int)number_of_items;
+
+	for (i = 0; i < threads; ++i) {
+		thread[i].pool = &pool;
+		thread[i].worker = i;
+	}
+	for (started = 1; started < threads; ++started)
+		if (pthread_create(&id[started], NULL, pool_run, &thread[started]) != 0)
+			break;
+	// the calling thread is worker 0, so the items are run even if no thread could be started
+	pool_run(&thread[0]);
+	for (i = 1; i < started; ++i)
+		pthread_join(id[i], NULL);
+
+	return pool.error ? -1 : 0;
+}
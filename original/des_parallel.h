@@ -0,0 +1,32 @@
+/*********************************************************************
+* Filename:   des_parallel.h
+* Copyright:
+* Disclaimer: This code is presented "as is" without any guarantees.
+* Details:    Defines the API of the worker pool of the multi-threaded
+              functions of the original implementation. It is the
+              parallel_run() of task1a without the attack parts, which
+              need the reduced-round des.h of task1a.
+*********************************************************************/
+
+#ifndef DES_PARALLEL_H
+#define DES_PARALLEL_H
+
+/*************************** HEADER FILES ***************************/
+#include "des.h"
+
+/****************************** MACROS ******************************/
+#define PARALLEL_MAX_THREADS 64
+
+/**************************** DATA TYPES ****************************/
+// Runs work item "item" on thread "worker" (0 .. threads-1, the calling thread is 0).
+// Returns 0 to go on, a negative value for an error and a positive value to start no more items.
+typedef int (*PARALLEL_ITEM_FUNC)(void *arg, int worker, QWORD item);
+
+/*********************** FUNCTION DECLARATIONS **********************/
+// threads = 0 uses one thread per online core
+int parallel_threads(int threads);
+// Runs the items 0 .. number_of_items-1 on at most parallel_threads(threads) threads, every thread
+// takes the next item with an atomic add. Returns -1 if an item failed, 0 otherwise.
+int parallel_run(PARALLEL_ITEM_FUNC func, void *arg, QWORD number_of_items, int threads);
+
+#endif   // DES_PARALLEL_H
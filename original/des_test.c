@@ -14,7 +14,11 @@
 /*************************** HEADER FILES ***************************/
 #include <stdio.h>
 #include <memory.h>
+#include <stdlib.h>
+#include <time.h>
 #include "des.h"
+#include "des_bulk.h"
+#include "des_mitm.h"
 
 /*********************** FUNCTION DEFINITIONS ***********************/
 int des_test()
@@ -75,9 +79,206 @@ int des_test()
 	return(pass);
 }
 
+// Encrypts the chosen plaintexts of the two-key triple DES attack under the secret key
+void mitm_oracle(const BYTE in[][DES_BLOCK_SIZE], BYTE out[][DES_BLOCK_SIZE], int number_of_blocks, void *arg)
+{
+	BYTE three_schedule[3][16][6];
+	int i;
+
+	three_des_key_setup(arg, three_schedule, DES_ENCRYPT);
+	for (i = 0; i < number_of_blocks; ++i)
+		three_des_crypt(in[i], out[i], three_schedule);
+}
+
+int mitm_test()
+{
+	MITM_KEYSPACE k1_space = {{0x01,0x23,0x45,0x67,0x89,0xAB,0xCD,0xEF}, 14};
+	MITM_KEYSPACE k2_space = {{0x13,0x34,0x57,0x79,0x9B,0xBC,0xDF,0xF1}, 14};
+	BYTE plain[2][DES_BLOCK_SIZE] = {{0x54,0x68,0x65,0x20,0x71,0x75,0x66,0x63},
+	                                 {0x01,0x23,0x45,0x67,0x89,0xAB,0xCD,0xE7}};
+	BYTE key[2 * DES_BLOCK_SIZE], found[2 * DES_BLOCK_SIZE], three_key[3 * DES_BLOCK_SIZE];
+	BYTE schedule[16][6];
+	BYTE three_schedule[3][16][6];
+	BYTE cipher[2][DES_BLOCK_SIZE];
+	MITM_STATS stats;
+	int pass = 1;
+	int i;
+
+	// double DES, 2^14 keys each side, the table only holds a quarter of K1 per pass
+	mitm_key(&k1_space, 0x1A2B, &key[0]);
+	mitm_key(&k2_space, 0x0C3D, &key[DES_BLOCK_SIZE]);
+	for (i = 0; i < 2; ++i) {
+		des_key_setup(&key[0], schedule, DES_ENCRYPT);
+		des_crypt(plain[i], cipher[i], schedule);
+		des_key_setup(&key[DES_BLOCK_SIZE], schedule, DES_ENCRYPT);
+		des_crypt(cipher[i], cipher[i], schedule);
+	}
+	pass = pass && (mitm_double_des(plain, cipher, &k1_space, &k2_space, 81920, 0, found, &stats) == 1);
+	pass = pass && !memcmp(key, found, 2 * DES_BLOCK_SIZE) && stats.passes == 4;
+
+	// two-key triple DES with the chosen plaintexts
+	memcpy(three_key, key, 2 * DES_BLOCK_SIZE);
+	memcpy(&three_key[2 * DES_BLOCK_SIZE], key, DES_BLOCK_SIZE);
+	three_des_key_setup(three_key, three_schedule, DES_ENCRYPT);
+	three_des_crypt(plain[0], cipher[0], three_schedule);
+	pass = pass && (mitm_two_key_triple_des(mitm_oracle, three_key, plain[0], cipher[0], &k1_space, &k2_space, 1 << 20, 0, found, &stats) == 1);
+	pass = pass && !memcmp(key, found, 2 * DES_BLOCK_SIZE) && stats.passes == 1;
+
+	return(pass);
+}
+
+// Double DES with 2^18 keys each side, prints the memory use and the throughput of the stages
+void mitm_report()
+{
+	MITM_KEYSPACE k1_space = {{0x01,0x23,0x45,0x67,0x89,0xAB,0xCD,0xEF}, 18};
+	MITM_KEYSPACE k2_space = {{0x13,0x34,0x57,0x79,0x9B,0xBC,0xDF,0xF1}, 18};
+	BYTE plain[2][DES_BLOCK_SIZE] = {{0x54,0x68,0x65,0x20,0x71,0x75,0x66,0x63},
+	                                 {0x01,0x23,0x45,0x67,0x89,0xAB,0xCD,0xE7}};
+	BYTE key[2 * DES_BLOCK_SIZE], found[2 * DES_BLOCK_SIZE];
+	BYTE schedule[16][6];
+	BYTE cipher[2][DES_BLOCK_SIZE];
+	MITM_STATS stats;
+	int i, result;
+
+	mitm_key(&k1_space, 0x2F00D, &key[0]);
+	mitm_key(&k2_space, 0x3BEEF, &key[DES_BLOCK_SIZE]);
+	for (i = 0; i < 2; ++i) {
+		des_key_setup(&key[0], schedule, DES_ENCRYPT);
+		des_crypt(plain[i], cipher[i], schedule);
+		des_key_setup(&key[DES_BLOCK_SIZE], schedule, DES_ENCRYPT);
+		des_crypt(cipher[i], cipher[i], schedule);
+	}
+	result = mitm_double_des(plain, cipher, &k1_space, &k2_space, 4 << 20, 0, found, &stats);
+	printf("MITM on double DES with 2 x 18 key bits: %s\n", (result == 1 && !memcmp(key, found, 2 * DES_BLOCK_SIZE)) ? "key found" : "FAILED");
+	printf("\t%d passes, %.1f MB, forward %.2f Mkeys/s, backward %.2f Mkeys/s, %llu candidates\n", stats.passes, stats.memory / 1048576.0,
+	       stats.forward_keys / stats.forward_seconds / 1e6, stats.backward_keys / stats.backward_seconds / 1e6, stats.candidates);
+}
+
+// The bulk functions against des_crypt() and three_des_crypt(), CTR with one and all threads
+int bulk_test()
+{
+	BYTE key[DES_BLOCK_SIZE] = {0x13,0x34,0x57,0x79,0x9B,0xBC,0xDF,0xF1};
+	BYTE three_key[DES_BLOCK_SIZE * 3] = {0x01,0x23,0x45,0x67,0x89,0xAB,0xCD,0xEF,
+	                                      0x23,0x45,0x67,0x89,0xAB,0xCD,0xEF,0x01,
+	                                      0x45,0x67,0x89,0xAB,0xCD,0xEF,0x01,0x23};
+	BYTE counter[DES_BLOCK_SIZE] = {0xF0,0xE1,0xD2,0xC3,0xB4,0xA5,0xFF,0xFE};
+	BYTE schedule[16][6], three_schedule[3][16][6];
+	BYTE block[DES_BLOCK_SIZE], stream[DES_BLOCK_SIZE];
+	BYTE (*plain)[DES_BLOCK_SIZE], (*cipher)[DES_BLOCK_SIZE], *data, *single, *parallel;
+	DES_BULK_KEY bulk;
+	size_t length = (2 << 20) + 5;      // more than DES_BULK_PARALLEL_MIN and a partial last block
+	QWORD c;
+	int number_of_blocks = 1001;
+	int pass = 1;
+	int mode, i, b;
+
+	plain = malloc(2 * number_of_blocks * DES_BLOCK_SIZE);
+	data = malloc(3 * length);
+	if (plain == NULL || data == NULL) {
+		free(plain);
+		free(data);
+		return(0);
+	}
+	cipher = plain + number_of_blocks;
+	single = data + length;
+	parallel = single + length;
+	for (i = 0; i < number_of_blocks * DES_BLOCK_SIZE; ++i)
+		plain[i / DES_BLOCK_SIZE][i % DES_BLOCK_SIZE] = (BYTE)(i * 131 + (i >> 8));
+
+	// ECB in both directions, the blocks are not a multiple of the batch size
+	for (mode = DES_ENCRYPT; mode <= DES_DECRYPT; ++mode) {
+		des_key_setup(key, schedule, mode);
+		des_bulk_key_setup(key, &bulk, mode);
+		des_ecb_encrypt_blocks((const BYTE (*)[DES_BLOCK_SIZE])plain, cipher, number_of_blocks, &bulk);
+		for (i = 0; i < number_of_blocks; ++i) {
+			des_crypt(plain[i], block, schedule);
+			pass = pass && !memcmp(block, cipher[i], DES_BLOCK_SIZE);
+		}
+		three_des_key_setup(three_key, three_schedule, mode);
+		three_des_bulk_key_setup(three_key, &bulk, mode);
+		des_ecb_encrypt_blocks((const BYTE (*)[DES_BLOCK_SIZE])plain, cipher, number_of_blocks, &bulk);
+		for (i = 0; i < number_of_blocks; ++i) {
+			three_des_crypt(plain[i], block, three_schedule);
+			pass = pass && !memcmp(block, cipher[i], DES_BLOCK_SIZE);
+		}
+	}
+
+	// CTR: the counter wraps around, the threads give the same bytes and a second call decrypts
+	three_des_key_setup(three_key, three_schedule, DES_ENCRYPT);
+	three_des_bulk_key_setup(three_key, &bulk, DES_ENCRYPT);
+	for (i = 0; i < (int)length; ++i)
+		data[i] = (BYTE)(i * 7);
+	pass = pass && (des_ctr_xor(data, single, length, counter, &bulk, 1) == 0);
+	pass = pass && (des_ctr_xor(data, parallel, length, counter, &bulk, 0) == 0);
+	pass = pass && !memcmp(single, parallel, length);
+	for (c = 0, i = 0; i < DES_BLOCK_SIZE; ++i)
+		c = (c << 8) | counter[i];
+	for (i = 0; i < 300; ++i, ++c) {
+		for (b = 0; b < DES_BLOCK_SIZE; ++b)
+			block[b] = (c >> (56 - 8 * b)) & 0xFF;
+		three_des_crypt(block, stream, three_schedule);
+		for (b = 0; b < DES_BLOCK_SIZE; ++b)
+			pass = pass && (single[i * DES_BLOCK_SIZE + b] == (data[i * DES_BLOCK_SIZE + b] ^ stream[b]));
+	}
+	pass = pass && (des_ctr_xor(parallel, parallel, length, counter, &bulk, 0) == 0);
+	pass = pass && !memcmp(data, parallel, length);
+
+	free(plain);
+	free(data);
+	return(pass);
+}
+
+static double seconds_since(const struct timespec *start)
+{
+	struct timespec end;
+
+	clock_gettime(CLOCK_MONOTONIC, &end);
+	return (end.tv_sec - start->tv_sec) + (end.tv_nsec - start->tv_nsec) / 1e9;
+}
+
+void bulk_report()
+{
+	BYTE three_key[DES_BLOCK_SIZE * 3] = {0x01,0x23,0x45,0x67,0x89,0xAB,0xCD,0xEF,
+	                                      0x23,0x45,0x67,0x89,0xAB,0xCD,0xEF,0x01,
+	                                      0x45,0x67,0x89,0xAB,0xCD,0xEF,0x01,0x23};
+	BYTE counter[DES_BLOCK_SIZE] = {0};
+	BYTE three_schedule[3][16][6];
+	BYTE *data;
+	DES_BULK_KEY bulk;
+	struct timespec start;
+	size_t length = 8 << 20;
+	double one_block, ecb, ctr;
+	size_t i;
+
+	data = calloc(2, length);
+	if (data == NULL)
+		return;
+	three_des_key_setup(three_key, three_schedule, DES_ENCRYPT);
+	three_des_bulk_key_setup(three_key, &bulk, DES_ENCRYPT);
+
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	for (i = 0; i < length; i += DES_BLOCK_SIZE)
+		three_des_crypt(&data[i], &data[length + i], three_schedule);
+	one_block = length / seconds_since(&start) / 1e9;
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	des_ecb_encrypt_blocks((const BYTE (*)[DES_BLOCK_SIZE])data, (BYTE (*)[DES_BLOCK_SIZE])&data[length], length / DES_BLOCK_SIZE, &bulk);
+	ecb = length / seconds_since(&start) / 1e9;
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	des_ctr_xor(data, &data[length], length, counter, &bulk, 0);
+	ctr = length / seconds_since(&start) / 1e9;
+
+	printf("Triple DES on %zu MB: three_des_crypt() %.4f GB/s, ECB %.4f GB/s (%.1fx), CTR on all cores %.4f GB/s (%.1fx)\n",
+	       length >> 20, one_block, ecb, ecb / one_block, ctr, ctr / one_block);
+	free(data);
+}
+
 int main()
 {
 	printf("DES test: %s\n", des_test() ? "SUCCEEDED" : "FAILED");
+	printf("MITM test: %s\n", mitm_test() ? "SUCCEEDED" : "FAILED");
+	mitm_report();
+	printf("Bulk test: %s\n", bulk_test() ? "SUCCEEDED" : "FAILED");
+	bulk_report();
 
 	return(0);
 }
@@ -0,0 +1,264 @@
+/*********************************************************************
+* Filename:   attack_harness.c
+* Copyright:
+* Disclaimer: This code is presented "as is" without any guarantees.
+* Details:    Runs the 3, 5, 7 and 8 round attacks of des_test.c over a
+              grid of data sizes and random keys and writes one CSV
+              line per (attack, data size) with the success rate, the
+              rank of the correct guess and the wall time. The keys of
+              a configuration are shared between the threads. The 3/5/7
+              round attacks do not rank guesses, their rank columns are
+              empty.
+              Success means: 3/5/7 rounds - the right side of the
+              approximation is guessed (algorithm 1); 8 rounds - the K8
+              bits of S-Box 1 are ranked first and the right side is
+              guessed (algorithm 2); 8 rounds multi - the K8 bits are
+              ranked first by the combined statistic of the round 1
+              variants of the 8 round approximation.
+              Usage: attack_harness [csv file] [keys] [min log2 N]
+                                    [max log2 N] [threads]
+*********************************************************************/
+
+/*************************** HEADER FILES ***************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "des.h"
+#include "des_keyguess.h"
+#include "des_linear.h"
+#include "des_parallel.h"
+#include "des_stream.h"
+#include "des_table.h"
+
+/****************************** MACROS ******************************/
+#define HARNESS_CHUNK 65536             // plaintexts per chunk of one key
+#define ATTACK_MULTI 9                  // attack id of the multiple linear 8 round attack
+
+/**************************** DATA TYPES ****************************/
+typedef struct {
+	BYTE (*plain)[DES_BLOCK_SIZE];
+	BYTE (*cipher)[DES_BLOCK_SIZE];
+} __attribute__ ((aligned (CACHE_LINE_SIZE))) HARNESS_WORKER;
+
+typedef struct {
+	int attack;                         // 3, 5, 7, 8 or ATTACK_MULTI
+	int number_of_plains;
+	int number_of_keys;
+	const BYTE (*keys)[DES_BLOCK_SIZE];
+	const LINEAR_APPROXIMATION *approx; // round 1 variants for ATTACK_MULTI
+	const double *weight;
+	int number_of_approx;
+	BYTE *success;                      // per key
+	int *rank;                          // per key, 1 is the best (8 round attacks only)
+	HARNESS_WORKER *worker;             // the chunk buffers of every thread
+} HARNESS_JOB;
+
+/**************************** VARIABLES *****************************/
+static const BYTE key_seed[DES_BLOCK_SIZE] = {0x48,0x41,0x52,0x4E,0x45,0x53,0x53,0x4B};
+static const BYTE data_seed[DES_BLOCK_SIZE] = {0x48,0x41,0x52,0x4E,0x45,0x53,0x53,0x44};
+
+/*********************** FUNCTION DEFINITIONS ***********************/
+// Rank (1-based) of the guess in the sorted candidates
+static int guess_rank(const KEY_CANDIDATE candidates[], int number_of_candidates, WORD guess)
+{
+	int i;
+
+	for (i = 0; i < number_of_candidates; ++i) {
+		if (candidates[i].guess == guess)
+			return i + 1;
+	}
+	return number_of_candidates + 1;
+}
+
+// Attacks key "item", the keys are the work items of parallel_run()
+static int attack_key(void *arg, int thread, QWORD item)
+{
+	HARNESS_JOB *job = arg;
+	HARNESS_WORKER *worker = &job->worker[thread];
+	int k = (int)item;
+	int rounds = (job->attack == ATTACK_MULTI) ? 8 : job->attack;
+	BYTE schedule[16][6];
+	BYTE target_sboxes[1] = {1};
+	unsigned int count_T0 = 0, count_T1 = 0;
+	unsigned int counter[ALGORITHM2_COUNTER_SIZE];
+	long long histogram[KEYGUESS_MAX_APPROX * 64];
+	KEY_CANDIDATE candidates[64];
+	WORD actual = 0;
+	BYTE right_side;
+	int done, batch, i;
+
+	des_key_setup_table(job->keys[k], schedule, DES_ENCRYPT, rounds);
+	right_side = approximation_right_side(builtin_approximation(rounds), (const BYTE (*)[6])schedule);
+	if (rounds == 8)
+		actual = schedule[7][0] >> 2;
+	memset(counter, 0, sizeof(counter));
+	memset(histogram, 0, sizeof(histogram));
+
+	for (done = 0; done < job->number_of_plains; done += batch) {
+		batch = job->number_of_plains - done;
+		if (batch > HARNESS_CHUNK)
+			batch = HARNESS_CHUNK;
+		counter_plaintexts(data_seed, (QWORD)k * job->number_of_plains + done, batch, worker->plain);
+		if ((job->attack == 8 || job->attack == ATTACK_MULTI)
+		    && encrypt_plaintexts((const BYTE (*)[DES_BLOCK_SIZE])worker->plain, worker->cipher, (const BYTE (*)[6])schedule, batch, 8) != 0) {
+			job->success[k] = 0;
+			job->rank[k] = 65;
+			return 0;
+		}
+		if (job->attack == 8)
+			compress_pairs((const BYTE (*)[DES_BLOCK_SIZE])worker->plain, (const BYTE (*)[DES_BLOCK_SIZE])worker->cipher, counter, batch);
+		else if (job->attack == ATTACK_MULTI)
+			add_histograms((const BYTE (*)[DES_BLOCK_SIZE])worker->plain, (const BYTE (*)[DES_BLOCK_SIZE])worker->cipher, batch,
+			               job->approx, job->number_of_approx, target_sboxes, 1, histogram);
+		else
+			algorithm1((const BYTE (*)[DES_BLOCK_SIZE])worker->plain, (const BYTE (*)[6])schedule, &count_T0, &count_T1, batch, rounds, schedule[0]);
+	}
+
+	if (job->attack == 8) {
+		// the counter holds the signed histogram over the S-Box 1 input
+		for (i = 0; i < 64; ++i)
+			histogram[i] = (long long)counter[i] - (long long)counter[64 + i];
+		if (fwht_keyguess(histogram, builtin_approximation(8)->fmask, target_sboxes, 1, job->number_of_plains, candidates) != 0) {
+			job->success[k] = 0;
+			job->rank[k] = 65;
+			return 0;
+		}
+		job->rank[k] = guess_rank(candidates, 64, actual);
+		job->success[k] = (job->rank[k] == 1) && ((candidates[0].bias > 0 ? 0 : 1) == right_side);
+	}
+	else if (job->attack == ATTACK_MULTI) {
+		if (multiple_keyguess(histogram, job->approx, job->weight, job->number_of_approx, target_sboxes, 1, job->number_of_plains, candidates) != 0) {
+			job->success[k] = 0;
+			job->rank[k] = 65;
+			return 0;
+		}
+		job->rank[k] = guess_rank(candidates, 64, actual);
+		job->success[k] = (job->rank[k] == 1);
+	}
+	else {
+		// like the attacks in des_test.c: T0 > T1 means the right side is 0
+		job->success[k] = ((count_T0 > count_T1) ? 0 : 1) == right_side;
+	}
+	return 0;
+}
+
+static int run_harness(HARNESS_JOB *job, int threads)
+{
+	HARNESS_WORKER worker[PARALLEL_MAX_THREADS];
+	int i, error = 0;
+
+	threads = parallel_threads(threads);
+	for (i = 0; i < threads; ++i) {
+		worker[i].plain = malloc(HARNESS_CHUNK * DES_BLOCK_SIZE);
+		worker[i].cipher = malloc(HARNESS_CHUNK * DES_BLOCK_SIZE);
+		if (worker[i].plain == NULL || worker[i].cipher == NULL)
+			error = -1;
+	}
+	if (error == 0) {
+		job->worker = worker;
+		error = parallel_run(attack_key, job, job->number_of_keys, threads);
+	}
+	for (i = 0; i < threads; ++i) {
+		free(worker[i].plain);
+		free(worker[i].cipher);
+	}
+	return error;
+}
+
+static int compare_int(const void *a, const void *b)
+{
+	return *(const int *)a - *(const int *)b;
+}
+
+int main(int argc, char *argv[])
+{
+	const char *filename = (argc > 1) ? argv[1] : "attack_harness.csv";
+	int number_of_keys = (argc > 2) ? atoi(argv[2]) : 64;
+	int min_log = (argc > 3) ? atoi(argv[3]) : 8;
+	int max_log = (argc > 4) ? atoi(argv[4]) : 18;
+	int threads = parallel_threads((argc > 5) ? atoi(argv[5]) : 0);
+	const int attacks[5] = {3, 5, 7, 8, ATTACK_MULTI};
+	LINEAR_APPROXIMATION approx[KEYGUESS_MAX_APPROX];
+	double weight[KEYGUESS_MAX_APPROX];
+	BYTE (*keys)[DES_BLOCK_SIZE];
+	HARNESS_JOB job;
+	struct timespec start, end;
+	double seconds, mean_rank;
+	char mean_text[32], median_text[32];
+	int a, l, k, successes, ranked;
+	FILE *file;
+
+	if (number_of_keys < 1 || min_log < 1 || max_log > 30 || min_log > max_log) {
+		printf("ERROR: at least one key and 1 <= min log2 N <= max log2 N <= 30\n");
+		return 1;
+	}
+	keys = malloc((size_t)number_of_keys * DES_BLOCK_SIZE);
+	memset(&job, 0, sizeof(job));
+	job.success = malloc(number_of_keys);
+	job.rank = calloc(number_of_keys, sizeof(int));
+	if (keys == NULL || job.success == NULL || job.rank == NULL) {
+		printf("ERROR: out of memory\n");
+		return 1;
+	}
+	file = fopen(filename, "w");
+	if (file == NULL) {
+		printf("ERROR: could not open %s\n", filename);
+		return 1;
+	}
+	counter_plaintexts(key_seed, 0, number_of_keys, keys);
+	job.keys = (const BYTE (*)[DES_BLOCK_SIZE])keys;
+	job.number_of_keys = number_of_keys;
+	job.number_of_approx = round1_variants(builtin_approximation(8), approx, weight, KEYGUESS_MAX_APPROX);
+	job.approx = approx;
+	job.weight = weight;
+
+	printf("Running the attacks with 2^%d - 2^%d plaintexts over %d keys (%d threads)...\n", min_log, max_log, number_of_keys, threads);
+	fprintf(file, "attack,rounds,plaintexts,keys,success_rate,mean_rank,median_rank,seconds\n");
+	for (a = 0; a < 5; ++a) {
+		for (l = min_log; l <= max_log; ++l) {
+			job.attack = attacks[a];
+			job.number_of_plains = 1 << l;
+
+			clock_gettime(CLOCK_MONOTONIC, &start);
+			if (run_harness(&job, threads) != 0) {
+				printf("ERROR: out of memory\n");
+				return 1;
+			}
+			clock_gettime(CLOCK_MONOTONIC, &end);
+			seconds = (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) / 1e9;
+
+			for (k = 0, successes = 0, mean_rank = 0; k < number_of_keys; ++k) {
+				successes += job.success[k];
+				mean_rank += job.rank[k];
+			}
+			mean_rank /= number_of_keys;
+			qsort(job.rank, number_of_keys, sizeof(int), compare_int);
+			// algorithm 1 only guesses the right side, there is no rank to report
+			ranked = (attacks[a] == 8 || attacks[a] == ATTACK_MULTI);
+			if (ranked) {
+				snprintf(mean_text, sizeof(mean_text), "%.2f", mean_rank);
+				snprintf(median_text, sizeof(median_text), "%d", job.rank[number_of_keys / 2]);
+			}
+			else {
+				mean_text[0] = '\0';
+				median_text[0] = '\0';
+			}
+
+			fprintf(file, "%s,%d,%d,%d,%.4f,%s,%s,%.3f\n", (attacks[a] == ATTACK_MULTI) ? "8multi" : (attacks[a] == 8 ? "8" : "alg1"),
+			        (attacks[a] == ATTACK_MULTI) ? 8 : attacks[a], job.number_of_plains, number_of_keys,
+			        (double)successes / number_of_keys, mean_text, median_text, seconds);
+			fflush(file);
+			printf("%-6s %2d rounds, N = 2^%-2d: success %5.1f%%, mean rank %6s, %.2f s\n",
+			       (attacks[a] == ATTACK_MULTI) ? "multi" : "single", (attacks[a] == ATTACK_MULTI) ? 8 : attacks[a], l,
+			       100.0 * successes / number_of_keys, ranked ? mean_text : "-", seconds);
+		}
+	}
+
+	fclose(file);
+	free(keys);
+	free(job.success);
+	free(job.rank);
+	printf("Wrote %s\n", filename);
+	return 0;
+}
@@ -0,0 +1,311 @@
+/*********************************************************************
+* Filename:   benchmark.c
+* Copyright:
+* Disclaimer: This code is presented "as is" without any guarantees.
+* Details:    Micro-benchmarks of the DES primitives and of the steps
+              of the attacks at 3, 5, 7, 8 and 16 rounds. Every
+              operation is repeated until it ran for the minimum time,
+              the time per call, per block, the time stamp counter
+              cycles per block (x86 only) and the blocks per second are
+              printed and written to a JSON file so builds can be
+              compared. Operations that do not depend on the round
+              count are measured once with "rounds": null.
+              Usage: benchmark [json file] [min seconds per operation]
+*********************************************************************/
+
+/*************************** HEADER FILES ***************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define BENCH_HAVE_TSC 1
+#else
+#define BENCH_HAVE_TSC 0
+#endif
+#include "des.h"
+#include "des_bitslice.h"
+#include "des_stream.h"
+#include "des_table.h"
+
+/****************************** MACROS ******************************/
+#define BENCH_BLOCKS 4096               // blocks per call of the batch operations
+#define BENCH_MAX_RESULTS 128
+
+/**************************** DATA TYPES ****************************/
+typedef enum {
+	OP_KEY_SETUP,
+	OP_KEY_SETUP_TABLE,
+	OP_F,
+	OP_F_TABLE,
+	OP_CRYPT,
+	OP_CRYPT_TABLE,
+	OP_CRYPT_BLOCKS,
+	OP_CRYPT_BLOCKS_GENERIC,
+	OP_CRYPT_BITSLICE,
+	OP_RAND_PLAINTEXT,
+	OP_COUNTER_PLAINTEXTS,
+	OP_COMPUTE_LEFT_SIDE,
+	OP_COUNT_LEFT_SIDE,
+	OP_ALGORITHM1,
+	OP_COMPRESS_PAIRS,
+	OP_ALGORITHM2_CACHED
+} BENCH_OP;
+
+typedef struct {
+	BENCH_OP op;
+	const char *name;
+	int blocks;                         // blocks per call
+	int by_rounds;                      // 0 if the round count does not matter
+	int attack_rounds_only;             // only the round counts with an approximation (3, 5, 7, 8)
+	int rounds_8_only;
+} BENCH_OPERATION;
+
+typedef struct {
+	const char *name;
+	int rounds;                         // 0 for null
+	int blocks;
+	QWORD calls;
+	double ns_per_call;
+	double ns_per_block;
+	double cycles_per_block;
+	double blocks_per_second;
+} BENCH_RESULT;
+
+/**************************** VARIABLES *****************************/
+static const BENCH_OPERATION operations[] = {
+	{OP_KEY_SETUP,            "des_key_setup",            1,            1, 0, 0},
+	{OP_KEY_SETUP_TABLE,      "des_key_setup_table",      1,            1, 0, 0},
+	{OP_F,                    "f",                        1,            0, 0, 0},
+	{OP_F_TABLE,              "f_table",                  1,            0, 0, 0},
+	{OP_CRYPT,                "des_crypt",                1,            1, 0, 0},
+	{OP_CRYPT_TABLE,          "des_crypt_table",          1,            1, 0, 0},
+	{OP_CRYPT_BLOCKS,         "des_crypt_blocks",         BENCH_BLOCKS, 1, 0, 0},
+	{OP_CRYPT_BLOCKS_GENERIC, "des_crypt_blocks_generic", BENCH_BLOCKS, 1, 0, 0},
+	{OP_CRYPT_BITSLICE,       "des_crypt_bitslice",       BENCH_BLOCKS, 1, 0, 0},
+	{OP_RAND_PLAINTEXT,       "rand_plaintext",           1,            0, 0, 0},
+	{OP_COUNTER_PLAINTEXTS,   "counter_plaintexts",       BENCH_BLOCKS, 0, 0, 0},
+	{OP_COMPUTE_LEFT_SIDE,    "compute_left_side",        1,            1, 1, 0},
+	{OP_COUNT_LEFT_SIDE,      "count_left_side",          BENCH_BLOCKS, 1, 1, 0},
+	{OP_ALGORITHM1,           "algorithm1",               BENCH_BLOCKS, 1, 1, 0},
+	{OP_COMPRESS_PAIRS,       "compress_pairs",           BENCH_BLOCKS, 1, 0, 1},
+	{OP_ALGORITHM2_CACHED,    "algorithm2_cached",        BENCH_BLOCKS, 1, 0, 1}
+};
+static const int round_counts[] = {3, 5, 7, 8, 16};
+static const BYTE key[DES_BLOCK_SIZE] = {0x13,0x34,0x57,0x79,0x9B,0xBC,0xDF,0xF1};
+static const BYTE seed[DES_BLOCK_SIZE] = {0x42,0x45,0x4E,0x43,0x48,0x4D,0x41,0x52};
+
+static BYTE plain[BENCH_BLOCKS][DES_BLOCK_SIZE];
+static BYTE cipher[BENCH_BLOCKS][DES_BLOCK_SIZE];
+static BYTE schedule[16][6];
+static unsigned int counter[ALGORITHM2_COUNTER_SIZE];
+static volatile QWORD sink;             // keeps the results of the calls alive
+
+/*********************** FUNCTION DEFINITIONS ***********************/
+static double seconds_since(const struct timespec *start)
+{
+	struct timespec now;
+
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return (now.tv_sec - start->tv_sec) + (now.tv_nsec - start->tv_nsec) / 1e9;
+}
+
+static QWORD read_tsc(void)
+{
+#if BENCH_HAVE_TSC
+	return __rdtsc();
+#else
+	return 0;
+#endif
+}
+
+static void run(BENCH_OP op, int rounds, QWORD calls)
+{
+	BYTE keyguess[6] = {0x00,0x00,0x00,0x00,0x00,0x00};
+	BYTE key8bits[6], state[DES_BLOCK_SIZE], out[DES_BLOCK_SIZE], keys[16][6];
+	unsigned int T0[64], T1[64];
+	WORD x = 0x01234567;
+	QWORD c, acc = 0;
+	int i = 0;
+
+	T0[0] = T1[0] = 0;
+	memcpy(state, seed, DES_BLOCK_SIZE);
+	for (c = 0; c < calls; ++c, i = (i + 1) % BENCH_BLOCKS) {
+		switch (op) {
+		case OP_KEY_SETUP:
+			des_key_setup(plain[i], keys, DES_ENCRYPT, rounds);
+			acc += keys[rounds - 1][0];
+			break;
+		case OP_KEY_SETUP_TABLE:
+			des_key_setup_table(plain[i], keys, DES_ENCRYPT, rounds);
+			acc += keys[rounds - 1][0];
+			break;
+		case OP_F:
+			x = f(x, schedule[i & 15]) ^ x;
+			break;
+		case OP_F_TABLE:
+			x = f_table(x, schedule[i & 15]) ^ x;
+			break;
+		case OP_CRYPT:
+			des_crypt(plain[i], out, (const BYTE (*)[6])schedule, rounds);
+			acc += out[0];
+			break;
+		case OP_CRYPT_TABLE:
+			des_crypt_table(plain[i], out, (const BYTE (*)[6])schedule, rounds);
+			acc += out[0];
+			break;
+		case OP_CRYPT_BLOCKS:
+			des_crypt_blocks((const BYTE (*)[DES_BLOCK_SIZE])plain, cipher, (const BYTE (*)[6])schedule, BENCH_BLOCKS, rounds);
+			acc += cipher[0][0];
+			break;
+		case OP_CRYPT_BLOCKS_GENERIC:
+			// the runtime round count against the unrolled rounds of des_crypt_blocks
+			des_crypt_blocks_generic((const BYTE (*)[DES_BLOCK_SIZE])plain, cipher, (const BYTE (*)[6])schedule, BENCH_BLOCKS, rounds);
+			acc += cipher[0][0];
+			break;
+		case OP_CRYPT_BITSLICE:
+			des_crypt_bitslice((const BYTE (*)[DES_BLOCK_SIZE])plain, cipher, (const BYTE (*)[6])schedule, rounds, BENCH_BLOCKS);
+			acc += cipher[0][0];
+			break;
+		case OP_RAND_PLAINTEXT:
+			rand_plaintext(state, state, out);
+			acc += out[0];
+			break;
+		case OP_COUNTER_PLAINTEXTS:
+			counter_plaintexts(seed, c * BENCH_BLOCKS, BENCH_BLOCKS, cipher);
+			acc += cipher[0][0];
+			break;
+		case OP_COMPUTE_LEFT_SIDE:
+			acc += compute_left_side(plain[i], cipher[i], rounds, x);
+			break;
+		case OP_COUNT_LEFT_SIDE:
+			count_left_side((const BYTE (*)[DES_BLOCK_SIZE])plain, (const BYTE (*)[DES_BLOCK_SIZE])cipher, T0, T1, BENCH_BLOCKS, rounds, keyguess);
+			break;
+		case OP_ALGORITHM1:
+			algorithm1((const BYTE (*)[DES_BLOCK_SIZE])plain, (const BYTE (*)[6])schedule, T0, T1, BENCH_BLOCKS, rounds, keyguess);
+			break;
+		case OP_COMPRESS_PAIRS:
+			compress_pairs((const BYTE (*)[DES_BLOCK_SIZE])plain, (const BYTE (*)[DES_BLOCK_SIZE])cipher, counter, BENCH_BLOCKS);
+			break;
+		case OP_ALGORITHM2_CACHED:
+			algorithm2_cached((const BYTE (*)[DES_BLOCK_SIZE])plain, (const BYTE (*)[6])schedule, key8bits, T0, T1, BENCH_BLOCKS, 64);
+			break;
+		}
+	}
+	sink += acc + x + T0[0] + T1[0];
+}
+
+// Doubles the number of calls until one run takes the minimum time
+static void measure(const BENCH_OPERATION *operation, int rounds, double min_seconds, BENCH_RESULT *result)
+{
+	struct timespec start;
+	QWORD calls, tsc;
+	double seconds;
+
+	// the operations without a round count get the 16 round key schedule and pairs
+	if (rounds == 0)
+		rounds = 16;
+	des_key_setup_table(key, schedule, DES_ENCRYPT, rounds);
+	des_crypt_blocks((const BYTE (*)[DES_BLOCK_SIZE])plain, cipher, (const BYTE (*)[6])schedule, BENCH_BLOCKS, rounds);
+	run(operation->op, rounds, 1);
+
+	for (calls = 1; ; calls *= 2) {
+		clock_gettime(CLOCK_MONOTONIC, &start);
+		tsc = read_tsc();
+		run(operation->op, rounds, calls);
+		tsc = read_tsc() - tsc;
+		seconds = seconds_since(&start);
+		if (seconds >= min_seconds)
+			break;
+	}
+
+	result->name = operation->name;
+	result->rounds = operation->by_rounds ? rounds : 0;
+	result->blocks = operation->blocks;
+	result->calls = calls;
+	result->ns_per_call = 1e9 * seconds / calls;
+	result->ns_per_block = result->ns_per_call / operation->blocks;
+	result->cycles_per_block = BENCH_HAVE_TSC ? (double)tsc / calls / operation->blocks : 0;
+	result->blocks_per_second = calls * operation->blocks / seconds;
+}
+
+static int write_json(const char *filename, const BENCH_RESULT results[], int number_of_results, double min_seconds)
+{
+	FILE *file = fopen(filename, "w");
+	time_t now = time(NULL);
+	char date[32];
+	int i;
+
+	if (file == NULL)
+		return -1;
+	strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%SZ", gmtime(&now));
+	fprintf(file, "{\n");
+	fprintf(file, "  \"date\": \"%s\",\n", date);
+	fprintf(file, "  \"compiler\": \"%s\",\n", __VERSION__);
+	fprintf(file, "  \"bitslice_blocks\": %d,\n", DES_BS_BLOCKS);
+	fprintf(file, "  \"cycles\": \"%s\",\n", BENCH_HAVE_TSC ? "tsc" : "none");
+	fprintf(file, "  \"min_seconds\": %g,\n", min_seconds);
+	fprintf(file, "  \"results\": [\n");
+	for (i = 0; i < number_of_results; ++i) {
+		fprintf(file, "    {\"name\": \"%s\", ", results[i].name);
+		if (results[i].rounds > 0)
+			fprintf(file, "\"rounds\": %d, ", results[i].rounds);
+		else
+			fprintf(file, "\"rounds\": null, ");
+		fprintf(file, "\"blocks_per_call\": %d, \"calls\": %llu, \"ns_per_call\": %.3f, \"ns_per_block\": %.3f, ",
+		        results[i].blocks, results[i].calls, results[i].ns_per_call, results[i].ns_per_block);
+		if (BENCH_HAVE_TSC)
+			fprintf(file, "\"cycles_per_block\": %.2f, ", results[i].cycles_per_block);
+		else
+			fprintf(file, "\"cycles_per_block\": null, ");
+		fprintf(file, "\"blocks_per_second\": %.0f}%s\n", results[i].blocks_per_second, (i + 1 < number_of_results) ? "," : "");
+	}
+	fprintf(file, "  ]\n}\n");
+	return fclose(file);
+}
+
+int main(int argc, char *argv[])
+{
+	const char *filename = (argc > 1) ? argv[1] : "build/benchmark.json";
+	double min_seconds = (argc > 2) ? atof(argv[2]) : 0.2;
+	BENCH_RESULT results[BENCH_MAX_RESULTS];
+	const BENCH_OPERATION *operation;
+	int number_of_results = 0;
+	char label[12];
+	int o, r, rounds;
+
+	if (min_seconds <= 0) {
+		printf("Usage: %s [json file] [min seconds per operation]\n", argv[0]);
+		return 1;
+	}
+	counter_plaintexts(seed, 0, BENCH_BLOCKS, plain);
+
+	printf("%-24s %6s %12s %12s %12s %14s\n", "operation", "rounds", "ns/call", "ns/block", "cycles/block", "blocks/s");
+	for (o = 0; o < (int)(sizeof(operations) / sizeof(operations[0])); ++o) {
+		operation = &operations[o];
+		for (r = 0; r < (int)(sizeof(round_counts) / sizeof(round_counts[0])); ++r) {
+			rounds = operation->by_rounds ? round_counts[r] : 0;
+			if ((operation->attack_rounds_only && rounds == 16) || (operation->rounds_8_only && rounds != 8))
+				continue;
+			measure(operation, rounds, min_seconds, &results[number_of_results]);
+			if (rounds > 0)
+				snprintf(label, sizeof(label), "%d", rounds);
+			else
+				strcpy(label, "-");
+			printf("%-24s %6s %12.1f %12.2f %12.1f %14.0f\n", operation->name, label,
+			       results[number_of_results].ns_per_call, results[number_of_results].ns_per_block,
+			       results[number_of_results].cycles_per_block, results[number_of_results].blocks_per_second);
+			++number_of_results;
+			if (!operation->by_rounds)
+				break;
+		}
+	}
+
+	if (write_json(filename, results, number_of_results, min_seconds) != 0) {
+		printf("ERROR: could not write %s\n", filename);
+		return 1;
+	}
+	printf("Results written to %s\n", filename);
+	return 0;
+}
@@ -0,0 +1,220 @@
+/*********************************************************************
+* Filename:   bias_estimate.c
+* Copyright:
+* Disclaimer: This code is presented "as is" without any guarantees.
+* Details:    Measures the bias of linear approximations of the
+              reduced-round DES over many random keys. Every key
+              encrypts its own counter mode plaintexts; the bias is
+              taken with the sign of the key parity removed, so a key
+              independent approximation gives the same value for all
+              keys up to the sampling noise 1/(2 sqrt(N)). The excess
+              variance is the key dependence (linear hull effect). The
+              success rate of Matsui's algorithm 1 (guessing the key
+              parity) is reported for every power of two up to N.
+              Usage: bias_estimate [rounds] [keys] [plaintexts per key]
+                                   [threads] [approximation file]
+*********************************************************************/
+
+/*************************** HEADER FILES ***************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "des.h"
+#include "des_linear.h"
+#include "des_parallel.h"
+#include "des_stream.h"
+#include "des_table.h"
+
+/****************************** MACROS ******************************/
+#define ESTIMATE_MAX_APPROX 16
+#define ESTIMATE_BLOCK 1024             // plaintexts per encryption call, the smallest checkpoint
+#define ESTIMATE_MAX_CHECKPOINTS 32
+#define HISTOGRAM_BINS 16
+
+/**************************** DATA TYPES ****************************/
+typedef struct {
+	int rounds;
+	int number_of_keys;
+	int number_of_plains;
+	const LINEAR_APPROXIMATION *approx;
+	int number_of_approx;
+	int number_of_checkpoints;
+	int checkpoint[ESTIMATE_MAX_CHECKPOINTS];    // number of plaintexts at each checkpoint
+	BYTE (*keys)[DES_BLOCK_SIZE];
+	unsigned int *count_T0;             // [key][approx][checkpoint]
+	BYTE *right_side;                   // [key][approx]
+} ESTIMATE_JOB;
+
+/**************************** VARIABLES *****************************/
+static const BYTE key_seed[DES_BLOCK_SIZE] = {0x4B,0x45,0x59,0x53,0x45,0x45,0x44,0x31};
+static const BYTE data_seed[DES_BLOCK_SIZE] = {0x44,0x41,0x54,0x41,0x53,0x45,0x45,0x44};
+
+/*********************** FUNCTION DEFINITIONS ***********************/
+// Counts of key "item" at every checkpoint, the keys are the work items of parallel_run()
+static int estimate_key(void *arg, int worker, QWORD item)
+{
+	ESTIMATE_JOB *job = arg;
+	BYTE plain[ESTIMATE_BLOCK][DES_BLOCK_SIZE], cipher[ESTIMATE_BLOCK][DES_BLOCK_SIZE];
+	BYTE schedule[16][6];
+	unsigned int count[ESTIMATE_MAX_APPROX];
+	unsigned int *out;
+	DES_CRYPT_BLOCKS_FUNC crypt = des_crypt_blocks_select(job->rounds);
+	int k = (int)item, a, done, batch, c;
+
+	des_key_setup_table(job->keys[k], schedule, DES_ENCRYPT, job->rounds);
+	for (a = 0; a < job->number_of_approx; ++a) {
+		job->right_side[k * job->number_of_approx + a] = approximation_right_side(&job->approx[a], (const BYTE (*)[6])schedule);
+		count[a] = 0;
+	}
+
+	out = &job->count_T0[(size_t)k * job->number_of_approx * job->number_of_checkpoints];
+	for (done = 0, c = 0; done < job->number_of_plains; done += batch) {
+		batch = job->number_of_plains - done;
+		if (batch > ESTIMATE_BLOCK)
+			batch = ESTIMATE_BLOCK;
+		// the data of key k are the plaintexts k*N .. k*N+N-1 of one data set
+		counter_plaintexts(data_seed, (QWORD)k * job->number_of_plains + done, batch, plain);
+		crypt((const BYTE (*)[DES_BLOCK_SIZE])plain, cipher, (const BYTE (*)[6])schedule, batch);
+		// approximations with an F term use the right last round subkey
+		count_approximations((const BYTE (*)[DES_BLOCK_SIZE])plain, (const BYTE (*)[DES_BLOCK_SIZE])cipher, batch,
+		                     job->approx, job->number_of_approx, schedule[job->rounds - 1], count);
+		if (done + batch == job->checkpoint[c]) {
+			for (a = 0; a < job->number_of_approx; ++a)
+				out[a * job->number_of_checkpoints + c] = count[a];
+			++c;
+		}
+	}
+	return 0;
+}
+
+// Bias of key k at checkpoint c with the sign of the key parity removed
+static double key_bias(const ESTIMATE_JOB *job, int k, int a, int c)
+{
+	unsigned int t0 = job->count_T0[((size_t)k * job->number_of_approx + a) * job->number_of_checkpoints + c];
+	double bias = (double)t0 / job->checkpoint[c] - 0.5;
+
+	return job->right_side[k * job->number_of_approx + a] ? -bias : bias;
+}
+
+static void report(const ESTIMATE_JOB *job, int a)
+{
+	int last = job->number_of_checkpoints - 1;
+	int bins[HISTOGRAM_BINS] = {0};
+	double mean = 0, variance = 0, noise, hull, bias, low, high, width;
+	int k, c, b, agree, correct, sign;
+
+	for (k = 0; k < job->number_of_keys; ++k)
+		mean += key_bias(job, k, a, last);
+	mean /= job->number_of_keys;
+	for (k = 0; k < job->number_of_keys; ++k) {
+		bias = key_bias(job, k, a, last) - mean;
+		variance += bias * bias;
+	}
+	variance /= (job->number_of_keys > 1) ? job->number_of_keys - 1 : 1;
+	noise = 0.25 / job->number_of_plains;
+	hull = (variance > noise) ? sqrt(variance - noise) : 0;
+	sign = (mean < 0) ? -1 : 1;
+
+	printf("\nApproximation %d: %d rounds, P %016llX C %016llX F %08X\n", a + 1, job->approx[a].rounds,
+	       job->approx[a].plain_mask, job->approx[a].cipher_mask, job->approx[a].fmask);
+	printf("\tmean bias %+e (2^%.2f), standard deviation %e\n", mean, log2(fabs(mean) + 1e-300), sqrt(variance));
+	printf("\tsampling noise %e, key dependent part %e\n", sqrt(noise), hull);
+
+	// distribution of the per key biases
+	low = high = key_bias(job, 0, a, last);
+	for (k = 1, agree = 0; k < job->number_of_keys; ++k) {
+		bias = key_bias(job, k, a, last);
+		low = (bias < low) ? bias : low;
+		high = (bias > high) ? bias : high;
+	}
+	width = (high - low) / HISTOGRAM_BINS;
+	for (k = 0; k < job->number_of_keys; ++k) {
+		bias = key_bias(job, k, a, last);
+		b = (width > 0) ? (int)((bias - low) / width) : 0;
+		bins[b < HISTOGRAM_BINS ? b : HISTOGRAM_BINS - 1]++;
+		agree += (bias * sign > 0);
+	}
+	printf("\tkeys with the sign of the mean: %.1f%%\n", 100.0 * agree / job->number_of_keys);
+	printf("\tdistribution over the keys:\n");
+	for (b = 0; b < HISTOGRAM_BINS; ++b) {
+		printf("\t%+e %6d ", low + (b + 0.5) * width, bins[b]);
+		for (k = 0; k < 50 * bins[b] / job->number_of_keys; ++k)
+			printf("#");
+		printf("\n");
+	}
+
+	// algorithm 1 guesses the key parity from the sign of T0 - N/2 and the sign of the mean bias
+	printf("\tsuccess rate of algorithm 1:\n");
+	for (c = 0; c < job->number_of_checkpoints; ++c) {
+		for (k = 0, correct = 0; k < job->number_of_keys; ++k)
+			correct += (key_bias(job, k, a, c) * sign > 0);
+		printf("\t\tN = %9d: %5.1f%%\n", job->checkpoint[c], 100.0 * correct / job->number_of_keys);
+	}
+}
+
+int main(int argc, char *argv[])
+{
+	int rounds = (argc > 1) ? atoi(argv[1]) : 7;
+	int number_of_keys = (argc > 2) ? atoi(argv[2]) : 1000;
+	int number_of_plains = (argc > 3) ? atoi(argv[3]) : 1 << 16;
+	int threads = parallel_threads((argc > 4) ? atoi(argv[4]) : 0);
+	LINEAR_APPROXIMATION approx[ESTIMATE_MAX_APPROX], loaded[ESTIMATE_MAX_APPROX * 4];
+	ESTIMATE_JOB job;
+	int i, n;
+
+	memset(&job, 0, sizeof(job));
+	if (rounds < 1 || rounds > 16 || number_of_keys < 1 || number_of_plains < ESTIMATE_BLOCK) {
+		printf("ERROR: 1-16 rounds, at least one key and %d plaintexts per key\n", ESTIMATE_BLOCK);
+		return 1;
+	}
+	// whole blocks, so every checkpoint is the end of a block
+	number_of_plains -= number_of_plains % ESTIMATE_BLOCK;
+
+	if (argc > 5) {
+		n = load_approximations(argv[5], loaded, ESTIMATE_MAX_APPROX * 4);
+		if (n < 0) {
+			printf("ERROR: could not read %s\n", argv[5]);
+			return 1;
+		}
+		for (i = 0; i < n; ++i) {
+			if (loaded[i].rounds == rounds && job.number_of_approx < ESTIMATE_MAX_APPROX)
+				approx[job.number_of_approx++] = loaded[i];
+		}
+	}
+	else if (builtin_approximation(rounds) != NULL) {
+		approx[job.number_of_approx++] = *builtin_approximation(rounds);
+	}
+	if (job.number_of_approx == 0) {
+		printf("ERROR: no approximation for %d rounds\n", rounds);
+		return 1;
+	}
+
+	job.rounds = rounds;
+	job.number_of_keys = number_of_keys;
+	job.number_of_plains = number_of_plains;
+	job.approx = approx;
+	for (n = ESTIMATE_BLOCK; n < number_of_plains && job.number_of_checkpoints < ESTIMATE_MAX_CHECKPOINTS - 1; n <<= 1)
+		job.checkpoint[job.number_of_checkpoints++] = n;
+	job.checkpoint[job.number_of_checkpoints++] = number_of_plains;
+
+	job.keys = malloc((size_t)number_of_keys * DES_BLOCK_SIZE);
+	job.right_side = malloc((size_t)number_of_keys * job.number_of_approx);
+	job.count_T0 = malloc((size_t)number_of_keys * job.number_of_approx * job.number_of_checkpoints * sizeof(unsigned int));
+	if (job.keys == NULL || job.right_side == NULL || job.count_T0 == NULL) {
+		printf("ERROR: out of memory\n");
+		return 1;
+	}
+	counter_plaintexts(key_seed, 0, number_of_keys, job.keys);
+
+	printf("Measuring %d approximations for %d rounds over %d keys with %d plaintexts each (%d threads)...\n",
+	       job.number_of_approx, rounds, number_of_keys, number_of_plains, threads);
+	parallel_run(estimate_key, &job, number_of_keys, threads);
+	for (i = 0; i < job.number_of_approx; ++i)
+		report(&job, i);
+
+	free(job.keys);
+	free(job.right_side);
+	free(job.count_T0);
+	return 0;
+}
@@ -0,0 +1,55 @@
+/*********************************************************************
+* Filename:   dataset_generate.c
+* Copyright:
+* Disclaimer: This code is presented "as is" without any guarantees.
+* Details:    Writes a binary (P,C) data set file (see des_dataset.h)
+              on all cores, so later runs of an attack can map it
+              instead of generating and encrypting the texts again.
+              Usage: dataset_generate <file> [rounds] [pairs] [key id]
+                                      [seed as 16 hex digits] [threads]
+*********************************************************************/
+
+/*************************** HEADER FILES ***************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include "des.h"
+#include "des_dataset.h"
+#include "des_parallel.h"
+
+/*********************** FUNCTION DEFINITIONS ***********************/
+int main(int argc, char *argv[])
+{
+	int rounds = (argc > 2) ? atoi(argv[2]) : 8;
+	int number_of_pairs = (argc > 3) ? atoi(argv[3]) : 1 << 20;
+	QWORD key_id = (argc > 4) ? strtoull(argv[4], NULL, 0) : 0;
+	QWORD seed_word = (argc > 5) ? strtoull(argv[5], NULL, 16) : 0x0855A27887DD2CBCULL;
+	int threads = parallel_threads((argc > 6) ? atoi(argv[6]) : 0);
+	BYTE seed[DES_BLOCK_SIZE], key[DES_BLOCK_SIZE];
+	struct timespec start, end;
+	double seconds;
+	int i;
+
+	if (argc < 2 || rounds < 1 || rounds > 16 || number_of_pairs < 1) {
+		printf("Usage: %s <file> [rounds 1-16] [pairs] [key id] [seed as 16 hex digits] [threads]\n", argv[0]);
+		return 1;
+	}
+	for (i = 0; i < DES_BLOCK_SIZE; ++i)
+		seed[i] = (seed_word >> (8 * (7 - i))) & 0xFF;
+	dataset_key(key_id, key);
+
+	printf("Writing %d pairs of %d round DES under key %llu (", number_of_pairs, rounds, key_id);
+	for (i = 0; i < DES_BLOCK_SIZE; ++i)
+		printf("%02X", key[i]);
+	printf(") to %s with %d threads...\n", argv[1], threads);
+
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	if (dataset_create(argv[1], key_id, rounds, seed, number_of_pairs, threads) != 0) {
+		printf("ERROR: could not write %s\n", argv[1]);
+		return 1;
+	}
+	clock_gettime(CLOCK_MONOTONIC, &end);
+	seconds = (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) / 1e9;
+	printf("Done in %.2f s (%.2f Mpairs/s)\n", seconds, number_of_pairs / seconds / 1e6);
+	return 0;
+}
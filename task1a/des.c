@@ -13,6 +13,9 @@
 #include <stdlib.h>
 #include <memory.h>
 #include "des.h"
+#include "des_linear.h"
+#include "des_stats.h"
+#include "des_table.h"
 
 /****************************** MACROS ******************************/
 // Obtain bit "b" from the left and shift it "c" places from the right
@@ -24,6 +27,9 @@
 // bits to a 6 bit block with the row defined by the first two bits.
 #define SBOXBIT(a) (((a) & 0x20) | (((a) & 0x1f) >> 1) | (((a) & 0x01) << 4))
 
+// The 6 expanded bits of the right half "a" that enter S-Box 1 (R[31], R[0..4] from the left)
+#define SBOX1_INPUT(a) ((((a) & 0x01) << 5) | (((a) >> 27) & 0x1f))
+
 /**************************** VARIABLES *****************************/
 static const BYTE sbox1[64] = {
 	14,  4,  13,  1,   2, 15,  11,  8,   3, 10,   6, 12,   5,  9,   0,  7,
@@ -74,6 +80,32 @@ static const BYTE sbox8[64] = {
 	 2,  1,  14,  7,   4, 10,   8, 13,  15, 12,   9,  0,   3,  5,   6, 11
 };
 
+// Expansion permutation, bit i of the expanded state is bit des_expansion[i] of R (counted from the left)
+const BYTE des_expansion[48] = {
+	31,  0,  1,  2,  3,  4,   3,  4,  5,  6,  7,  8,
+	 7,  8,  9, 10, 11, 12,  11, 12, 13, 14, 15, 16,
+	15, 16, 17, 18, 19, 20,  19, 20, 21, 22, 23, 24,
+	23, 24, 25, 26, 27, 28,  27, 28, 29, 30, 31,  0
+};
+
+// P-Box permutation, bit i of f() is bit des_pbox[i] of the S-Box output (counted from the left)
+const BYTE des_pbox[32] = {
+	15,  6, 19, 20, 28, 11, 27, 16,   0, 14, 22, 25,  4, 17, 30,  9,
+	 1,  7, 23, 13, 31, 26,  2,  8,  18, 12, 29,  5, 21, 10,  3, 24
+};
+
+// Key schedule: rotation of C and D per round, Permuted Choice #1 (key bits counted from the left)
+// and Permuted Choice #2 (bits of C followed by the bits of D, counted from the left)
+const BYTE des_key_rnd_shift[16] = {1,1,2,2,2,2,2,2,1,2,2,2,2,2,2,1};
+const BYTE des_key_perm_c[28] = {56,48,40,32,24,16,8,0,57,49,41,33,25,17,
+                                 9,1,58,50,42,34,26,18,10,2,59,51,43,35};
+const BYTE des_key_perm_d[28] = {62,54,46,38,30,22,14,6,61,53,45,37,29,21,
+                                 13,5,60,52,44,36,28,20,12,4,27,19,11,3};
+const BYTE des_key_compression[48] = {13,16,10,23,0,4,2,27,14,5,20,9,
+                                      22,18,11,3,25,7,15,6,26,19,12,1,
+                                      40,51,30,36,46,54,29,39,50,44,32,47,
+                                      43,48,38,55,33,52,45,41,49,35,28,31};
+
 /*********************** FUNCTION DEFINITIONS ***********************/
 void Initial_Breakup(WORD state[], const BYTE in[])
 {
@@ -98,6 +130,12 @@ void Final_Assembling(WORD state[], BYTE out[])
 }
 
 
+BYTE des_sbox(int s, BYTE x)
+{
+	static const BYTE *sbox[8] = {sbox1, sbox2, sbox3, sbox4, sbox5, sbox6, sbox7, sbox8};
+	return sbox[s-1][SBOXBIT(x & 0x3f)];
+}
+
 WORD f(WORD state, const BYTE key[])
 {
 	BYTE lrgstate[6]; //,i;
@@ -159,26 +197,20 @@ WORD f(WORD state, const BYTE key[])
 void des_key_setup(const BYTE key[], BYTE schedule[][6], DES_MODE mode, const int rounds)
 {
 	WORD i, j, to_gen, C, D;
-	const WORD key_rnd_shift[16] = {1,1,2,2,2,2,2,2,1,2,2,2,2,2,2,1};
-	const WORD key_perm_c[28] = {56,48,40,32,24,16,8,0,57,49,41,33,25,17,
-	                             9,1,58,50,42,34,26,18,10,2,59,51,43,35};
-	const WORD key_perm_d[28] = {62,54,46,38,30,22,14,6,61,53,45,37,29,21,
-	                             13,5,60,52,44,36,28,20,12,4,27,19,11,3};
-	const WORD key_compression[48] = {13,16,10,23,0,4,2,27,14,5,20,9,
-	                                  22,18,11,3,25,7,15,6,26,19,12,1,
-	                                  40,51,30,36,46,54,29,39,50,44,32,47,
-	                                  43,48,38,55,33,52,45,41,49,35,28,31};
+	STATS_TIMER(timer);
+
+	STATS_BEGIN(timer);
 
 	// Permutated Choice #1 (copy the key in, ignoring parity bits).
 	for (i = 0, j = 31, C = 0; i < 28; ++i, --j)
-		C |= BITNUM(key,key_perm_c[i],j);
+		C |= BITNUM(key,des_key_perm_c[i],j);
 	for (i = 0, j = 31, D = 0; i < 28; ++i, --j)
-		D |= BITNUM(key,key_perm_d[i],j);
+		D |= BITNUM(key,des_key_perm_d[i],j);
 
 	// Generate the round subkeys.
 	for (i = 0; i < rounds; ++i) {
-		C = ((C << key_rnd_shift[i]) | (C >> (28-key_rnd_shift[i]))) & 0xfffffff0;
-		D = ((D << key_rnd_shift[i]) | (D >> (28-key_rnd_shift[i]))) & 0xfffffff0;
+		C = ((C << des_key_rnd_shift[i]) | (C >> (28-des_key_rnd_shift[i]))) & 0xfffffff0;
+		D = ((D << des_key_rnd_shift[i]) | (D >> (28-des_key_rnd_shift[i]))) & 0xfffffff0;
 
 		// Decryption subkeys are reverse order of encryption subkeys so
 		// generate them in reverse if the key schedule is for decryption useage.
@@ -190,10 +222,11 @@ void des_key_setup(const BYTE key[], BYTE schedule[][6], DES_MODE mode, const in
 		for (j = 0; j < 6; ++j)
 			schedule[to_gen][j] = 0;
 		for (j = 0; j < 24; ++j)
-			schedule[to_gen][j/8] |= BITNUMINTR(C,key_compression[j],7 - (j%8));
+			schedule[to_gen][j/8] |= BITNUMINTR(C,des_key_compression[j],7 - (j%8));
 		for ( ; j < 48; ++j)
-			schedule[to_gen][j/8] |= BITNUMINTR(D,key_compression[j] - 28,7 - (j%8));
+			schedule[to_gen][j/8] |= BITNUMINTR(D,des_key_compression[j] - 28,7 - (j%8));
 	}
+	STATS_END(STATS_KEY_SETUP, timer, 0, 0, 0);
 }
 
 void des_crypt(const BYTE in[], BYTE out[], const BYTE key[][6], const int rounds)
@@ -219,168 +252,101 @@ void rand_plaintext(const BYTE curr_state[], BYTE next_state[], BYTE output_plai
 	BYTE in0[DES_BLOCK_SIZE] = {0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00};
 	BYTE in1[DES_BLOCK_SIZE] = {0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x01};
 	BYTE schedule[8][6];
-	des_key_setup(curr_state,schedule,DES_ENCRYPT,8);
-	des_crypt(in0, next_state, schedule, 8);
-	des_crypt(in1, output_plaintext, schedule, 8);
+	//re-keyed for every plaintext, so the table-driven functions are used
+	des_key_setup_table(curr_state,schedule,DES_ENCRYPT,8);
+	des_crypt_table(in0, next_state, schedule, 8);
+	des_crypt_table(in1, output_plaintext, schedule, 8);
 }
 
 BYTE compute_left_side(const BYTE plaintext[], const BYTE ciphertext[], int rounds, const WORD f)
 {
-	if((rounds != 3)&&(rounds != 5)&&(rounds !=7)&&(rounds != 8))
+	//the approximations for 3, 5, 7 and 8 rounds are described by masks in des_linear.c
+	const LINEAR_APPROXIMATION *approx = builtin_approximation(rounds);
+	if(approx == NULL)
 	{
 		return 0xFF;
 	}
-	if(rounds == 3)
-	{
-		//gather the needed bits for 3 rounds
-		//using R0[15] ^ L3[15] ^ L0[7,18,24,29] ^ R3[7,18,24,29]
-		BYTE Pr15,Cl15,Pl7,Pl18,Pl24,Pl29,Cr7,Cr18,Cr24,Cr29;
-		Pr15 = (plaintext[6] >> 7) & 0x01;
-		Cl15 = (ciphertext[2] >> 7) & 0x01;
-		Pl7 = (plaintext[3] >> 7) & 0x01;
-		Pl18 = (plaintext[1] >> 2) & 0x01;
-		Pl24 = plaintext[0] & 0x01;
-		Pl29 = (plaintext[0] >> 5) & 0x01;
-		Cr7 = (ciphertext[7] >> 7) & 0x01;
-		Cr18 = (ciphertext[5] >> 2) & 0x01;
-		Cr24 = ciphertext[4] & 0x01;
-		Cr29 = (ciphertext[4] >> 5) & 0x01;
-		return (Pr15 ^ Cl15 ^ Pl7 ^ Pl18 ^ Pl24 ^ Pl29 ^ Cr7 ^ Cr18 ^ Cr24 ^ Cr29);
-	}
-	else if(rounds == 5)
-	{
-		//gather the bits for 5 rounds
-		//using L0[15] ^ R0[7,18,24,27,28,29,30,31] ^ R5[15] ^ L5[7,18,24,27,28,29,30,31]
-		BYTE Pl15,Pr7,Pr18,Pr24,Pr27,Pr28,Pr29,Pr30,Pr31;
-		BYTE Cr15,Cl7,Cl18,Cl24,Cl27,Cl28,Cl29,Cl30,Cl31;
-		Pl15 = (plaintext[2] >> 7) & 0x01;
-		Pr7 = (plaintext[7] >> 7) & 0x01;
-		Pr18 = (plaintext[5] >> 2) & 0x01;
-		Pr24 = plaintext[4] & 0x01;
-		Pr27 = (plaintext[4] >> 3) & 0x01;
-		Pr28 = (plaintext[4] >> 4) & 0x01;
-		Pr29 = (plaintext[4] >> 5) & 0x01;
-		Pr30 = (plaintext[4] >> 6) & 0x01;
-		Pr31 = (plaintext[4] >> 7) & 0x01;
-		Cr15 = (ciphertext[6] >> 7) & 0x01;
-		Cl7 = (ciphertext[3] >> 7) & 0x01;
-		Cl18 = (ciphertext[1] >> 2) & 0x01;
-		Cl24 = ciphertext[0] & 0x01;
-		Cl27 = (ciphertext[0] >> 3) & 0x01;
-		Cl28 = (ciphertext[0] >> 4) & 0x01;
-		Cl29 = (ciphertext[0] >> 5) & 0x01;
-		Cl30 = (ciphertext[0] >> 6) & 0x01;
-		Cl31 = (ciphertext[0] >> 7) & 0x01;
-		return (Pl15 ^ Pr7 ^ Pr18 ^ Pr24 ^ Pr27 ^ Pr28 ^ Pr29 ^ Pr30 ^ Pr31 ^ Cr15 ^ Cl7 ^ Cl18 ^ Cl24 ^ Cl27 ^ Cl28 ^ Cl29 ^ Cl30 ^ Cl31);
-	}
-	else if(rounds == 7)
-	{
-		//using L0[7,18,24] ^ R0[12,16] ^ R7[15] ^ L7[7,18,24,29]   because R7 = L8 and L7 = R8 if F(R8,K8) is 0 (there is no K8 in 7 rounds)
-		BYTE Pl7, Pl18, Pl24, Pr12, Pr16;
-		BYTE Cl7, Cl18, Cl24, Cl29, Cr15;
-		Pl7 = (plaintext[3] >> 7) & 0x01;
-		Pl18 = (plaintext[1] >> 2) & 0x01;
-		Pl24 = (plaintext[0]) & 0x01;
-		Pr12 = (plaintext[6] >> 4) & 0x01;
-		Pr16 = (plaintext[5]) & 0x01;
-		Cl7 = (ciphertext[3] >> 7) & 0x01;
-		Cl18 = (ciphertext[1] >> 2) & 0x01;
-		Cl24 = ciphertext[0] & 0x01;
-		Cl29 = (ciphertext[0] >> 5) & 0x01;
-		Cr15 = (ciphertext[6] >> 7) & 0x01;
-
-		/* L0[7,18,24] ^ R0[12,16] ^ L7[15] ^ R7[7,18,24,29]   other interpretation of the 7 round approximation
-		BYTE Cl15, Cr7, Cr18, Cr24, Cr29;
-		Cl15 = (ciphertext[3] >> 7) & 0x01;
-		Cr7 = (ciphertext[7] >> 7) & 0x01;
-		Cr18 = (ciphertext[5] >> 2) & 0x01;
-		Cr24 = (ciphertext[4]) & 0x01;
-		Cr29 = (ciphertext[4] >> 5) & 0x01;
-		return (Pl7 ^ Pl18 ^ Pl24 ^ Pr12 ^ Pr16 ^ Cl15 ^ Cr7 ^ Cr18 ^ Cr24 ^ Cr29);*/
-
-		return (Pl7 ^ Pl18 ^ Pl24 ^ Pr12 ^ Pr16 ^ Cl7 ^ Cl18 ^ Cl24 ^ Cl29 ^ Cr15);
-	}
-	else
-	{
-		//using L0[7,18,24] ^ R0[12,16] ^ L7[15] ^ R7[7,18,24,29] ^ F(R8,K8)[15]
-		BYTE Pl7, Pl18, Pl24, Pr12, Pr16;
-		BYTE Cl15, Cr7, Cr18, Cr24, Cr29, F8;
-		Pl7 = (plaintext[3] >> 7) & 0x01;
-		Pl18 = (plaintext[1] >> 2) & 0x01;
-		Pl24 = (plaintext[0]) & 0x01;
-		Pr12 = (plaintext[6] >> 4) & 0x01;
-		Pr16 = (plaintext[5]) & 0x01;
-		Cr7 = (ciphertext[7] >> 7) & 0x01;
-		Cr18 = (ciphertext[5] >> 2) & 0x01;
-		Cr24 = ciphertext[4] & 0x01;
-		Cr29 = (ciphertext[4] >> 5) & 0x01;
-		Cl15 = (ciphertext[2] >> 7) & 0x01;
-		F8 = (f >> 15) & 0x01; //F[R8,K8][15] here
-		return (Pl7 ^ Pl18 ^ Pl24 ^ Pr12 ^ Pr16 ^ Cr7 ^ Cr18 ^ Cr24 ^ Cr29 ^ Cl15 ^ F8);
-	}
-
-	return 0xFF;
+	return approximation_left_side(approx, block_to_qword(plaintext), block_to_qword(ciphertext), f);
 }
 
-void algorithm1(const BYTE plain[][DES_BLOCK_SIZE], const BYTE key[][6], unsigned int* count_T0, unsigned int* count_T1, int number_of_plains, int rounds, const BYTE keyguess[])
+int count_left_side(const BYTE plain[][DES_BLOCK_SIZE], const BYTE cipher[][DES_BLOCK_SIZE], unsigned int* count_T0, unsigned int* count_T1, int number_of_plains, int rounds, const BYTE keyguess[])
 {
-	BYTE ciphertext[DES_BLOCK_SIZE];
 	int i = 0;
 	BYTE solution = 0x00;
-    WORD f8 = 0;
-    WORD c8[2];
+	WORD f8 = 0;
+	WORD c8[2];
 
 	for(i = 0; i < number_of_plains; i++)
 	{
-		des_crypt(plain[i], ciphertext, key, rounds);
-
 		if(rounds == 8)
 		{
 			//computing F(R8,K8') for the 8 round attack
-            Initial_Breakup(c8,ciphertext);
-            f8 = f(c8[1], keyguess);
+			Initial_Breakup(c8,cipher[i]);
+			f8 = f_table(c8[1], keyguess);
 		}
 
-		solution = compute_left_side(plain[i], ciphertext, rounds, f8);
+		solution = compute_left_side(plain[i], cipher[i], rounds, f8);
 		if(solution == 0xFF)
+		{
+			return -1;
+		}
+		if(solution == 0x00)
+		{
+			*count_T0 += 1;
+		}
+		else if(solution == 0x01)
+		{
+			*count_T1 += 1;
+		}
+	}
+	return 0;
+}
+
+void algorithm1(const BYTE plain[][DES_BLOCK_SIZE], const BYTE key[][6], unsigned int* count_T0, unsigned int* count_T1, int number_of_plains, int rounds, const BYTE keyguess[])
+{
+	BYTE ciphertext[DES_TABLE_BATCH][DES_BLOCK_SIZE];
+	//the des_crypt version for this round count is picked once for all plaintexts
+	DES_CRYPT_BLOCKS_FUNC crypt = des_crypt_blocks_select(rounds);
+	int i = 0;
+	int batch = 0;
+	STATS_TIMER(timer);
+
+	if(crypt == NULL)
+	{
+		*count_T0 = -1;
+		*count_T1 = -1;
+		return;
+	}
+	STATS_BEGIN(timer);
+
+	for(i = 0; i < number_of_plains; i += DES_TABLE_BATCH)
+	{
+		//encrypt the next batch of plaintexts at once
+		batch = number_of_plains - i;
+		if(batch > DES_TABLE_BATCH)
+		{
+			batch = DES_TABLE_BATCH;
+		}
+		crypt(&plain[i], ciphertext, key, batch);
+		if(count_left_side(&plain[i], (const BYTE (*)[DES_BLOCK_SIZE])ciphertext, count_T0, count_T1, batch, rounds, keyguess) != 0)
 		{
 			*count_T0 = -1;
 			*count_T1 = -1;
-			return;
+			break;
 		}
-        if(solution == 0x00)
-        {
-        	*count_T0 += 1;
-        }
-        else if(solution == 0x01)
-        {
-        	*count_T1 += 1;
-        }
 	}
+	//i is the first plaintext of the batch that failed if the loop was left early
+	STATS_END(STATS_ALGORITHM1, timer, (i < number_of_plains) ? i : number_of_plains, 1, 0);
 }
 
-int algorithm2(const BYTE plain[][DES_BLOCK_SIZE], const BYTE keyschedule[][6], BYTE key8bits[], unsigned int count_T0[], unsigned int count_T1[], int number_of_plains, int keyguesses)
+int select_keyguess(BYTE key8bits[], const unsigned int count_T0[], const unsigned int count_T1[], int keyguesses)
 {
-	BYTE keyguess[6];
 	int i = 0;
 	int correct_keyguess = 0;
 	unsigned int diff[keyguesses];
-	//only bits 42-47 of K8 are relevant, setting other bits to 0
-	keyguess[1] = 0x00;
-	keyguess[2] = 0x00;
-	keyguess[3] = 0x00;
-	keyguess[4] = 0x00;
-	keyguess[5] = 0x00;
 
 	for(i = 0; i<keyguesses; i++)
 	{
-		//initialize counters
-		count_T0[i] = 0;
-		count_T1[i] = 0;
-		//guess key, only 6 bits are effective (???? ??00)
-        keyguess[0] = (i << 2) & 0xFC;
-
-		algorithm1(plain, keyschedule, &count_T0[i], &count_T1[i], number_of_plains, 8, keyguess);
 		if(count_T0[i] > count_T1[i])
 		{
 			diff[i] = count_T0[i] - count_T1[i];
@@ -401,13 +367,120 @@ int algorithm2(const BYTE plain[][DES_BLOCK_SIZE], const BYTE keyschedule[][6],
 			correct_keyguess = i;
 		}
 	}
-	keyguess[0] = (correct_keyguess << 2) & 0xFC;
 
 	//storing the guessed key bits K8[42] - K8[47]
 	for(i = 0; i < 6; i++)
 	{
-		key8bits[i] = (keyguess[0] >> (2+i)) & 0x01;
+		key8bits[i] = (((correct_keyguess << 2) & 0xFC) >> (2+i)) & 0x01;
 	}
 	return correct_keyguess;
 }
 
+int algorithm2(const BYTE plain[][DES_BLOCK_SIZE], const BYTE keyschedule[][6], BYTE key8bits[], unsigned int count_T0[], unsigned int count_T1[], int number_of_plains, int keyguesses)
+{
+	BYTE keyguess[6];
+	int i = 0;
+	int correct_keyguess = 0;
+	STATS_TIMER(timer);
+
+	STATS_BEGIN(timer);
+	//only bits 42-47 of K8 are relevant, setting other bits to 0
+	keyguess[1] = 0x00;
+	keyguess[2] = 0x00;
+	keyguess[3] = 0x00;
+	keyguess[4] = 0x00;
+	keyguess[5] = 0x00;
+
+	for(i = 0; i<keyguesses; i++)
+	{
+		//initialize counters
+		count_T0[i] = 0;
+		count_T1[i] = 0;
+		//guess key, only 6 bits are effective (???? ??00)
+        keyguess[0] = (i << 2) & 0xFC;
+
+		algorithm1(plain, keyschedule, &count_T0[i], &count_T1[i], number_of_plains, 8, keyguess);
+	}
+
+	correct_keyguess = select_keyguess(key8bits, count_T0, count_T1, keyguesses);
+	STATS_END(STATS_ALGORITHM2, timer, (QWORD)number_of_plains * keyguesses, keyguesses, 0);
+	return correct_keyguess;
+}
+
+int encrypt_plaintexts(const BYTE plain[][DES_BLOCK_SIZE], BYTE cipher[][DES_BLOCK_SIZE], const BYTE key[][6], int number_of_plains, int rounds)
+{
+	return des_crypt_blocks(plain, cipher, key, number_of_plains, rounds);
+}
+
+void compress_pairs(const BYTE plain[][DES_BLOCK_SIZE], const BYTE cipher[][DES_BLOCK_SIZE], unsigned int counter[], int number_of_plains)
+{
+	int i = 0;
+	BYTE parity = 0x00;
+	WORD c8[2];
+
+	for(i = 0; i < number_of_plains; i++)
+	{
+		//left side of the 8 round approximation without the F(R8,K8)[15] term
+		parity = compute_left_side(plain[i], cipher[i], 8, 0);
+		Initial_Breakup(c8,cipher[i]);
+		counter[(parity << 6) | SBOX1_INPUT(c8[1])] += 1;
+	}
+}
+
+void evaluate_keyguesses(const unsigned int counter[], unsigned int count_T0[], unsigned int count_T1[], int keyguesses)
+{
+	BYTE keyguess[6] = {0x00,0x00,0x00,0x00,0x00,0x00};
+	BYTE solution = 0x00;
+	WORD r8 = 0;
+	int i = 0;
+	int idx = 0;
+
+	for(i = 0; i < keyguesses; i++)
+	{
+		count_T0[i] = 0;
+		count_T1[i] = 0;
+		keyguess[0] = (i << 2) & 0xFC;
+
+		for(idx = 0; idx < ALGORITHM2_COUNTER_SIZE; idx++)
+		{
+			//any R8 with these 6 bits gives the same F(R8,K8)[15]
+			r8 = ((idx >> 5) & 0x01) | ((idx & 0x1F) << 27);
+			solution = ((idx >> 6) ^ (f(r8, keyguess) >> 15)) & 0x01;
+			if(solution == 0x00)
+			{
+				count_T0[i] += counter[idx];
+			}
+			else
+			{
+				count_T1[i] += counter[idx];
+			}
+		}
+	}
+}
+
+int algorithm2_cached(const BYTE plain[][DES_BLOCK_SIZE], const BYTE keyschedule[][6], BYTE key8bits[], unsigned int count_T0[], unsigned int count_T1[], int number_of_plains, int keyguesses)
+{
+	BYTE (*cipher)[DES_BLOCK_SIZE];
+	unsigned int counter[ALGORITHM2_COUNTER_SIZE];
+	int correct_keyguess = 0;
+	STATS_TIMER(timer);
+
+	//encrypt the whole data set only once
+	STATS_BEGIN(timer);
+	cipher = malloc((size_t)number_of_plains * DES_BLOCK_SIZE);
+	if(cipher == NULL || encrypt_plaintexts(plain, cipher, keyschedule, number_of_plains, 8) != 0)
+	{
+		STATS_END(STATS_ALGORITHM2, timer, 0, 0, (cipher != NULL) ? (QWORD)number_of_plains * DES_BLOCK_SIZE : 0);
+		free(cipher);
+		return -1;
+	}
+
+	memset(counter, 0, sizeof(counter));
+	compress_pairs(plain, cipher, counter, number_of_plains);
+	free(cipher);
+
+	evaluate_keyguesses(counter, count_T0, count_T1, keyguesses);
+	correct_keyguess = select_keyguess(key8bits, count_T0, count_T1, keyguesses);
+	STATS_END(STATS_ALGORITHM2, timer, number_of_plains, keyguesses, (QWORD)number_of_plains * DES_BLOCK_SIZE);
+	return correct_keyguess;
+}
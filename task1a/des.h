@@ -10,28 +10,55 @@
 *********************************************************************/
 
 #ifndef DES_H
-#define DESH
+#define DES_H
 
 /*************************** HEADER FILES ***************************/
 #include <stddef.h>
 
 /****************************** MACROS ******************************/
 #define DES_BLOCK_SIZE 8                // DES operates on 8 bytes at a time
+#define ALGORITHM2_COUNTER_SIZE 128     // parity bit + 6 bits entering S-Box 1 of round 8
 
 /**************************** DATA TYPES ****************************/
 typedef unsigned char BYTE;             // 8-bit byte
 typedef unsigned int  WORD;             // 32-bit word, change to "long" for 16-bit machines
+typedef unsigned long long QWORD;       // 64-bit word
 
 typedef enum {
 	DES_ENCRYPT,
 	DES_DECRYPT
 } DES_MODE;
 
+/**************************** VARIABLES *****************************/
+extern const BYTE des_expansion[48];
+extern const BYTE des_pbox[32];
+extern const BYTE des_key_rnd_shift[16];
+extern const BYTE des_key_perm_c[28];
+extern const BYTE des_key_perm_d[28];
+extern const BYTE des_key_compression[48];
+
 /*********************** FUNCTION DECLARATIONS **********************/
+void Initial_Breakup(WORD state[], const BYTE in[]);
+void Final_Assembling(WORD state[], BYTE out[]);
+// Output of S-Box "s" (1..8) for the raw 6 bit input "x"
+BYTE des_sbox(int s, BYTE x);
+WORD f(WORD state, const BYTE key[]);
 void des_key_setup(const BYTE key[], BYTE schedule[][6], DES_MODE mode, const int rounds);
 void des_crypt(const BYTE in[], BYTE out[], const BYTE key[][6], const int rounds);
+// The sequential generator the attacks used before counter_plaintexts(), kept only to compare them in the benchmark
 void rand_plaintext(const BYTE curr_state[], BYTE next_state[], BYTE output_plaintext[]);
+BYTE compute_left_side(const BYTE plaintext[], const BYTE ciphertext[], int rounds, const WORD f);
+// Adds the left sides of the approximation for already encrypted pairs to T0/T1, -1 for other round counts
+int count_left_side(const BYTE plain[][DES_BLOCK_SIZE], const BYTE cipher[][DES_BLOCK_SIZE], unsigned int* count_T0, unsigned int* count_T1, int number_of_plains, int rounds, const BYTE keyguess[]);
 void algorithm1(const BYTE plain[][DES_BLOCK_SIZE],const BYTE key[][6], unsigned int* count_T0, unsigned int* count_T1, int number_of_plains,int rounds, const BYTE keyguess[]);
 int algorithm2(const BYTE plain[][DES_BLOCK_SIZE], const BYTE keyschedule[][6], BYTE key8bits[], unsigned int count_T0[], unsigned int count_T1[], int number_of_plains, int keyguesses);
+int select_keyguess(BYTE key8bits[], const unsigned int count_T0[], const unsigned int count_T1[], int keyguesses);
+
+// Encrypt-once mode of algorithm 2: the (P,C) pairs are compressed into a counter
+// over the bits the 8 round approximation uses before the key guesses are evaluated
+int encrypt_plaintexts(const BYTE plain[][DES_BLOCK_SIZE], BYTE cipher[][DES_BLOCK_SIZE], const BYTE key[][6], int number_of_plains, int rounds);
+void compress_pairs(const BYTE plain[][DES_BLOCK_SIZE], const BYTE cipher[][DES_BLOCK_SIZE], unsigned int counter[], int number_of_plains);
+void evaluate_keyguesses(const unsigned int counter[], unsigned int count_T0[], unsigned int count_T1[], int keyguesses);
+int algorithm2_cached(const BYTE plain[][DES_BLOCK_SIZE], const BYTE keyschedule[][6], BYTE key8bits[], unsigned int count_T0[], unsigned int count_T1[], int number_of_plains, int keyguesses);
 
 #endif   // DES_H
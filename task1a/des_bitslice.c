@@ -0,0 +1,174 @@
+/*********************************************************************
+* Filename:   des_bitslice.c
+* Copyright:
+* Disclaimer: This code is presented "as is" without any guarantees.
+* Details:    Bitsliced implementation of the reduced-round DES from
+              des.c. Bit i of all blocks of a batch is kept in one
+              machine word (plane i), so every Boolean operation works
+              on DES_BS_BLOCKS blocks at once. The S-boxes are evaluated
+              as multiplexer circuits built from their truth tables.
+*********************************************************************/
+
+/*************************** HEADER FILES ***************************/
+#include "des_bitslice.h"
+
+/**************************** VARIABLES *****************************/
+// Truth tables of the four output bits (MSB first) of sbox1..sbox8 in des.c.
+// Bit v of an entry is the output for the raw 6 bit S-Box input v, i.e. before SBOXBIT().
+static const QWORD sbox_truth[8][4] = {
+	{0x869D497A86E67619ULL, 0xB0C7871B497826BDULL, 0x27E9D492609F1F29ULL, 0x917BE9066F81B478ULL},
+	{0xE196196E69C3A659ULL, 0x68F93C169346C3E9ULL, 0x746A8B7462949FC3ULL, 0xCD235AD2B865168FULL},
+	{0x96692D696B9C90D3ULL, 0xD96A863526F4794AULL, 0x76B9960C39C2B749ULL, 0x4B8D9C63A965569AULL},
+	{0x92C3E719ED90583EULL, 0xCB69718C74CA0E97ULL, 0xACD1168F692CCE71ULL, 0x09B77C1AC34998E7ULL},
+	{0x429DCD6A79E1348EULL, 0x695B9CA191666B96ULL, 0xC70B39C692F05D2BULL, 0xA4CD96D24B76B948ULL},
+	{0xB44AB695C9A4695BULL, 0xC69938D615E69A69ULL, 0x52CBE13C6D9216DAULL, 0x95A36A597C3CA34CULL},
+	{0x92C761F82C96D966ULL, 0x869CD96699E643C3ULL, 0x6A95F41A9E4B81F4ULL, 0x348E9679497969A6ULL},
+	{0xC17ABD2438C716B9ULL, 0x394E96B1596AA569ULL, 0xA71658A7C8F13F0CULL, 0x9F6281CD619C7C2BULL}
+};
+
+static const BS_WORD bs_zero;
+
+/*********************** FUNCTION DEFINITIONS ***********************/
+// Transposes a 64x64 bit matrix: bit j (from the left) of a[i] becomes bit i (from the left) of a[j]
+static void transpose64(QWORD a[64])
+{
+	int j, k;
+	QWORD m, t;
+
+	for (j = 32, m = 0x00000000FFFFFFFFULL; j; j >>= 1, m ^= m << j) {
+		for (k = 0; k < 64; k = ((k | j) + 1) & ~j) {
+			t = (a[k] ^ (a[k | j] >> j)) & m;
+			a[k] ^= t;
+			a[k | j] ^= t << j;
+		}
+	}
+}
+
+// Evaluates one S-Box on six bit-planes (x[0] is the leftmost input bit).
+// Every output bit is a multiplexer tree over its truth table, the two lowest
+// input bits are resolved by picking one of the 16 functions of two variables.
+static void bs_sbox(const BS_WORD x[6], const QWORD truth[4], BS_WORD out[4])
+{
+	BS_WORD minterm[4], f2[16], leaf[16];
+	int n, b, q, w, sel;
+
+	minterm[0] = ~x[4] & ~x[5];
+	minterm[1] = ~x[4] & x[5];
+	minterm[2] = x[4] & ~x[5];
+	minterm[3] = x[4] & x[5];
+	f2[0] = bs_zero;
+	for (n = 1; n < 16; ++n)
+		f2[n] = f2[n & (n - 1)] | minterm[__builtin_ctz(n)];
+
+	for (b = 0; b < 4; ++b) {
+		for (q = 0; q < 16; ++q)
+			leaf[q] = f2[(truth[b] >> (4 * q)) & 0x0F];
+		// select on x[3], x[2], x[1] and finally x[0]
+		for (w = 8, sel = 3; w; w >>= 1, --sel) {
+			for (q = 0; q < w; ++q)
+				leaf[q] = leaf[2*q] ^ ((leaf[2*q] ^ leaf[2*q+1]) & x[sel]);
+		}
+		out[b] = leaf[0];
+	}
+}
+
+void des_bs_key_setup(const BYTE key[][6], BS_WORD bs_key[][48], const int rounds)
+{
+	int idx, i;
+
+	for (idx = 0; idx < rounds; ++idx) {
+		for (i = 0; i < 48; ++i)
+			bs_key[idx][i] = ((key[idx][i/8] >> (7 - (i%8))) & 0x01) ? ~bs_zero : bs_zero;
+	}
+}
+
+void des_bs_load(const BYTE in[][DES_BLOCK_SIZE], BS_WORD state[64], int number_of_blocks)
+{
+	QWORD *words = (QWORD *)state;
+	QWORD m[64];
+	int g, j, i, blk;
+
+	for (g = 0; g < DES_BS_WORDS; ++g) {
+		for (j = 0; j < 64; ++j) {
+			blk = g * 64 + j;
+			m[j] = 0;
+			if (blk < number_of_blocks) {
+				for (i = 0; i < DES_BLOCK_SIZE; ++i)
+					m[j] = (m[j] << 8) | in[blk][i];
+			}
+		}
+		transpose64(m);
+		for (i = 0; i < 64; ++i)
+			words[i * DES_BS_WORDS + g] = m[i];
+	}
+}
+
+void des_bs_store(const BS_WORD state[64], BYTE out[][DES_BLOCK_SIZE], int number_of_blocks)
+{
+	const QWORD *words = (const QWORD *)state;
+	QWORD m[64];
+	int g, j, i, blk;
+
+	for (g = 0; g < DES_BS_WORDS; ++g) {
+		for (i = 0; i < 64; ++i)
+			m[i] = words[i * DES_BS_WORDS + g];
+		transpose64(m);
+		for (j = 0; j < 64; ++j) {
+			blk = g * 64 + j;
+			if (blk >= number_of_blocks)
+				return;
+			for (i = 0; i < DES_BLOCK_SIZE; ++i)
+				out[blk][i] = (m[j] >> (8 * (7 - i))) & 0xFF;
+		}
+	}
+}
+
+void des_bs_rounds(BS_WORD state[64], const BS_WORD bs_key[][48], const int rounds)
+{
+	BS_WORD x[48], s[32], t;
+	BS_WORD *l = state, *r = state + 32, *tmp;
+	int idx, i;
+
+	for (idx = 0; idx < rounds; ++idx) {
+		// Expansion Permutation and Key XOR
+		for (i = 0; i < 48; ++i)
+			x[i] = r[des_expansion[i]] ^ bs_key[idx][i];
+		// S-Box Permutation
+		for (i = 0; i < 8; ++i)
+			bs_sbox(&x[6*i], sbox_truth[i], &s[4*i]);
+		// P-Box Permutation, XORed into the left half
+		for (i = 0; i < 32; ++i)
+			l[i] ^= s[des_pbox[i]];
+		// The final round doesn't switch sides
+		if (idx < rounds - 1) {
+			tmp = l;
+			l = r;
+			r = tmp;
+		}
+	}
+	// Move the halves back in place after an odd number of switches
+	if (l != state) {
+		for (i = 0; i < 32; ++i) {
+			t = state[i];
+			state[i] = state[i + 32];
+			state[i + 32] = t;
+		}
+	}
+}
+
+void des_bs_crypt(const BYTE in[][DES_BLOCK_SIZE], BYTE out[][DES_BLOCK_SIZE], const BS_WORD bs_key[][48], const int rounds, int number_of_blocks)
+{
+	BS_WORD state[64];
+
+	des_bs_load(in, state, number_of_blocks);
+	des_bs_rounds(state, bs_key, rounds);
+	des_bs_store(state, out, number_of_blocks);
+}
+
+void des_crypt_bitslice(const BYTE in[][DES_BLOCK_SIZE], BYTE out[][DES_BLOCK_SIZE], const BYTE key[][6], const int rounds, int number_of_blocks)
+{
+	BS_WORD bs_key[16][48];
+
+	des_bs_key_setup(key, bs_key, rounds);
+	des_bs_crypt(in, out, bs_key, rounds, number_of_blocks);
+}
@@ -0,0 +1,43 @@
+/*********************************************************************
+* Filename:   des_bitslice.h
+* Copyright:
+* Disclaimer: This code is presented "as is" without any guarantees.
+* Details:    Defines the API for the bitsliced, reduced-round DES
+              implementation. DES_BS_BLOCKS blocks are encrypted in
+              parallel per call, every block uses the same round
+              structure as des_crypt() (no IP/FP, no swap after the
+              last round).
+*********************************************************************/
+
+#ifndef DES_BITSLICE_H
+#define DES_BITSLICE_H
+
+/*************************** HEADER FILES ***************************/
+#include "des.h"
+
+/****************************** MACROS ******************************/
+#ifdef __AVX2__
+#define DES_BS_BLOCKS 256               // one 256-bit register holds one bit of 256 blocks
+#else
+#define DES_BS_BLOCKS 64                // one 64-bit word holds one bit of 64 blocks
+#endif
+#define DES_BS_WORDS (DES_BS_BLOCKS / 64)
+
+/**************************** DATA TYPES ****************************/
+#ifdef __AVX2__
+typedef QWORD BS_WORD __attribute__ ((vector_size (32)));
+#else
+typedef QWORD BS_WORD;
+#endif
+
+/*********************** FUNCTION DECLARATIONS **********************/
+// Spread a key schedule from des_key_setup() over all blocks of a batch
+void des_bs_key_setup(const BYTE key[][6], BS_WORD bs_key[][48], const int rounds);
+// Transpose blocks into/out of the bit-plane representation, missing blocks are zero
+void des_bs_load(const BYTE in[][DES_BLOCK_SIZE], BS_WORD state[64], int number_of_blocks);
+void des_bs_store(const BS_WORD state[64], BYTE out[][DES_BLOCK_SIZE], int number_of_blocks);
+void des_bs_rounds(BS_WORD state[64], const BS_WORD bs_key[][48], const int rounds);
+void des_bs_crypt(const BYTE in[][DES_BLOCK_SIZE], BYTE out[][DES_BLOCK_SIZE], const BS_WORD bs_key[][48], const int rounds, int number_of_blocks);
+void des_crypt_bitslice(const BYTE in[][DES_BLOCK_SIZE], BYTE out[][DES_BLOCK_SIZE], const BYTE key[][6], const int rounds, int number_of_blocks);
+
+#endif   // DES_BITSLICE_H
@@ -0,0 +1,181 @@
+/*********************************************************************
+* Filename:   des_dataset.c
+* Copyright:
+* Disclaimer: This code is presented "as is" without any guarantees.
+* Details:    Binary (P,C) data set files. dataset_create() sizes the
+              file, maps it writable and lets the threads generate and
+              encrypt chunks of pairs straight into the mapping.
+*********************************************************************/
+
+/*************************** HEADER FILES ***************************/
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "des_dataset.h"
+#include "des_parallel.h"
+#include "des_stats.h"
+#include "des_stream.h"
+#include "des_table.h"
+
+/**************************** DATA TYPES ****************************/
+typedef struct {
+	const BYTE (*key)[6];
+	const BYTE *seed;
+	int rounds;
+	BYTE (*plain)[DES_BLOCK_SIZE];
+	BYTE (*cipher)[DES_BLOCK_SIZE];
+	int number_of_pairs;
+} DATASET_JOB;
+
+_Static_assert(sizeof(DATASET_HEADER) == DATASET_HEADER_SIZE, "the header has to be DATASET_HEADER_SIZE bytes");
+
+/**************************** VARIABLES *****************************/
+static const BYTE key_seed[DES_BLOCK_SIZE] = {0x44,0x41,0x54,0x41,0x4B,0x45,0x59,0x53};
+
+/*********************** FUNCTION DEFINITIONS ***********************/
+void dataset_key(QWORD key_id, BYTE key[])
+{
+	BYTE block[1][DES_BLOCK_SIZE];
+
+	counter_plaintexts(key_seed, key_id, 1, block);
+	memcpy(key, block[0], DES_BLOCK_SIZE);
+}
+
+static size_t dataset_size(QWORD number_of_pairs)
+{
+	return DATASET_HEADER_SIZE + 2 * (size_t)number_of_pairs * DES_BLOCK_SIZE;
+}
+
+// Generates and encrypts the pairs of chunk "item" in place
+static int dataset_chunk(void *arg, int worker, QWORD item)
+{
+	DATASET_JOB *job = arg;
+	int start = (int)item * DATASET_CHUNK_SIZE;
+	int count = job->number_of_pairs - start;
+
+	if (count > DATASET_CHUNK_SIZE)
+		count = DATASET_CHUNK_SIZE;
+	counter_plaintexts(job->seed, start, count, &job->plain[start]);
+	return des_crypt_blocks((const BYTE (*)[DES_BLOCK_SIZE])&job->plain[start], &job->cipher[start], job->key, count, job->rounds);
+}
+
+int dataset_create(const char *filename, QWORD key_id, int rounds, const BYTE seed[], int number_of_pairs, int threads)
+{
+	DATASET_JOB job;
+	DATASET_HEADER *header;
+	BYTE key[DES_BLOCK_SIZE], schedule[16][6];
+	size_t size = dataset_size(number_of_pairs);
+	BYTE *map;
+	int fd, error, result = 0;
+
+	if (rounds < 1 || rounds > 16 || number_of_pairs < 0)
+		return -1;
+	fd = open(filename, O_RDWR | O_CREAT | O_TRUNC, 0644);
+	if (fd < 0)
+		return -1;
+	if (ftruncate(fd, size) != 0) {
+		close(fd);
+		return -1;
+	}
+	map = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	close(fd);
+	if (map == MAP_FAILED)
+		return -1;
+
+	header = (DATASET_HEADER *)map;
+	memset(header, 0, sizeof(DATASET_HEADER));
+	memcpy(header->magic, DATASET_MAGIC, sizeof(header->magic));
+	strcpy(header->cipher, "DES");
+	header->rounds = rounds;
+	header->key_id = key_id;
+	memcpy(header->seed, seed, DES_BLOCK_SIZE);
+	header->number_of_pairs = number_of_pairs;
+
+	dataset_key(key_id, key);
+	des_key_setup_table(key, schedule, DES_ENCRYPT, rounds);
+	job.key = (const BYTE (*)[6])schedule;
+	job.seed = seed;
+	job.rounds = rounds;
+	job.plain = (BYTE (*)[DES_BLOCK_SIZE])(map + DATASET_HEADER_SIZE);
+	job.cipher = job.plain + number_of_pairs;
+	job.number_of_pairs = number_of_pairs;
+	error = parallel_run(dataset_chunk, &job, (number_of_pairs + DATASET_CHUNK_SIZE - 1) / DATASET_CHUNK_SIZE, threads);
+
+	if (error != 0 || msync(map, size, MS_SYNC) != 0)
+		result = -1;
+	munmap(map, size);
+	return result;
+}
+
+int dataset_open(const char *filename, DES_DATASET *dataset)
+{
+	const DATASET_HEADER *header;
+	struct stat st;
+	void *map;
+	int fd;
+
+	memset(dataset, 0, sizeof(DES_DATASET));
+	fd = open(filename, O_RDONLY);
+	if (fd < 0)
+		return -1;
+	if (fstat(fd, &st) != 0 || st.st_size < DATASET_HEADER_SIZE) {
+		close(fd);
+		return -1;
+	}
+	map = mmap(NULL, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+	close(fd);
+	if (map == MAP_FAILED)
+		return -1;
+
+	header = map;
+	if (memcmp(header->magic, DATASET_MAGIC, sizeof(header->magic)) != 0 || strncmp(header->cipher, "DES", sizeof(header->cipher)) != 0
+	    || header->rounds < 1 || header->rounds > 16 || header->number_of_pairs > 0x7FFFFFFF
+	    || dataset_size(header->number_of_pairs) != (size_t)st.st_size) {
+		munmap(map, st.st_size);
+		return -1;
+	}
+	// the attacks read every text once, in order
+	madvise(map, st.st_size, MADV_SEQUENTIAL);
+
+	dataset->header = header;
+	dataset->plain = (const BYTE (*)[DES_BLOCK_SIZE])((const BYTE *)map + DATASET_HEADER_SIZE);
+	dataset->cipher = dataset->plain + header->number_of_pairs;
+	dataset->number_of_pairs = (int)header->number_of_pairs;
+	dataset->map = map;
+	dataset->size = st.st_size;
+	return 0;
+}
+
+void dataset_close(DES_DATASET *dataset)
+{
+	if (dataset->map != NULL)
+		munmap(dataset->map, dataset->size);
+	memset(dataset, 0, sizeof(DES_DATASET));
+}
+
+void algorithm1_dataset(const DES_DATASET *dataset, unsigned int* count_T0, unsigned int* count_T1, const BYTE keyguess[])
+{
+	if (count_left_side(dataset->plain, dataset->cipher, count_T0, count_T1, dataset->number_of_pairs, dataset->header->rounds, keyguess) != 0) {
+		*count_T0 = -1;
+		*count_T1 = -1;
+	}
+}
+
+int algorithm2_dataset(const DES_DATASET *dataset, BYTE key8bits[], unsigned int count_T0[], unsigned int count_T1[], int keyguesses)
+{
+	unsigned int counter[ALGORITHM2_COUNTER_SIZE];
+	int correct_keyguess;
+	STATS_TIMER(timer);
+
+	if (dataset->header->rounds != 8)
+		return -1;
+	STATS_BEGIN(timer);
+	memset(counter, 0, sizeof(counter));
+	compress_pairs(dataset->plain, dataset->cipher, counter, dataset->number_of_pairs);
+	evaluate_keyguesses(counter, count_T0, count_T1, keyguesses);
+	correct_keyguess = select_keyguess(key8bits, count_T0, count_T1, keyguesses);
+	STATS_END(STATS_ALGORITHM2, timer, 0, keyguesses, 0);
+	return correct_keyguess;
+}
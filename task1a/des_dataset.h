@@ -0,0 +1,59 @@
+/*********************************************************************
+* Filename:   des_dataset.h
+* Copyright:
+* Disclaimer: This code is presented "as is" without any guarantees.
+* Details:    Defines the API for the binary (P,C) data set files. A
+              file is a 64 byte header followed by all plaintexts and
+              then all ciphertexts, every text is a block in the byte
+              order of the BYTE[8] arrays (so a big-endian 64-bit
+              word). The file is mapped read-only, the attack
+              functions read the texts from the mapping without a copy.
+*********************************************************************/
+
+#ifndef DES_DATASET_H
+#define DES_DATASET_H
+
+/*************************** HEADER FILES ***************************/
+#include <stddef.h>
+#include "des.h"
+
+/****************************** MACROS ******************************/
+#define DATASET_MAGIC "DESPC01"         // with the terminating 0 the 8 magic bytes
+#define DATASET_HEADER_SIZE 64
+#define DATASET_CHUNK_SIZE 65536        // pairs per work item of dataset_create()
+
+/**************************** DATA TYPES ****************************/
+typedef struct {
+	char magic[8];
+	char cipher[8];                     // "DES", 0 padded
+	WORD rounds;
+	WORD reserved;
+	QWORD key_id;                       // the key is dataset_key(key_id)
+	BYTE seed[DES_BLOCK_SIZE];          // plaintext i is counter_plaintexts() index i of this seed
+	QWORD number_of_pairs;
+	BYTE padding[DATASET_HEADER_SIZE - 48];
+} DATASET_HEADER;
+
+typedef struct {
+	const DATASET_HEADER *header;
+	const BYTE (*plain)[DES_BLOCK_SIZE];
+	const BYTE (*cipher)[DES_BLOCK_SIZE];
+	int number_of_pairs;
+	void *map;
+	size_t size;
+} DES_DATASET;
+
+/*********************** FUNCTION DECLARATIONS **********************/
+// The key with the number key_id of all data set keys
+void dataset_key(QWORD key_id, BYTE key[]);
+// Writes the pairs 0 .. number_of_pairs-1 of the seed, encrypted under dataset_key(key_id)
+int dataset_create(const char *filename, QWORD key_id, int rounds, const BYTE seed[], int number_of_pairs, int threads);
+// Maps a data set file, returns -1 if it cannot be read or is no valid data set
+int dataset_open(const char *filename, DES_DATASET *dataset);
+void dataset_close(DES_DATASET *dataset);
+
+// algorithm1(), algorithm2_cached() on the pairs of a data set instead of encrypting plaintexts
+void algorithm1_dataset(const DES_DATASET *dataset, unsigned int* count_T0, unsigned int* count_T1, const BYTE keyguess[]);
+int algorithm2_dataset(const DES_DATASET *dataset, BYTE key8bits[], unsigned int count_T0[], unsigned int count_T1[], int keyguesses);
+
+#endif   // DES_DATASET_H
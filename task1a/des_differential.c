@@ -0,0 +1,307 @@
+/*********************************************************************
+* Filename:   des_differential.c
+* Copyright:
+* Disclaimer: This code is presented "as is" without any guarantees.
+* Details:    Differential attack on the reduced-round DES. After the
+              rounds of the characteristic (L', R') is known, every
+              further round only keeps the bits of F' that come from
+              S-Boxes with a known zero input difference. With the
+              ciphertext C = (R_r, R_r-1) the output difference of the
+              last round F is C_high' ^ L_r-1', so an S-Box of the last
+              round is a target if all its output bits are known. The
+              pairs are split into chunks that the threads of
+              parallel_run() take from a shared counter, every thread
+              counts into its own counters.
+*********************************************************************/
+
+/*************************** HEADER FILES ***************************/
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include "des_differential.h"
+#include "des_linear.h"
+#include "des_parallel.h"
+#include "des_stream.h"
+#include "des_table.h"
+
+/****************************** MACROS ******************************/
+// The 6 expanded bits of "a" that enter S-Box j (0..7): bits 4j-1 .. 4j+4 from the left
+#define EXPANDED(a,j) ((((a) << ((4 * (j) + 31) & 31)) | ((a) >> ((33 - 4 * (j)) & 31))) >> 26 & 0x3F)
+
+/**************************** DATA TYPES ****************************/
+typedef struct {
+	const BYTE *seed;
+	const BYTE (*key)[6];
+	DES_CRYPT_BLOCKS_FUNC crypt;
+	QWORD plain_diff;
+	WORD low_diff, low_mask;            // R_r-1' on the known bits, the ciphertext difference must match
+	WORD high_diff;                     // L_r-1' on the known bits
+	int number_of_sboxes;
+	BYTE sboxes[8];
+	int number_of_pairs;
+	int number_of_chunks;
+	size_t counters_size;               // bytes per worker, a multiple of the cache line
+	BYTE *counters;                     // one DIFFERENTIAL_COUNTERS per worker
+} DIFFERENTIAL_JOB;
+
+/**************************** VARIABLES *****************************/
+static const DIFFERENTIAL_CHARACTERISTIC characteristic_4 = {
+	// 1 round, probability 1
+	1, 0x2000000000000000ULL, {0x00000000}
+};
+static const DIFFERENTIAL_CHARACTERISTIC characteristic_6 = {
+	// 3 rounds, probability 1/16
+	3, 0x4008000004000000ULL, {0x40080000, 0x00000000, 0x40080000}
+};
+static const DIFFERENTIAL_CHARACTERISTIC characteristic_8 = {
+	// 5 rounds, probability about 1/10486
+	5, 0x405C000004000000ULL, {0x40080000, 0x04000000, 0x00000000, 0x04000000, 0x40080000}
+};
+
+static pthread_once_t tables_once = PTHREAD_ONCE_INIT;
+static BYTE ddt[8][64][16];
+static QWORD solutions[8][64][16];      // bit x is set if S(x) ^ S(x ^ in) = out
+static WORD pbox_inverse[4][256];       // P^-1 of every byte of F'
+
+/*********************** FUNCTION DEFINITIONS ***********************/
+static void build_tables(void)
+{
+	int j, x, in;
+	BYTE out;
+
+	for (j = 0; j < 4; ++j) {
+		for (x = 0; x < 256; ++x)
+			pbox_inverse[j][x] = linear_pbox_inverse_mask((WORD)x << (24 - 8 * j));
+	}
+	for (j = 0; j < 8; ++j) {
+		for (in = 0; in < 64; ++in) {
+			for (x = 0; x < 64; ++x) {
+				out = des_sbox(j + 1, x) ^ des_sbox(j + 1, x ^ in);
+				++ddt[j][in][out];
+				solutions[j][in][out] |= 1ULL << x;
+			}
+		}
+	}
+}
+
+int sbox_ddt(int s, BYTE in, BYTE out)
+{
+	pthread_once(&tables_once, build_tables);
+	return ddt[s - 1][in & 0x3F][out & 0x0F];
+}
+
+QWORD expansion_difference(WORD x)
+{
+	QWORD e = 0;
+	int j;
+
+	for (j = 0; j < 8; ++j)
+		e |= (QWORD)EXPANDED(x, j) << (42 - 6 * j);
+	return e;
+}
+
+double characteristic_probability(const DIFFERENTIAL_CHARACTERISTIC *ch)
+{
+	WORD l = ch->plain_diff >> 32, r = (WORD)ch->plain_diff, t, b;
+	double p = 1.0;
+	int i, j;
+
+	for (i = 0; i < ch->rounds; ++i) {
+		b = linear_pbox_inverse_mask(ch->fout_diff[i]);
+		for (j = 0; j < 8; ++j)
+			p *= sbox_ddt(j + 1, EXPANDED(r, j), b >> (28 - 4 * j)) / 64.0;
+		t = l ^ ch->fout_diff[i];
+		l = r;
+		r = t;
+	}
+	return p;
+}
+
+QWORD characteristic_output(const DIFFERENTIAL_CHARACTERISTIC *ch)
+{
+	WORD l = ch->plain_diff >> 32, r = (WORD)ch->plain_diff, t;
+	int i;
+
+	for (i = 0; i < ch->rounds; ++i) {
+		t = l ^ ch->fout_diff[i];
+		l = r;
+		r = t;
+	}
+	return ((QWORD)l << 32) | r;
+}
+
+const DIFFERENTIAL_CHARACTERISTIC *builtin_characteristic(int rounds)
+{
+	switch (rounds) {
+	case 4:
+		return &characteristic_4;
+	case 6:
+		return &characteristic_6;
+	case 8:
+		return &characteristic_8;
+	default:
+		return NULL;
+	}
+}
+
+// The known differences before the last round and the target S-Boxes
+static int attack_plan(const DIFFERENTIAL_CHARACTERISTIC *ch, int rounds, DIFFERENTIAL_JOB *job)
+{
+	QWORD out = characteristic_output(ch);
+	WORD l = out >> 32, r = (WORD)out, ml = 0xFFFFFFFF, mr = 0xFFFFFFFF, known, t, tm, b;
+	int extra = rounds - ch->rounds, i, j;
+
+	if (ch->rounds < 1 || ch->rounds > DIFFERENTIAL_MAX_ROUNDS || extra < 1 || extra > 3)
+		return -1;
+	for (i = 1; i < extra; ++i) {
+		// F' is known (zero) only behind S-Boxes with a known zero input difference
+		for (j = 0, known = 0; j < 8; ++j) {
+			if (EXPANDED(mr, j) == 0x3F && EXPANDED(r, j) == 0)
+				known |= 0x0Fu << (28 - 4 * j);
+		}
+		t = l;
+		tm = ml & linear_pbox_mask(known);
+		l = r;
+		ml = mr;
+		r = t;
+		mr = tm;
+	}
+	job->low_diff = r & mr;
+	job->low_mask = mr;
+	job->high_diff = l & ml;
+
+	b = linear_pbox_inverse_mask(ml);
+	for (j = 0, job->number_of_sboxes = 0; j < 8; ++j) {
+		if (((b >> (28 - 4 * j)) & 0x0F) == 0x0F)
+			job->sboxes[job->number_of_sboxes++] = j + 1;
+	}
+	return job->number_of_sboxes > 0 ? 0 : -1;
+}
+
+static void count_pairs(const DIFFERENTIAL_JOB *job, const BYTE cipher0[][DES_BLOCK_SIZE], const BYTE cipher1[][DES_BLOCK_SIZE],
+                        int number_of_pairs, DIFFERENTIAL_COUNTERS *counters)
+{
+	BYTE in[8], out[8];
+	QWORD c0, c1, set;
+	WORD low, diff, y, b;
+	int i, t, j, x;
+
+	for (i = 0; i < number_of_pairs; ++i) {
+		for (j = 0, c0 = 0, c1 = 0; j < DES_BLOCK_SIZE; ++j) {
+			c0 = (c0 << 8) | cipher0[i][j];
+			c1 = (c1 << 8) | cipher1[i][j];
+		}
+		diff = (WORD)(c0 ^ c1);
+		if ((diff ^ job->low_diff) & job->low_mask)
+			continue;
+		y = (WORD)((c0 ^ c1) >> 32) ^ job->high_diff;
+		b = pbox_inverse[0][y >> 24] | pbox_inverse[1][(y >> 16) & 0xFF] | pbox_inverse[2][(y >> 8) & 0xFF] | pbox_inverse[3][y & 0xFF];
+
+		// a right pair has a possible output difference in every target S-Box
+		for (t = 0; t < job->number_of_sboxes; ++t) {
+			j = job->sboxes[t] - 1;
+			in[t] = EXPANDED(diff, j);
+			out[t] = (b >> (28 - 4 * j)) & 0x0F;
+			if (ddt[j][in[t]][out[t]] == 0)
+				break;
+		}
+		if (t < job->number_of_sboxes)
+			continue;
+
+		++counters->right_pairs;
+		low = (WORD)c0;
+		for (t = 0; t < job->number_of_sboxes; ++t) {
+			// without an input difference every guess is suggested, which adds nothing
+			if (in[t] == 0)
+				continue;
+			j = job->sboxes[t] - 1;
+			for (set = solutions[j][in[t]][out[t]]; set != 0; set &= set - 1) {
+				x = __builtin_ctzll(set);
+				++counters->count[t][x ^ EXPANDED(low, j)];
+			}
+		}
+	}
+}
+
+// Encrypts and counts the pairs of chunk "item"
+static int differential_chunk(void *arg, int worker, QWORD item)
+{
+	DIFFERENTIAL_JOB *job = arg;
+	DIFFERENTIAL_COUNTERS *counters = (DIFFERENTIAL_COUNTERS *)(job->counters + worker * job->counters_size);
+	BYTE plain0[DIFFERENTIAL_CHUNK_SIZE][DES_BLOCK_SIZE], plain1[DIFFERENTIAL_CHUNK_SIZE][DES_BLOCK_SIZE];
+	BYTE cipher0[DIFFERENTIAL_CHUNK_SIZE][DES_BLOCK_SIZE], cipher1[DIFFERENTIAL_CHUNK_SIZE][DES_BLOCK_SIZE];
+	int start, count, i, k;
+
+	start = (int)item * DIFFERENTIAL_CHUNK_SIZE;
+	count = job->number_of_pairs - start;
+	if (count > DIFFERENTIAL_CHUNK_SIZE)
+		count = DIFFERENTIAL_CHUNK_SIZE;
+
+	counter_plaintexts(job->seed, start, count, plain0);
+	for (i = 0; i < count; ++i) {
+		for (k = 0; k < DES_BLOCK_SIZE; ++k)
+			plain1[i][k] = plain0[i][k] ^ ((job->plain_diff >> (8 * (7 - k))) & 0xFF);
+	}
+	job->crypt((const BYTE (*)[DES_BLOCK_SIZE])plain0, cipher0, job->key, count);
+	job->crypt((const BYTE (*)[DES_BLOCK_SIZE])plain1, cipher1, job->key, count);
+	count_pairs(job, (const BYTE (*)[DES_BLOCK_SIZE])cipher0, (const BYTE (*)[DES_BLOCK_SIZE])cipher1, count, counters);
+	counters->pairs += count;
+	return 0;
+}
+
+int differential_attack(const BYTE seed[], const BYTE key[][6], int rounds, const DIFFERENTIAL_CHARACTERISTIC *ch,
+                        int number_of_pairs, int threads, DIFFERENTIAL_COUNTERS *counters)
+{
+	DIFFERENTIAL_JOB job;
+	DIFFERENTIAL_COUNTERS *worker;
+	int i, t, g;
+
+	memset(counters, 0, sizeof(DIFFERENTIAL_COUNTERS));
+	job.crypt = des_crypt_blocks_select(rounds);
+	if (ch == NULL || job.crypt == NULL || attack_plan(ch, rounds, &job) != 0)
+		return -1;
+	pthread_once(&tables_once, build_tables);
+	counters->number_of_sboxes = job.number_of_sboxes;
+	memcpy(counters->sboxes, job.sboxes, sizeof(job.sboxes));
+
+	job.seed = seed;
+	job.key = key;
+	job.plain_diff = ch->plain_diff;
+	job.number_of_pairs = number_of_pairs;
+	job.number_of_chunks = (number_of_pairs + DIFFERENTIAL_CHUNK_SIZE - 1) / DIFFERENTIAL_CHUNK_SIZE;
+	job.counters_size = (sizeof(DIFFERENTIAL_COUNTERS) + CACHE_LINE_SIZE - 1) & ~(size_t)(CACHE_LINE_SIZE - 1);
+	threads = parallel_threads(threads);
+	job.counters = aligned_alloc(CACHE_LINE_SIZE, threads * job.counters_size);
+	if (job.counters == NULL)
+		return -1;
+	memset(job.counters, 0, threads * job.counters_size);
+
+	parallel_run(differential_chunk, &job, job.number_of_chunks, threads);
+
+	for (i = 0; i < threads; ++i) {
+		worker = (DIFFERENTIAL_COUNTERS *)(job.counters + i * job.counters_size);
+		counters->pairs += worker->pairs;
+		counters->right_pairs += worker->right_pairs;
+		for (t = 0; t < job.number_of_sboxes; ++t) {
+			for (g = 0; g < 64; ++g)
+				counters->count[t][g] += worker->count[t][g];
+		}
+	}
+	free(job.counters);
+	return 0;
+}
+
+void differential_keyguess(const DIFFERENTIAL_COUNTERS *counters, int index, BYTE guesses[])
+{
+	const unsigned int *count = counters->count[index];
+	int i, j;
+	BYTE g;
+
+	// insertion sort, the most counted guess first and equal counts in guess order
+	for (i = 0; i < 64; ++i) {
+		g = i;
+		for (j = i; j > 0 && count[guesses[j - 1]] < count[g]; --j)
+			guesses[j] = guesses[j - 1];
+		guesses[j] = g;
+	}
+}
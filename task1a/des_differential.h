@@ -0,0 +1,61 @@
+/*********************************************************************
+* Filename:   des_differential.h
+* Copyright:
+* Disclaimer: This code is presented "as is" without any guarantees.
+* Details:    Defines the API for the differential attack (Biham and
+              Shamir) on the reduced-round DES. Chosen plaintext pairs
+              with the input difference of a characteristic are
+              encrypted, pairs whose ciphertext difference cannot come
+              from a right pair are dropped and every remaining pair
+              counts the last round subkey bits it suggests for the
+              S-Boxes whose output difference is known. Differences
+              are 64-bit words like the blocks in des_linear.h (L in
+              bits 63..32).
+*********************************************************************/
+
+#ifndef DES_DIFFERENTIAL_H
+#define DES_DIFFERENTIAL_H
+
+/*************************** HEADER FILES ***************************/
+#include "des.h"
+
+/****************************** MACROS ******************************/
+#define DIFFERENTIAL_MAX_ROUNDS 15
+#define DIFFERENTIAL_CHUNK_SIZE 1024    // pairs per work item
+
+/**************************** DATA TYPES ****************************/
+typedef struct {
+	int rounds;                         // rounds covered, the attack adds 1 to 3 more
+	QWORD plain_diff;
+	WORD fout_diff[DIFFERENTIAL_MAX_ROUNDS];   // F output difference of round 1 .. rounds
+} DIFFERENTIAL_CHARACTERISTIC;
+
+typedef struct {
+	QWORD pairs;                        // pairs encrypted
+	QWORD right_pairs;                  // pairs that passed the filter
+	int number_of_sboxes;
+	BYTE sboxes[8];                     // last round S-Boxes (1..8) with a known output difference
+	unsigned int count[8][64];          // [target S-Box][key guess]
+} DIFFERENTIAL_COUNTERS;
+
+/*********************** FUNCTION DECLARATIONS **********************/
+// Number of inputs x of S-Box "s" (1..8) with S(x) ^ S(x ^ in) = out
+int sbox_ddt(int s, BYTE in, BYTE out);
+// The 48 expanded bits of a difference of R (leftmost expanded bit in bit 47)
+QWORD expansion_difference(WORD x);
+// Product of the S-Box probabilities of all rounds, 0 if the characteristic is impossible
+double characteristic_probability(const DIFFERENTIAL_CHARACTERISTIC *ch);
+// The difference after the rounds of the characteristic
+QWORD characteristic_output(const DIFFERENTIAL_CHARACTERISTIC *ch);
+// The characteristic the attack on 4, 6 and 8 rounds uses, NULL otherwise
+const DIFFERENTIAL_CHARACTERISTIC *builtin_characteristic(int rounds);
+// Encrypts the pairs 0 .. number_of_pairs-1 of the data set "seed" (the first plaintext of
+// pair i is plaintext i of counter_plaintexts()) with the key schedule and counts the
+// last round subkey guesses. Returns -1 if "rounds" is not 1 to 3 rounds more than the
+// characteristic covers or no S-Box of the last round has a known output difference.
+int differential_attack(const BYTE seed[], const BYTE key[][6], int rounds, const DIFFERENTIAL_CHARACTERISTIC *ch,
+                        int number_of_pairs, int threads, DIFFERENTIAL_COUNTERS *counters);
+// The 64 guesses for target S-Box "index" of the counters, most counted first
+void differential_keyguess(const DIFFERENTIAL_COUNTERS *counters, int index, BYTE guesses[]);
+
+#endif   // DES_DIFFERENTIAL_H
@@ -0,0 +1,242 @@
+/*********************************************************************
+* Filename:   des_keyguess.c
+* Copyright:
+* Disclaimer: This code is presented "as is" without any guarantees.
+* Details:    Last round key guessing with a fast Walsh-Hadamard
+              transform. For a guess k the experimental T0 - T1 is the
+              XOR-convolution c(k) = sum_x h(x) * (-1)^g(x ^ k) of the
+              signed histogram h with the sign of the last round term
+              g, so all guesses are scored in O(m * 2^m) instead of
+              O(2^m * 2^m) for m guessed key bits.
+*********************************************************************/
+
+/*************************** HEADER FILES ***************************/
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "des_keyguess.h"
+#include "des_table.h"
+
+/****************************** MACROS ******************************/
+// The 6 expanded bits of the right half "a" that enter S-Box "s" (1..8)
+#define SBOX_INPUT(a,s) ((((a) << ((4*(s)+27) & 31)) | ((a) >> ((37-4*(s)) & 31))) >> 26)
+
+/*********************** FUNCTION DEFINITIONS ***********************/
+void fwht(long long data[], int bits)
+{
+	long long a, b;
+	int len, i, j;
+
+	for (len = 1; len < (1 << bits); len <<= 1) {
+		for (i = 0; i < (1 << bits); i += 2 * len) {
+			for (j = i; j < i + len; ++j) {
+				a = data[j];
+				b = data[j + len];
+				data[j] = a + b;
+				data[j + len] = a - b;
+			}
+		}
+	}
+}
+
+// Places the 6 bit S-Box input "x" at the key bits of S-Box "s"
+static void set_sbox_key(BYTE key[], int s, WORD x)
+{
+	int b, bit;
+
+	for (b = 0; b < 6; ++b) {
+		bit = 6 * (s - 1) + b;
+		key[bit/8] |= ((x >> (5 - b)) & 0x01) << (7 - (bit%8));
+	}
+}
+
+// F(R,K) bits for the S-Box input "x" of S-Box "s": with R = 0 the S-Box input is the key
+static WORD sbox_fbits(int s, WORD x)
+{
+	BYTE key[6] = {0x00,0x00,0x00,0x00,0x00,0x00};
+
+	set_sbox_key(key, s, x);
+	return f(0, key);
+}
+
+int lastround_histogram(const BYTE plain[][DES_BLOCK_SIZE], const BYTE keyschedule[][6], long long histogram[], int number_of_plains, int rounds, const BYTE sboxes[], int number_of_sboxes)
+{
+	BYTE cipher[DES_TABLE_BATCH][DES_BLOCK_SIZE];
+	DES_CRYPT_BLOCKS_FUNC crypt = des_crypt_blocks_select(rounds);
+	BYTE parity;
+	WORD c[2], x;
+	int i, j, s, batch;
+
+	if (number_of_sboxes < 1 || number_of_sboxes > KEYGUESS_MAX_SBOXES || crypt == NULL)
+		return -1;
+	memset(histogram, 0, sizeof(long long) << (6 * number_of_sboxes));
+
+	for (i = 0; i < number_of_plains; i += DES_TABLE_BATCH) {
+		batch = number_of_plains - i;
+		if (batch > DES_TABLE_BATCH)
+			batch = DES_TABLE_BATCH;
+		crypt(&plain[i], cipher, keyschedule, batch);
+
+		for (j = 0; j < batch; ++j) {
+			parity = compute_left_side(plain[i+j], cipher[j], rounds, 0);
+			if (parity == 0xFF)
+				return -1;
+			Initial_Breakup(c, cipher[j]);
+			for (s = 0, x = 0; s < number_of_sboxes; ++s)
+				x = (x << 6) | (SBOX_INPUT(c[1], sboxes[s]) & 0x3F);
+			histogram[x] += parity ? -1 : 1;
+		}
+	}
+	return 0;
+}
+
+static int compare_candidates(const void *a, const void *b)
+{
+	const KEY_CANDIDATE *ca = a, *cb = b;
+	double da = ca->bias < 0 ? -ca->bias : ca->bias;
+	double db = cb->bias < 0 ? -cb->bias : cb->bias;
+
+	if (da != db)
+		return da < db ? 1 : -1;
+	return ca->guess < cb->guess ? -1 : (ca->guess > cb->guess);
+}
+
+// c(k) = T0 - T1 of every guess k for the F(R,K) bits in fmask
+static int fwht_correlation(const long long histogram[], WORD fmask, const BYTE sboxes[], int number_of_sboxes, long long correlation[])
+{
+	int bits = 6 * number_of_sboxes;
+	WORD size = 1 << bits;
+	WORD sbox_mask[KEYGUESS_MAX_SBOXES];
+	BYTE g[KEYGUESS_MAX_SBOXES][64];
+	long long *sign;
+	WORD k, x, y;
+	int s;
+
+	if (number_of_sboxes < 1 || number_of_sboxes > KEYGUESS_MAX_SBOXES)
+		return -1;
+
+	// g_s(x): parity of the masked F bits coming from S-Box s. The bits an S-Box
+	// drives are exactly the ones that change with its input.
+	for (s = 0; s < number_of_sboxes; ++s) {
+		for (x = 0, sbox_mask[s] = 0; x < 64; ++x)
+			sbox_mask[s] |= sbox_fbits(sboxes[s], x) ^ sbox_fbits(sboxes[s], 0);
+		for (x = 0; x < 64; ++x)
+			g[s][x] = __builtin_parity(sbox_fbits(sboxes[s], x) & sbox_mask[s] & fmask);
+	}
+
+	sign = malloc(size * sizeof(long long));
+	if (sign == NULL)
+		return -1;
+	memcpy(correlation, histogram, size * sizeof(long long));
+	for (y = 0; y < size; ++y) {
+		BYTE parity = 0;
+		for (s = 0; s < number_of_sboxes; ++s)
+			parity ^= g[s][(y >> (6 * (number_of_sboxes - 1 - s))) & 0x3F];
+		sign[y] = parity ? -1 : 1;
+	}
+
+	// c = W(W(h) * W(sign)) / 2^bits
+	fwht(correlation, bits);
+	fwht(sign, bits);
+	for (k = 0; k < size; ++k)
+		correlation[k] *= sign[k];
+	fwht(correlation, bits);
+	for (k = 0; k < size; ++k)
+		correlation[k] /= (long long)size;
+
+	free(sign);
+	return 0;
+}
+
+int fwht_keyguess(const long long histogram[], WORD fmask, const BYTE sboxes[], int number_of_sboxes, int number_of_plains, KEY_CANDIDATE candidates[])
+{
+	WORD size = 1 << (6 * number_of_sboxes);
+	long long *c;
+	WORD k;
+
+	if (number_of_sboxes < 1 || number_of_sboxes > KEYGUESS_MAX_SBOXES)
+		return -1;
+	c = malloc(size * sizeof(long long));
+	if (c == NULL || fwht_correlation(histogram, fmask, sboxes, number_of_sboxes, c) != 0) {
+		free(c);
+		return -1;
+	}
+
+	for (k = 0; k < size; ++k) {
+		candidates[k].guess = k;
+		candidates[k].bias = (double)c[k] / (2.0 * number_of_plains);
+	}
+	rank_candidates(candidates, size);
+
+	free(c);
+	return 0;
+}
+
+void rank_candidates(KEY_CANDIDATE candidates[], int number_of_candidates)
+{
+	qsort(candidates, number_of_candidates, sizeof(KEY_CANDIDATE), compare_candidates);
+}
+
+int add_histograms(const BYTE plain[][DES_BLOCK_SIZE], const BYTE cipher[][DES_BLOCK_SIZE], int number_of_plains, const LINEAR_APPROXIMATION approx[], int number_of_approx,
+                   const BYTE sboxes[], int number_of_sboxes, long long histograms[])
+{
+	QWORD p, c;
+	WORD x;
+	int i, a, s;
+
+	if (number_of_sboxes < 1 || number_of_sboxes > KEYGUESS_MAX_SBOXES)
+		return -1;
+
+	for (i = 0; i < number_of_plains; ++i) {
+		p = block_to_qword(plain[i]);
+		c = block_to_qword(cipher[i]);
+		for (s = 0, x = 0; s < number_of_sboxes; ++s)
+			x = (x << 6) | (SBOX_INPUT((WORD)c, sboxes[s]) & 0x3F);
+		for (a = 0; a < number_of_approx; ++a)
+			histograms[((long long)a << (6 * number_of_sboxes)) + x] += approximation_left_side(&approx[a], p, c, 0) ? -1 : 1;
+	}
+	return 0;
+}
+
+int multiple_keyguess(const long long histograms[], const LINEAR_APPROXIMATION approx[], const double weight[], int number_of_approx,
+                      const BYTE sboxes[], int number_of_sboxes, int number_of_plains, KEY_CANDIDATE candidates[])
+{
+	WORD size = 1 << (6 * number_of_sboxes);
+	double *score, total = 0;
+	long long *c;
+	WORD k;
+	int a;
+
+	if (number_of_sboxes < 1 || number_of_sboxes > KEYGUESS_MAX_SBOXES || number_of_approx < 1)
+		return -1;
+	c = malloc(size * sizeof(long long));
+	score = calloc(size, sizeof(double));
+	if (c == NULL || score == NULL) {
+		free(c);
+		free(score);
+		return -1;
+	}
+
+	// the right side of every approximation is unknown, so each one adds |T0 - T1|
+	// weighted with its expected bias (Biryukov, De Canniere, Quisquater)
+	for (a = 0; a < number_of_approx; ++a) {
+		if (fwht_correlation(&histograms[(long long)a * size], approx[a].fmask, sboxes, number_of_sboxes, c) != 0) {
+			free(c);
+			free(score);
+			return -1;
+		}
+		for (k = 0; k < size; ++k)
+			score[k] += fabs(weight[a]) * llabs(c[k]);
+		total += fabs(weight[a]);
+	}
+
+	for (k = 0; k < size; ++k) {
+		candidates[k].guess = k;
+		candidates[k].bias = score[k] / total / (2.0 * number_of_plains);
+	}
+	rank_candidates(candidates, size);
+
+	free(c);
+	free(score);
+	return 0;
+}
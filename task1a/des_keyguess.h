@@ -0,0 +1,47 @@
+/*********************************************************************
+* Filename:   des_keyguess.h
+* Copyright:
+* Disclaimer: This code is presented "as is" without any guarantees.
+* Details:    Defines the API for the last round key guessing engine.
+              All subkey guesses for up to three S-Boxes of the last
+              round are scored at once with a fast Walsh-Hadamard
+              transform (Collard, Standaert, Quisquater).
+*********************************************************************/
+
+#ifndef DES_KEYGUESS_H
+#define DES_KEYGUESS_H
+
+/*************************** HEADER FILES ***************************/
+#include "des.h"
+#include "des_linear.h"
+
+/****************************** MACROS ******************************/
+#define KEYGUESS_MAX_SBOXES 3           // 18 guessed key bits
+#define KEYGUESS_MAX_APPROX 16          // approximations combined by multiple_keyguess()
+
+/**************************** DATA TYPES ****************************/
+typedef struct {
+	WORD guess;                         // 6 key bits per targeted S-Box, first S-Box in the highest bits
+	double bias;                        // (T0 - T1) / (2 * number of texts)
+} KEY_CANDIDATE;
+
+/*********************** FUNCTION DECLARATIONS **********************/
+void fwht(long long data[], int bits);
+// Signed histogram over the bits entering the targeted S-Boxes of the last round,
+// every text adds (-1)^(left side of the approximation without the F term)
+int lastround_histogram(const BYTE plain[][DES_BLOCK_SIZE], const BYTE keyschedule[][6], long long histogram[], int number_of_plains, int rounds, const BYTE sboxes[], int number_of_sboxes);
+// Scores all 2^(6*number_of_sboxes) guesses for the F(R,K) bits in fmask and ranks them by |bias|
+int fwht_keyguess(const long long histogram[], WORD fmask, const BYTE sboxes[], int number_of_sboxes, int number_of_plains, KEY_CANDIDATE candidates[]);
+// Sorts the candidates by |bias|, ties by guess
+void rank_candidates(KEY_CANDIDATE candidates[], int number_of_candidates);
+
+// Multiple linear cryptanalysis: one histogram per approximation (2^(6*number_of_sboxes) entries each)
+// is filled in a single pass over the (P,C) pairs, the histograms are not cleared
+int add_histograms(const BYTE plain[][DES_BLOCK_SIZE], const BYTE cipher[][DES_BLOCK_SIZE], int number_of_plains, const LINEAR_APPROXIMATION approx[], int number_of_approx,
+                   const BYTE sboxes[], int number_of_sboxes, long long histograms[]);
+// Ranks the guesses by the combined statistic of all approximations, weight[a] is the expected bias of
+// approximation a (up to a common factor). The bias of a candidate is the weighted mean of the |biases|.
+int multiple_keyguess(const long long histograms[], const LINEAR_APPROXIMATION approx[], const double weight[], int number_of_approx,
+                      const BYTE sboxes[], int number_of_sboxes, int number_of_plains, KEY_CANDIDATE candidates[]);
+
+#endif   // DES_KEYGUESS_H
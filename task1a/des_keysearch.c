@@ -0,0 +1,372 @@
+/*********************************************************************
+* Filename:   des_keysearch.c
+* Copyright:
+* Disclaimer: This code is presented "as is" without any guarantees.
+* Details:    Key recovery stage after the linear attacks. The known
+              parities of key bits are brought into reduced row echelon
+              form, every key bit that is not a pivot of an equation is
+              enumerated. The lowest free bits are spread over the
+              bitslice lanes, so one des_bs_rounds() call tests
+              DES_BS_BLOCKS keys against a known pair. A batch is given
+              up as soon as no lane matches a pair.
+*********************************************************************/
+
+/*************************** HEADER FILES ***************************/
+#include <string.h>
+#include <time.h>
+#include <pthread.h>
+#include "des_keysearch.h"
+#include "des_bitslice.h"
+#include "des_parallel.h"
+
+/****************************** MACROS ******************************/
+#define KEYBIT(b) (1ULL << (63 - (b)))  // master key bit "b" from the left
+
+/**************************** DATA TYPES ****************************/
+typedef struct {
+	const BYTE (*plain)[DES_BLOCK_SIZE];
+	const BYTE (*cipher)[DES_BLOCK_SIZE];
+	int number_of_pairs;
+	int rounds;
+	BYTE map[16][48];
+	int number_of_free;
+	int free_bit[64];                   // key bits that are enumerated, the lowest ones over the lanes
+	int number_of_pivots;
+	int pivot_bit[64];                  // key bits given by an equation over free bits
+	QWORD pivot_mask[64];
+	BYTE pivot_value[64];
+	int lane_bits;
+	QWORD number_of_batches;
+	QWORD lanes;                        // lanes that hold a key of their own
+	BS_WORD valid;                      // one bit for each of them
+	BS_WORD lane_plane[64];
+	int found;                          // shared, stops all workers
+	QWORD key;
+	pthread_mutex_t lock;
+	struct KEY_SEARCH_WORKER *worker;
+} KEY_SEARCH_JOB;
+
+typedef struct KEY_SEARCH_WORKER {
+	QWORD keys_tested;
+} __attribute__ ((aligned (CACHE_LINE_SIZE))) KEY_SEARCH_WORKER;
+
+/**************************** VARIABLES *****************************/
+static const BS_WORD bs_zero;
+
+/*********************** FUNCTION DEFINITIONS ***********************/
+void key_bit_map(BYTE map[][48], int rounds)
+{
+	BYTE key[DES_BLOCK_SIZE];
+	BYTE schedule[16][6];
+	int b, r, i;
+
+	// PC-1, the rotations and PC-2 only move bits, so every key bit is traced on its own
+	for (b = 0; b < 64; ++b) {
+		if (!(KEYSEARCH_KEY_BITS & KEYBIT(b)))
+			continue;
+		memset(key, 0, sizeof(key));
+		key[b / 8] = 0x80 >> (b % 8);
+		des_key_setup(key, schedule, DES_ENCRYPT, rounds);
+		for (r = 0; r < rounds; ++r) {
+			for (i = 0; i < 48; ++i) {
+				if ((schedule[r][i / 8] >> (7 - (i % 8))) & 0x01)
+					map[r][i] = b;
+			}
+		}
+	}
+}
+
+QWORD subkey_key_mask(int round, QWORD subkey_mask)
+{
+	BYTE map[16][48];
+	QWORD mask = 0;
+	int i;
+
+	key_bit_map(map, round);
+	for (i = 0; i < 48; ++i) {
+		if ((subkey_mask >> (47 - i)) & 0x01)
+			mask ^= KEYBIT(map[round - 1][i]);
+	}
+	return mask;
+}
+
+KEY_EQUATION approximation_key_equation(const LINEAR_APPROXIMATION *approx, BYTE right_side)
+{
+	KEY_EQUATION equation;
+	int r;
+
+	// a key bit that enters the right side twice cancels out
+	equation.mask = 0;
+	for (r = 0; r < approx->rounds; ++r)
+		equation.mask ^= subkey_key_mask(r + 1, approx->key_mask[r]);
+	equation.value = right_side & 0x01;
+	return equation;
+}
+
+// Reduced row echelon form of the equations, splits the key bits into pivots and free bits
+static int eliminate(KEY_SEARCH_JOB *job, const KEY_EQUATION equations[], int number_of_equations)
+{
+	QWORD mask[KEYSEARCH_MAX_EQUATIONS], pivots = 0;
+	BYTE value[KEYSEARCH_MAX_EQUATIONS];
+	int n = 0, e, i, b;
+
+	if (number_of_equations > KEYSEARCH_MAX_EQUATIONS)
+		return -1;
+	for (e = 0; e < number_of_equations; ++e) {
+		mask[n] = equations[e].mask & KEYSEARCH_KEY_BITS;
+		value[n] = equations[e].value & 0x01;
+		for (i = 0; i < n; ++i) {
+			if (mask[n] & KEYBIT(job->pivot_bit[i])) {
+				mask[n] ^= mask[i];
+				value[n] ^= value[i];
+			}
+		}
+		if (mask[n] == 0) {
+			// dependent on the previous equations
+			if (value[n])
+				return -1;
+			continue;
+		}
+		job->pivot_bit[n] = __builtin_clzll(mask[n]);
+		for (i = 0; i < n; ++i) {
+			if (mask[i] & KEYBIT(job->pivot_bit[n])) {
+				mask[i] ^= mask[n];
+				value[i] ^= value[n];
+			}
+		}
+		++n;
+	}
+
+	job->number_of_pivots = n;
+	for (i = 0; i < n; ++i) {
+		pivots |= KEYBIT(job->pivot_bit[i]);
+		job->pivot_mask[i] = mask[i] & ~KEYBIT(job->pivot_bit[i]);
+		job->pivot_value[i] = value[i];
+	}
+	// the lowest bits of the key vary between the lanes
+	job->number_of_free = 0;
+	for (b = 63; b >= 0; --b) {
+		if ((KEYSEARCH_KEY_BITS & ~pivots) & KEYBIT(b))
+			job->free_bit[job->number_of_free++] = b;
+	}
+	return 0;
+}
+
+static int bs_is_zero(BS_WORD x)
+{
+	const QWORD *w = (const QWORD *)&x;
+	QWORD any = 0;
+	int g;
+
+	for (g = 0; g < DES_BS_WORDS; ++g)
+		any |= w[g];
+	return any == 0;
+}
+
+// Bit planes of the lane part of the keys: lane j gets the free bits j, the higher free bits are 0
+static void lane_key_planes(const KEY_SEARCH_JOB *job, BS_WORD plane[64])
+{
+	QWORD *words;
+	int t, i, b, g, j;
+
+	memset(plane, 0, 64 * sizeof(BS_WORD));
+	for (t = 0; t < job->number_of_free && t < job->lane_bits; ++t) {
+		words = (QWORD *)&plane[job->free_bit[t]];
+		for (g = 0; g < DES_BS_WORDS; ++g) {
+			for (j = 0; j < 64; ++j) {
+				if (((g * 64 + j) >> t) & 0x01)
+					words[g] |= 1ULL << (63 - j);
+			}
+		}
+	}
+	for (i = 0; i < job->number_of_pivots; ++i) {
+		b = job->pivot_bit[i];
+		plane[b] = job->pivot_value[i] ? ~bs_zero : bs_zero;
+		for (t = 0; t < job->number_of_free && t < job->lane_bits; ++t) {
+			if (job->pivot_mask[i] & KEYBIT(job->free_bit[t]))
+				plane[b] ^= plane[job->free_bit[t]];
+		}
+	}
+}
+
+// Bit planes of the keys of batch "batch" (free bits lane_bits.. are the batch index), the
+// higher free bits are the same in all lanes and only flip the planes they enter
+static void batch_key_planes(const KEY_SEARCH_JOB *job, const BS_WORD lane_plane[64], QWORD batch, BS_WORD plane[64])
+{
+	QWORD batch_key = 0;
+	int t, i, b;
+
+	memcpy(plane, lane_plane, 64 * sizeof(BS_WORD));
+	for (t = job->lane_bits; t < job->number_of_free; ++t) {
+		if ((batch >> (t - job->lane_bits)) & 0x01) {
+			batch_key |= KEYBIT(job->free_bit[t]);
+			plane[job->free_bit[t]] = ~bs_zero;
+		}
+	}
+	for (i = 0; i < job->number_of_pivots; ++i) {
+		b = job->pivot_bit[i];
+		if (__builtin_parityll(job->pivot_mask[i] & batch_key))
+			plane[b] = ~plane[b];
+	}
+}
+
+// Lanes of the batch whose key maps all known plaintexts to their ciphertexts
+static BS_WORD test_batch(const KEY_SEARCH_JOB *job, const BS_WORD bs_key[][48], BS_WORD alive)
+{
+	BS_WORD state[64], diff;
+	int p, i;
+
+	for (p = 0; p < job->number_of_pairs && !bs_is_zero(alive); ++p) {
+		// the same plaintext in every lane
+		for (i = 0; i < 64; ++i)
+			state[i] = ((job->plain[p][i / 8] >> (7 - (i % 8))) & 0x01) ? ~bs_zero : bs_zero;
+		des_bs_rounds(state, bs_key, job->rounds);
+		diff = bs_zero;
+		for (i = 0; i < 64; ++i)
+			diff |= ((job->cipher[p][i / 8] >> (7 - (i % 8))) & 0x01) ? ~state[i] : state[i];
+		alive &= ~diff;
+	}
+	return alive;
+}
+
+// Lanes beyond 2^(free bits) would repeat keys, they are masked out of every batch
+static void valid_lanes(KEY_SEARCH_JOB *job)
+{
+	QWORD *words;
+	int g, j;
+
+	job->lanes = (job->number_of_free < job->lane_bits) ? (1ULL << job->number_of_free) : DES_BS_BLOCKS;
+	words = (QWORD *)&job->valid;
+	for (g = 0; g < DES_BS_WORDS; ++g) {
+		words[g] = 0;
+		for (j = 0; j < 64; ++j) {
+			if ((QWORD)(g * 64 + j) < job->lanes)
+				words[g] |= 1ULL << (63 - j);
+		}
+	}
+}
+
+// Tests the batches of one work item, returns 1 once a key is found so no more items are started
+static int key_search_item(void *arg, int worker, QWORD item)
+{
+	KEY_SEARCH_JOB *job = arg;
+	BS_WORD plane[64], bs_key[16][48], alive;
+	QWORD batch, last, *words;
+	int r, i, g, j;
+
+	if (__atomic_load_n(&job->found, __ATOMIC_RELAXED))
+		return 1;
+	last = (item + 1) * KEYSEARCH_ITEM_BATCHES;
+	if (last > job->number_of_batches)
+		last = job->number_of_batches;
+	for (batch = item * KEYSEARCH_ITEM_BATCHES; batch < last; ++batch) {
+		batch_key_planes(job, job->lane_plane, batch, plane);
+		for (r = 0; r < job->rounds; ++r) {
+			for (i = 0; i < 48; ++i)
+				bs_key[r][i] = plane[job->map[r][i]];
+		}
+		alive = test_batch(job, (const BS_WORD (*)[48])bs_key, job->valid);
+		job->worker[worker].keys_tested += job->lanes;
+		if (bs_is_zero(alive))
+			continue;
+
+		// the first matching lane, its key is put together from the planes
+		words = (QWORD *)&alive;
+		for (g = 0; words[g] == 0; ++g)
+			;
+		j = __builtin_clzll(words[g]);
+		pthread_mutex_lock(&job->lock);
+		if (!job->found) {
+			job->key = 0;
+			for (i = 0; i < 64; ++i) {
+				if ((((QWORD *)&plane[i])[g] >> (63 - j)) & 0x01)
+					job->key |= KEYBIT(i);
+			}
+			__atomic_store_n(&job->found, 1, __ATOMIC_RELAXED);
+		}
+		pthread_mutex_unlock(&job->lock);
+		return 1;
+	}
+	return 0;
+}
+
+int key_search(const BYTE plain[][DES_BLOCK_SIZE], const BYTE cipher[][DES_BLOCK_SIZE], int number_of_pairs, int rounds,
+               const KEY_EQUATION equations[], int number_of_equations, int threads, BYTE key[], KEY_SEARCH_STATS *stats)
+{
+	KEY_SEARCH_JOB job;
+	KEY_SEARCH_WORKER worker[PARALLEL_MAX_THREADS];
+	struct timespec start, end;
+	int i;
+
+	if (rounds < 1 || rounds > 16 || number_of_pairs < 1 || number_of_pairs > KEYSEARCH_MAX_PAIRS)
+		return -1;
+	memset(&job, 0, sizeof(job));
+	if (eliminate(&job, equations, number_of_equations) != 0)
+		return -1;
+	job.plain = plain;
+	job.cipher = cipher;
+	job.number_of_pairs = number_of_pairs;
+	job.rounds = rounds;
+	key_bit_map(job.map, rounds);
+	job.lane_bits = __builtin_ctz(DES_BS_BLOCKS);
+	job.number_of_batches = (job.number_of_free > job.lane_bits) ? (1ULL << (job.number_of_free - job.lane_bits)) : 1;
+	valid_lanes(&job);
+	lane_key_planes(&job, job.lane_plane);
+	threads = parallel_threads(threads);
+	memset(worker, 0, threads * sizeof(KEY_SEARCH_WORKER));
+	job.worker = worker;
+	pthread_mutex_init(&job.lock, NULL);
+
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	// an item is KEYSEARCH_ITEM_BATCHES batches
+	parallel_run(key_search_item, &job, (job.number_of_batches + KEYSEARCH_ITEM_BATCHES - 1) / KEYSEARCH_ITEM_BATCHES, threads);
+	clock_gettime(CLOCK_MONOTONIC, &end);
+	pthread_mutex_destroy(&job.lock);
+
+	if (stats != NULL) {
+		for (i = 0; i < threads; ++i)
+			stats->keys_tested += worker[i].keys_tested;
+		stats->seconds += (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) / 1e9;
+	}
+	if (!job.found)
+		return 0;
+	for (i = 0; i < DES_BLOCK_SIZE; ++i)
+		key[i] = (job.key >> (8 * (7 - i))) & 0xFF;
+	return 1;
+}
+
+int key_search_ranked(const BYTE plain[][DES_BLOCK_SIZE], const BYTE cipher[][DES_BLOCK_SIZE], int number_of_pairs, int rounds,
+                      const KEY_CANDIDATE candidates[], int number_of_candidates, const BYTE sboxes[], int number_of_sboxes,
+                      const KEY_EQUATION equations[], int number_of_equations, int threads, BYTE key[], KEY_SEARCH_STATS *stats)
+{
+	KEY_EQUATION all[KEYSEARCH_MAX_EQUATIONS];
+	BYTE map[16][48];
+	int c, s, k, n, bit;
+
+	if (number_of_equations + 6 * number_of_sboxes > KEYSEARCH_MAX_EQUATIONS || rounds < 1 || rounds > 16)
+		return -1;
+	key_bit_map(map, rounds);
+	if (stats != NULL)
+		stats->candidate = -1;
+
+	for (c = 0; c < number_of_candidates; ++c) {
+		memcpy(all, equations, number_of_equations * sizeof(KEY_EQUATION));
+		n = number_of_equations;
+		// the key bits of S-Box "s" are bits 6(s-1) .. 6(s-1)+5 of the last subkey
+		for (s = 0; s < number_of_sboxes; ++s) {
+			for (k = 0; k < 6; ++k) {
+				bit = 6 * (sboxes[s] - 1) + k;
+				all[n].mask = KEYBIT(map[rounds - 1][bit]);
+				all[n].value = (candidates[c].guess >> (6 * (number_of_sboxes - 1 - s) + 5 - k)) & 0x01;
+				++n;
+			}
+		}
+		// a candidate that contradicts the other equations can't be the right one
+		if (key_search(plain, cipher, number_of_pairs, rounds, all, n, threads, key, stats) == 1) {
+			if (stats != NULL)
+				stats->candidate = c;
+			return 1;
+		}
+	}
+	return 0;
+}
@@ -0,0 +1,59 @@
+/*********************************************************************
+* Filename:   des_keysearch.h
+* Copyright:
+* Disclaimer: This code is presented "as is" without any guarantees.
+* Details:    Defines the API for the key recovery stage after the
+              linear attacks. The recovered subkey bits and key parity
+              bits are mapped back onto the bits of the master key and
+              the rest of the key space is searched with the bitsliced
+              des_crypt, one key per bitslice lane. A master key is
+              handled as a 64-bit word like in des_linear.h (byte 0 in
+              the highest bits), the parity bits of the key bytes are
+              ignored.
+*********************************************************************/
+
+#ifndef DES_KEYSEARCH_H
+#define DES_KEYSEARCH_H
+
+/*************************** HEADER FILES ***************************/
+#include "des.h"
+#include "des_keyguess.h"
+#include "des_linear.h"
+
+/****************************** MACROS ******************************/
+#define KEYSEARCH_KEY_BITS 0xFEFEFEFEFEFEFEFEULL   // the 56 bits des_key_setup() uses
+#define KEYSEARCH_MAX_EQUATIONS 64
+#define KEYSEARCH_MAX_PAIRS 8
+#define KEYSEARCH_ITEM_BATCHES 256      // bitsliced batches per work item
+
+/**************************** DATA TYPES ****************************/
+// parity(key & mask) = value
+typedef struct {
+	QWORD mask;
+	BYTE value;
+} KEY_EQUATION;
+
+typedef struct {
+	QWORD keys_tested;
+	double seconds;
+	int candidate;                      // rank of the candidate the key was found with, -1 if none
+} KEY_SEARCH_STATS;
+
+/*********************** FUNCTION DECLARATIONS **********************/
+// map[r][i] is the master key bit (0..63 from the left) that becomes bit i (from the left) of subkey r+1
+void key_bit_map(BYTE map[][48], int rounds);
+// Master key bits of a subkey mask (48-bit word, see subkey_to_qword()) of subkey "round" (1-based)
+QWORD subkey_key_mask(int round, QWORD subkey_mask);
+// The right side of an approximation as an equation over the master key
+KEY_EQUATION approximation_key_equation(const LINEAR_APPROXIMATION *approx, BYTE right_side);
+// Searches all keys satisfying the equations, returns 1 if a key matching all known pairs was
+// found, 0 if there is none and -1 if the equations contradict each other
+int key_search(const BYTE plain[][DES_BLOCK_SIZE], const BYTE cipher[][DES_BLOCK_SIZE], int number_of_pairs, int rounds,
+               const KEY_EQUATION equations[], int number_of_equations, int threads, BYTE key[], KEY_SEARCH_STATS *stats);
+// Runs key_search() for the last round candidates of fwht_keyguess() in rank order, every candidate
+// fixes the key bits of the targeted S-Boxes of subkey "rounds" on top of the given equations
+int key_search_ranked(const BYTE plain[][DES_BLOCK_SIZE], const BYTE cipher[][DES_BLOCK_SIZE], int number_of_pairs, int rounds,
+                      const KEY_CANDIDATE candidates[], int number_of_candidates, const BYTE sboxes[], int number_of_sboxes,
+                      const KEY_EQUATION equations[], int number_of_equations, int threads, BYTE key[], KEY_SEARCH_STATS *stats);
+
+#endif   // DES_KEYSEARCH_H
@@ -0,0 +1,296 @@
+/*********************************************************************
+* Filename:   des_linear.c
+* Copyright:
+* Disclaimer: This code is presented "as is" without any guarantees.
+* Details:    Mask based linear approximations. The left side of an
+              approximation is parity((P & plain_mask) ^ (C & cipher_mask))
+              which is one popcount per text, so many approximations
+              can be counted in a single pass over the data.
+*********************************************************************/
+
+/*************************** HEADER FILES ***************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "des_linear.h"
+
+/****************************** MACROS ******************************/
+// Bit "b" (from the right) of the left/right half of a block and of a subkey
+#define LBIT(b) (1ULL << (32 + (b)))
+#define RBIT(b) (1ULL << (b))
+#define KBIT(b) (1ULL << (b))
+
+/**************************** DATA TYPES ****************************/
+typedef struct {
+	double weight;
+	int index;
+} VARIANT;
+
+/**************************** VARIABLES *****************************/
+static const LINEAR_APPROXIMATION builtin[4] = {
+	// R0[15] ^ L3[15] ^ L0[7,18,24,29] ^ R3[7,18,24,29] = K1[22] ^ K3[22]
+	// (the last round does not switch the halves, so C = (R3, L3))
+	{3, RBIT(15) | LBIT(7) | LBIT(18) | LBIT(24) | LBIT(29),
+	    RBIT(15) | LBIT(7) | LBIT(18) | LBIT(24) | LBIT(29), 0,
+	    {KBIT(22), 0, KBIT(22)}},
+	// L0[15] ^ R0[7,18,24,27,28,29,30,31] ^ R5[15] ^ L5[7,18,24,27,28,29,30,31] = K1,5[42,43,45,46] ^ K2,4[22], C = (R5, L5)
+	{5, LBIT(15) | RBIT(7) | RBIT(18) | RBIT(24) | RBIT(27) | RBIT(28) | RBIT(29) | RBIT(30) | RBIT(31),
+	    LBIT(15) | RBIT(7) | RBIT(18) | RBIT(24) | RBIT(27) | RBIT(28) | RBIT(29) | RBIT(30) | RBIT(31), 0,
+	    {KBIT(42) | KBIT(43) | KBIT(45) | KBIT(46), KBIT(22), 0, KBIT(22), KBIT(42) | KBIT(43) | KBIT(45) | KBIT(46)}},
+	// L0[7,18,24] ^ R0[12,16] ^ R7[15] ^ L7[7,18,24,29] = K1[19,23] ^ K3,5,7[22] ^ K4[44]
+	// (R7 = L8 and L7 = R8 if F(R8,K8) is 0, the 8 round entry below is the other interpretation)
+	{7, LBIT(7) | LBIT(18) | LBIT(24) | RBIT(12) | RBIT(16),
+	    LBIT(7) | LBIT(18) | LBIT(24) | LBIT(29) | RBIT(15), 0,
+	    {KBIT(19) | KBIT(23), 0, KBIT(22), KBIT(44), KBIT(22), 0, KBIT(22)}},
+	// L0[7,18,24] ^ R0[12,16] ^ L7[15] ^ R7[7,18,24,29] ^ F(R8,K8)[15] = K1[19,23] ^ K3,5,7[22] ^ K4[44]
+	{8, LBIT(7) | LBIT(18) | LBIT(24) | RBIT(12) | RBIT(16),
+	    LBIT(15) | RBIT(7) | RBIT(18) | RBIT(24) | RBIT(29), 0x00008000,
+	    {KBIT(19) | KBIT(23), 0, KBIT(22), KBIT(44), KBIT(22), 0, KBIT(22), 0}}
+};
+
+/*********************** FUNCTION DEFINITIONS ***********************/
+QWORD block_to_qword(const BYTE block[])
+{
+	QWORD word = 0;
+	int i;
+
+	for (i = 0; i < DES_BLOCK_SIZE; ++i)
+		word = (word << 8) | block[i];
+	return word;
+}
+
+QWORD subkey_to_qword(const BYTE subkey[])
+{
+	QWORD word = 0;
+	int i;
+
+	for (i = 0; i < 6; ++i)
+		word = (word << 8) | subkey[i];
+	return word;
+}
+
+const LINEAR_APPROXIMATION *builtin_approximation(int rounds)
+{
+	int i;
+
+	for (i = 0; i < 4; ++i) {
+		if (builtin[i].rounds == rounds)
+			return &builtin[i];
+	}
+	return NULL;
+}
+
+BYTE approximation_left_side(const LINEAR_APPROXIMATION *approx, QWORD plain, QWORD cipher, WORD f)
+{
+	return (__builtin_parityll((plain & approx->plain_mask) ^ (cipher & approx->cipher_mask)) ^
+	        __builtin_parity(f & approx->fmask)) & 0x01;
+}
+
+BYTE approximation_right_side(const LINEAR_APPROXIMATION *approx, const BYTE schedule[][6])
+{
+	QWORD bits = 0;
+	int i;
+
+	for (i = 0; i < approx->rounds; ++i)
+		bits ^= subkey_to_qword(schedule[i]) & approx->key_mask[i];
+	return __builtin_parityll(bits);
+}
+
+void count_approximations(const BYTE plain[][DES_BLOCK_SIZE], const BYTE cipher[][DES_BLOCK_SIZE], int number_of_plains,
+                          const LINEAR_APPROXIMATION approx[], int number_of_approx, const BYTE keyguess[], unsigned int count_T0[])
+{
+	QWORD p[LINEAR_BATCH_SIZE], c[LINEAR_BATCH_SIZE];
+	WORD f8[LINEAR_BATCH_SIZE];
+	int i, j, a, batch;
+	unsigned int ones;
+
+	for (i = 0; i < number_of_plains; i += LINEAR_BATCH_SIZE) {
+		batch = number_of_plains - i;
+		if (batch > LINEAR_BATCH_SIZE)
+			batch = LINEAR_BATCH_SIZE;
+		for (j = 0; j < batch; ++j) {
+			p[j] = block_to_qword(plain[i+j]);
+			c[j] = block_to_qword(cipher[i+j]);
+			f8[j] = (keyguess != NULL) ? f((WORD)c[j], keyguess) : 0;
+		}
+
+		for (a = 0; a < number_of_approx; ++a) {
+			const QWORD mp = approx[a].plain_mask;
+			const QWORD mc = approx[a].cipher_mask;
+			const WORD mf = approx[a].fmask;
+
+			ones = 0;
+			for (j = 0; j < batch; ++j)
+				ones += (__builtin_popcountll((p[j] & mp) ^ (c[j] & mc)) + __builtin_popcount(f8[j] & mf)) & 0x01;
+			count_T0[a] += batch - ones;
+		}
+	}
+}
+
+int sbox_lat(int s, BYTE a, BYTE b)
+{
+	int x, count = 0;
+
+	for (x = 0; x < 64; ++x)
+		count += !(__builtin_parity(x & a) ^ __builtin_parity(des_sbox(s, x) & b));
+	return count - 32;
+}
+
+WORD linear_expansion_mask(QWORD a)
+{
+	WORD x = 0;
+	int e;
+
+	for (e = 0; e < 48; ++e) {
+		if ((a >> (47 - e)) & 0x01)
+			x ^= 1u << (31 - des_expansion[e]);
+	}
+	return x;
+}
+
+WORD linear_pbox_mask(WORD b)
+{
+	WORD y = 0;
+	int i;
+
+	for (i = 0; i < 32; ++i) {
+		if ((b >> (31 - des_pbox[i])) & 0x01)
+			y |= 1u << (31 - i);
+	}
+	return y;
+}
+
+WORD linear_pbox_inverse_mask(WORD y)
+{
+	WORD b = 0;
+	int i;
+
+	for (i = 0; i < 32; ++i) {
+		if ((y >> (31 - i)) & 0x01)
+			b |= 1u << (31 - des_pbox[i]);
+	}
+	return b;
+}
+
+static int compare_variants(const void *a, const void *b)
+{
+	const VARIANT *va = a, *vb = b;
+	double wa = fabs(va->weight), wb = fabs(vb->weight);
+
+	if (wa != wb)
+		return wa < wb ? 1 : -1;
+	return va->index - vb->index;
+}
+
+int round1_variants(const LINEAR_APPROXIMATION *approx, LINEAR_APPROXIMATION variants[], double weight[], int max_variants)
+{
+	LINEAR_APPROXIMATION all[LINEAR_MAX_VARIANTS];
+	VARIANT order[LINEAR_MAX_VARIANTS];
+	WORD b = linear_pbox_inverse_mask((WORD)(approx->plain_mask >> 32));
+	QWORD k1, field;
+	int count = 1, n, j, a, bj, aj, lat, lat0;
+
+	all[0] = *approx;
+	order[0].weight = 1.0;
+	order[0].index = 0;
+
+	// every active S-Box of round 1 may use any input mask with the same output mask,
+	// the variants of one S-Box are combined with the ones found for the S-Boxes before
+	for (j = 0; j < 8; ++j) {
+		aj = (approx->key_mask[0] >> (42 - 6 * j)) & 0x3F;
+		bj = (b >> (28 - 4 * j)) & 0x0F;
+		if (aj == 0)
+			continue;
+		lat0 = sbox_lat(j + 1, aj, bj);
+		if (lat0 == 0)
+			return -1;
+		for (n = count - 1; n >= 0; --n) {
+			for (a = 1; a < 64; ++a) {
+				lat = sbox_lat(j + 1, a, bj);
+				if (a == aj || lat == 0 || count == LINEAR_MAX_VARIANTS)
+					continue;
+				field = (QWORD)0x3F << (42 - 6 * j);
+				k1 = all[order[n].index].key_mask[0];
+				all[count] = all[order[n].index];
+				all[count].key_mask[0] = (k1 & ~field) | ((QWORD)a << (42 - 6 * j));
+				all[count].plain_mask ^= linear_expansion_mask(k1 & field) ^ linear_expansion_mask((QWORD)a << (42 - 6 * j));
+				order[count].weight = order[n].weight * lat / lat0;
+				order[count].index = count;
+				++count;
+			}
+		}
+	}
+
+	qsort(order, count, sizeof(VARIANT), compare_variants);
+	if (count > max_variants)
+		count = max_variants;
+	for (n = 0; n < count; ++n) {
+		variants[n] = all[order[n].index];
+		weight[n] = order[n].weight;
+	}
+	return count;
+}
+
+int load_approximations(const char *filename, LINEAR_APPROXIMATION approx[], int max_approx)
+{
+	FILE *file;
+	char line[1024];
+	char *pos;
+	int count = 0;
+	int i, used;
+	LINEAR_APPROXIMATION a;
+
+	file = fopen(filename, "r");
+	if (file == NULL)
+		return -1;
+
+	while (count < max_approx && fgets(line, sizeof(line), file) != NULL) {
+		if ((pos = strchr(line, '#')) != NULL)
+			*pos = '\0';
+		// blank and comment lines are skipped, every other line has to be a complete approximation
+		if (line[strspn(line, " \t\r\n")] == '\0')
+			continue;
+		memset(&a, 0, sizeof(a));
+		if (sscanf(line, "%d %llx %llx %x%n", &a.rounds, &a.plain_mask, &a.cipher_mask, &a.fmask, &used) != 4
+		    || a.rounds < 1 || a.rounds > LINEAR_MAX_ROUNDS) {
+			fclose(file);
+			return -1;
+		}
+		pos = line + used;
+		for (i = 0; i < a.rounds; ++i) {
+			if (sscanf(pos, "%llx%n", &a.key_mask[i], &used) != 1) {
+				fclose(file);
+				return -1;
+			}
+			pos += used;
+		}
+		if (pos[strspn(pos, " \t\r\n")] != '\0') {
+			fclose(file);
+			return -1;
+		}
+		approx[count++] = a;
+	}
+	fclose(file);
+	return count;
+}
+
+int save_approximations(const char *filename, const LINEAR_APPROXIMATION approx[], int number_of_approx)
+{
+	FILE *file;
+	int a, i;
+
+	file = fopen(filename, "w");
+	if (file == NULL)
+		return -1;
+
+	fprintf(file, "# rounds plain_mask cipher_mask fmask key_mask_1 ... key_mask_rounds\n");
+	for (a = 0; a < number_of_approx; ++a) {
+		fprintf(file, "%d %016llX %016llX %08X", approx[a].rounds, approx[a].plain_mask, approx[a].cipher_mask, approx[a].fmask);
+		for (i = 0; i < approx[a].rounds; ++i)
+			fprintf(file, " %012llX", approx[a].key_mask[i]);
+		fprintf(file, "\n");
+	}
+	fclose(file);
+	return 0;
+}
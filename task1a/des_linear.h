@@ -0,0 +1,61 @@
+/*********************************************************************
+* Filename:   des_linear.h
+* Copyright:
+* Disclaimer: This code is presented "as is" without any guarantees.
+* Details:    Defines the API for mask based linear approximations.
+              Plaintext and ciphertext are handled as 64-bit words
+              (block byte 0 in the highest bits, so L is bits 63..32
+              and R is bits 31..0). A subkey is a 48-bit word with
+              byte 0 of the schedule entry in the highest bits. Bit
+              numbers are counted from the right like in Matsui's paper.
+*********************************************************************/
+
+#ifndef DES_LINEAR_H
+#define DES_LINEAR_H
+
+/*************************** HEADER FILES ***************************/
+#include "des.h"
+
+/****************************** MACROS ******************************/
+#define LINEAR_MAX_ROUNDS 16
+#define LINEAR_BATCH_SIZE 256           // blocks per batch in count_approximations()
+#define LINEAR_MAX_VARIANTS 256         // approximations round1_variants() considers
+
+/**************************** DATA TYPES ****************************/
+// P[plain_mask] ^ C[cipher_mask] ^ F(C_R,K_last)[fmask] = K1[key_mask[0]] ^ ... ^ Kr[key_mask[r-1]]
+typedef struct {
+	int rounds;
+	QWORD plain_mask;
+	QWORD cipher_mask;
+	WORD fmask;                         // optional last round term, 0 if not used
+	QWORD key_mask[LINEAR_MAX_ROUNDS];
+} LINEAR_APPROXIMATION;
+
+/*********************** FUNCTION DECLARATIONS **********************/
+QWORD block_to_qword(const BYTE block[]);
+QWORD subkey_to_qword(const BYTE subkey[]);
+// The approximation compute_left_side() uses for 3, 5, 7 and 8 rounds, NULL otherwise
+const LINEAR_APPROXIMATION *builtin_approximation(int rounds);
+BYTE approximation_left_side(const LINEAR_APPROXIMATION *approx, QWORD plain, QWORD cipher, WORD f);
+BYTE approximation_right_side(const LINEAR_APPROXIMATION *approx, const BYTE schedule[][6]);
+// Counts T0 for every approximation in one pass over the data, keyguess is
+// the last round subkey for approximations with an F term (may be NULL otherwise)
+void count_approximations(const BYTE plain[][DES_BLOCK_SIZE], const BYTE cipher[][DES_BLOCK_SIZE], int number_of_plains,
+                          const LINEAR_APPROXIMATION approx[], int number_of_approx, const BYTE keyguess[], unsigned int count_T0[]);
+// Matches - 32 of the S-Box "s" (1..8) approximation parity(x & a) = parity(S(x) & b)
+int sbox_lat(int s, BYTE a, BYTE b);
+// Mask on R for the mask "a" on the 48 expanded bits (leftmost expanded bit in bit 47)
+WORD linear_expansion_mask(QWORD a);
+// Mask on F(R,K) for the mask "b" on the 32 S-Box output bits and back
+WORD linear_pbox_mask(WORD b);
+WORD linear_pbox_inverse_mask(WORD y);
+// The approximation and the ones that take other round 1 input masks for the same round 1
+// output mask (P_L), best first. weight[i] is the bias of variant i relative to the one of approx.
+int round1_variants(const LINEAR_APPROXIMATION *approx, LINEAR_APPROXIMATION variants[], double weight[], int max_variants);
+// Reads approximations from a text file, one per line:
+// rounds plain_mask cipher_mask fmask key_mask_1 ... key_mask_rounds (all masks hex, '#' starts a comment).
+// Returns -1 if a line that is not blank or a comment does not parse.
+int load_approximations(const char *filename, LINEAR_APPROXIMATION approx[], int max_approx);
+int save_approximations(const char *filename, const LINEAR_APPROXIMATION approx[], int number_of_approx);
+
+#endif   // DES_LINEAR_H
@@ -0,0 +1,448 @@
+/*********************************************************************
+* Filename:   des_oracle.c
+* Copyright:
+* Disclaimer: This code is presented "as is" without any guarantees.
+* Details:    Local encryption oracle over a UNIX stream socket. The
+              server accepts clients in a background thread and gives
+              every client its own thread. oracle_collect() is a
+              pipeline like stream_plaintexts(): the sender thread fills
+              the plaintext slots of a ring and sends them as requests,
+              the calling thread reads the responses in order and gives
+              the slot back after the consumer has seen it.
+*********************************************************************/
+
+/*************************** HEADER FILES ***************************/
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include "des_oracle.h"
+#include "des_stream.h"
+#include "des_table.h"
+
+/**************************** DATA TYPES ****************************/
+typedef struct {
+	ORACLE_SERVER *server;
+	int slot;
+} ORACLE_CLIENT;
+
+typedef struct {
+	int fd;
+	const BYTE *seed;
+	int number_of_plains;
+	int batch;
+	int depth;
+	BYTE (*plain)[DES_BLOCK_SIZE];      // depth slots of batch blocks
+	struct timespec *sent;              // send time of the request in every slot
+	int number_of_requests;
+	int received;
+	int error;
+	pthread_mutex_t lock;
+	pthread_cond_t not_full;
+} ORACLE_PIPELINE;
+
+/*********************** FUNCTION DEFINITIONS ***********************/
+static double seconds_between(const struct timespec *start, const struct timespec *end)
+{
+	return (end->tv_sec - start->tv_sec) + (end->tv_nsec - start->tv_nsec) / 1e9;
+}
+
+static int read_full(int fd, void *buffer, size_t size)
+{
+	BYTE *pos = buffer;
+	ssize_t n;
+
+	while(size > 0)
+	{
+		n = recv(fd, pos, size, 0);
+		if(n <= 0)
+		{
+			return -1;
+		}
+		pos += n;
+		size -= n;
+	}
+	return 0;
+}
+
+static int write_full(int fd, const void *buffer, size_t size)
+{
+	const BYTE *pos = buffer;
+	ssize_t n;
+
+	while(size > 0)
+	{
+		//no SIGPIPE if the other side has gone
+		n = send(fd, pos, size, MSG_NOSIGNAL);
+		if(n <= 0)
+		{
+			return -1;
+		}
+		pos += n;
+		size -= n;
+	}
+	return 0;
+}
+
+static void *client_run(void *arg)
+{
+	ORACLE_CLIENT *client = arg;
+	ORACLE_SERVER *server = client->server;
+	int fd = server->client_fd[client->slot];
+	DES_CRYPT_BLOCKS_FUNC crypt = des_crypt_blocks_select(server->rounds);
+	BYTE (*in)[DES_BLOCK_SIZE] = malloc(ORACLE_MAX_BATCH * DES_BLOCK_SIZE);
+	BYTE (*out)[DES_BLOCK_SIZE] = malloc(ORACLE_MAX_BATCH * DES_BLOCK_SIZE);
+	ORACLE_HEADER header;
+
+	//a broken request ends the connection
+	while(in != NULL && out != NULL && read_full(fd, &header, sizeof(header)) == 0)
+	{
+		if(header.magic != ORACLE_MAGIC || header.count > ORACLE_MAX_BATCH || read_full(fd, in, (size_t)header.count * DES_BLOCK_SIZE) != 0)
+		{
+			break;
+		}
+		crypt((const BYTE (*)[DES_BLOCK_SIZE])in, out, (const BYTE (*)[6])server->schedule, header.count);
+		if(write_full(fd, &header, sizeof(header)) != 0 || write_full(fd, out, (size_t)header.count * DES_BLOCK_SIZE) != 0)
+		{
+			break;
+		}
+		__atomic_fetch_add(&server->requests, 1, __ATOMIC_RELAXED);
+		__atomic_fetch_add(&server->blocks, header.count, __ATOMIC_RELAXED);
+	}
+	free(in);
+	free(out);
+
+	pthread_mutex_lock(&server->lock);
+	close(fd);
+	server->client_fd[client->slot] = -1;
+	server->clients--;
+	pthread_cond_signal(&server->idle);
+	pthread_mutex_unlock(&server->lock);
+	free(client);
+	return NULL;
+}
+
+static void *accept_run(void *arg)
+{
+	ORACLE_SERVER *server = arg;
+	ORACLE_CLIENT *client;
+	pthread_t thread;
+	int fd, slot;
+
+	while(1)
+	{
+		fd = accept(server->listen_fd, NULL, NULL);
+		pthread_mutex_lock(&server->lock);
+		if(server->stop)
+		{
+			pthread_mutex_unlock(&server->lock);
+			if(fd >= 0)
+			{
+				close(fd);
+			}
+			break;
+		}
+		for(slot = 0; fd >= 0 && slot < ORACLE_MAX_CLIENTS && server->client_fd[slot] >= 0; slot++);
+		client = (fd >= 0 && slot < ORACLE_MAX_CLIENTS) ? malloc(sizeof(ORACLE_CLIENT)) : NULL;
+		if(client != NULL)
+		{
+			client->server = server;
+			client->slot = slot;
+			server->client_fd[slot] = fd;
+			server->clients++;
+			if(pthread_create(&thread, NULL, client_run, client) == 0)
+			{
+				pthread_detach(thread);
+			}
+			else
+			{
+				server->client_fd[slot] = -1;
+				server->clients--;
+				free(client);
+				close(fd);
+			}
+		}
+		else if(fd >= 0)
+		{
+			close(fd);
+		}
+		pthread_mutex_unlock(&server->lock);
+	}
+	return NULL;
+}
+
+int oracle_start(ORACLE_SERVER *server, const char *path, const BYTE key[], int rounds)
+{
+	struct sockaddr_un address;
+	int i;
+
+	memset(server, 0, sizeof(ORACLE_SERVER));
+	if(rounds < 1 || rounds > 16 || strlen(path) >= sizeof(address.sun_path))
+	{
+		return -1;
+	}
+	for(i = 0; i < ORACLE_MAX_CLIENTS; i++)
+	{
+		server->client_fd[i] = -1;
+	}
+	strcpy(server->path, path);
+	server->rounds = rounds;
+	des_key_setup_table(key, server->schedule, DES_ENCRYPT, rounds);
+
+	memset(&address, 0, sizeof(address));
+	address.sun_family = AF_UNIX;
+	strcpy(address.sun_path, path);
+	unlink(path);
+	server->listen_fd = socket(AF_UNIX, SOCK_STREAM, 0);
+	if(server->listen_fd < 0)
+	{
+		return -1;
+	}
+	if(bind(server->listen_fd, (struct sockaddr *)&address, sizeof(address)) != 0 || listen(server->listen_fd, ORACLE_MAX_CLIENTS) != 0)
+	{
+		close(server->listen_fd);
+		return -1;
+	}
+	pthread_mutex_init(&server->lock, NULL);
+	pthread_cond_init(&server->idle, NULL);
+	if(pthread_create(&server->accept_thread, NULL, accept_run, server) != 0)
+	{
+		pthread_cond_destroy(&server->idle);
+		pthread_mutex_destroy(&server->lock);
+		close(server->listen_fd);
+		unlink(path);
+		return -1;
+	}
+	return 0;
+}
+
+void oracle_stop(ORACLE_SERVER *server)
+{
+	int i;
+
+	pthread_mutex_lock(&server->lock);
+	server->stop = 1;
+	for(i = 0; i < ORACLE_MAX_CLIENTS; i++)
+	{
+		if(server->client_fd[i] >= 0)
+		{
+			shutdown(server->client_fd[i], SHUT_RDWR);
+		}
+	}
+	pthread_mutex_unlock(&server->lock);
+
+	//wakes up accept()
+	shutdown(server->listen_fd, SHUT_RDWR);
+	pthread_join(server->accept_thread, NULL);
+	close(server->listen_fd);
+
+	pthread_mutex_lock(&server->lock);
+	while(server->clients > 0)
+	{
+		pthread_cond_wait(&server->idle, &server->lock);
+	}
+	pthread_mutex_unlock(&server->lock);
+	pthread_cond_destroy(&server->idle);
+	pthread_mutex_destroy(&server->lock);
+	unlink(server->path);
+}
+
+int oracle_connect(const char *path)
+{
+	struct sockaddr_un address;
+	int fd;
+
+	if(strlen(path) >= sizeof(address.sun_path))
+	{
+		return -1;
+	}
+	memset(&address, 0, sizeof(address));
+	address.sun_family = AF_UNIX;
+	strcpy(address.sun_path, path);
+	fd = socket(AF_UNIX, SOCK_STREAM, 0);
+	if(fd >= 0 && connect(fd, (struct sockaddr *)&address, sizeof(address)) != 0)
+	{
+		close(fd);
+		return -1;
+	}
+	return fd;
+}
+
+static int send_request(int fd, const BYTE in[][DES_BLOCK_SIZE], int number_of_plains)
+{
+	ORACLE_HEADER header;
+
+	header.magic = ORACLE_MAGIC;
+	header.count = number_of_plains;
+	if(write_full(fd, &header, sizeof(header)) != 0)
+	{
+		return -1;
+	}
+	return write_full(fd, in, (size_t)number_of_plains * DES_BLOCK_SIZE);
+}
+
+static int receive_response(int fd, BYTE out[][DES_BLOCK_SIZE], int number_of_plains)
+{
+	ORACLE_HEADER header;
+
+	if(read_full(fd, &header, sizeof(header)) != 0 || header.magic != ORACLE_MAGIC || header.count != number_of_plains)
+	{
+		return -1;
+	}
+	return read_full(fd, out, (size_t)number_of_plains * DES_BLOCK_SIZE);
+}
+
+int oracle_encrypt(int fd, const BYTE in[][DES_BLOCK_SIZE], BYTE out[][DES_BLOCK_SIZE], int number_of_plains)
+{
+	if(number_of_plains < 1 || number_of_plains > ORACLE_MAX_BATCH || send_request(fd, in, number_of_plains) != 0)
+	{
+		return -1;
+	}
+	return receive_response(fd, out, number_of_plains);
+}
+
+static int request_size(const ORACLE_PIPELINE *pipeline, int request)
+{
+	int count = pipeline->number_of_plains - request * pipeline->batch;
+
+	return (count > pipeline->batch) ? pipeline->batch : count;
+}
+
+static void *sender_run(void *arg)
+{
+	ORACLE_PIPELINE *pipeline = arg;
+	BYTE (*slot)[DES_BLOCK_SIZE];
+	int request, count;
+
+	for(request = 0; request < pipeline->number_of_requests; request++)
+	{
+		pthread_mutex_lock(&pipeline->lock);
+		while(pipeline->error == 0 && request - pipeline->received >= pipeline->depth)
+		{
+			pthread_cond_wait(&pipeline->not_full, &pipeline->lock);
+		}
+		pthread_mutex_unlock(&pipeline->lock);
+		if(pipeline->error)
+		{
+			break;
+		}
+
+		slot = &pipeline->plain[(size_t)(request % pipeline->depth) * pipeline->batch];
+		count = request_size(pipeline, request);
+		counter_plaintexts(pipeline->seed, (QWORD)request * pipeline->batch, count, slot);
+
+		pthread_mutex_lock(&pipeline->lock);
+		clock_gettime(CLOCK_MONOTONIC, &pipeline->sent[request % pipeline->depth]);
+		pthread_mutex_unlock(&pipeline->lock);
+		if(send_request(pipeline->fd, (const BYTE (*)[DES_BLOCK_SIZE])slot, count) != 0)
+		{
+			pthread_mutex_lock(&pipeline->lock);
+			pipeline->error = 1;
+			pthread_mutex_unlock(&pipeline->lock);
+			//the receiver must not wait for a response that never comes
+			shutdown(pipeline->fd, SHUT_RDWR);
+			break;
+		}
+	}
+	return NULL;
+}
+
+int oracle_collect(int fd, const BYTE seed[], int number_of_plains, int batch, int depth, ORACLE_CONSUMER consume, void *arg, ORACLE_STATS *stats)
+{
+	ORACLE_PIPELINE pipeline;
+	BYTE (*cipher)[DES_BLOCK_SIZE];
+	pthread_t sender;
+	struct timespec start, now, sent, done;
+	double latency;
+	int request, count, started, result = 0;
+
+	memset(stats, 0, sizeof(ORACLE_STATS));
+	batch = (batch > 0) ? batch : ORACLE_BATCH;
+	depth = (depth > 0) ? depth : ORACLE_DEPTH;
+	if(batch > ORACLE_MAX_BATCH || number_of_plains < 0)
+	{
+		return -1;
+	}
+	pipeline.fd = fd;
+	pipeline.seed = seed;
+	pipeline.number_of_plains = number_of_plains;
+	pipeline.batch = batch;
+	pipeline.depth = depth;
+	pipeline.number_of_requests = (number_of_plains + batch - 1) / batch;
+	pipeline.received = 0;
+	pipeline.error = 0;
+	pipeline.plain = malloc((size_t)depth * batch * DES_BLOCK_SIZE);
+	pipeline.sent = malloc(depth * sizeof(struct timespec));
+	cipher = malloc((size_t)batch * DES_BLOCK_SIZE);
+	if(pipeline.plain == NULL || pipeline.sent == NULL || cipher == NULL)
+	{
+		free(pipeline.plain);
+		free(pipeline.sent);
+		free(cipher);
+		return -1;
+	}
+	pthread_mutex_init(&pipeline.lock, NULL);
+	pthread_cond_init(&pipeline.not_full, NULL);
+
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	started = (pthread_create(&sender, NULL, sender_run, &pipeline) == 0);
+	if(!started)
+	{
+		result = -1;
+	}
+	for(request = 0; result == 0 && request < pipeline.number_of_requests; request++)
+	{
+		count = request_size(&pipeline, request);
+		clock_gettime(CLOCK_MONOTONIC, &now);
+		if(receive_response(fd, cipher, count) != 0)
+		{
+			result = -1;
+			break;
+		}
+		clock_gettime(CLOCK_MONOTONIC, &done);
+		stats->wait_seconds += seconds_between(&now, &done);
+		pthread_mutex_lock(&pipeline.lock);
+		sent = pipeline.sent[request % depth];
+		pthread_mutex_unlock(&pipeline.lock);
+		latency = seconds_between(&sent, &done);
+		stats->latency_mean += latency;
+		stats->latency_max = (latency > stats->latency_max) ? latency : stats->latency_max;
+
+		consume((const BYTE (*)[DES_BLOCK_SIZE])&pipeline.plain[(size_t)(request % depth) * batch], (const BYTE (*)[DES_BLOCK_SIZE])cipher, count, arg);
+		clock_gettime(CLOCK_MONOTONIC, &now);
+		stats->consume_seconds += seconds_between(&done, &now);
+		stats->requests++;
+		stats->blocks += count;
+
+		pthread_mutex_lock(&pipeline.lock);
+		pipeline.received++;
+		pthread_cond_signal(&pipeline.not_full);
+		pthread_mutex_unlock(&pipeline.lock);
+	}
+	if(result != 0)
+	{
+		pthread_mutex_lock(&pipeline.lock);
+		pipeline.error = 1;
+		pthread_cond_signal(&pipeline.not_full);
+		pthread_mutex_unlock(&pipeline.lock);
+	}
+	if(started)
+	{
+		pthread_join(sender, NULL);
+	}
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	stats->seconds = seconds_between(&start, &now);
+	if(stats->requests > 0)
+	{
+		stats->latency_mean /= stats->requests;
+	}
+
+	pthread_cond_destroy(&pipeline.not_full);
+	pthread_mutex_destroy(&pipeline.lock);
+	free(pipeline.plain);
+	free(pipeline.sent);
+	free(cipher);
+	return result;
+}
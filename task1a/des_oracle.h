@@ -0,0 +1,76 @@
+/*********************************************************************
+* Filename:   des_oracle.h
+* Copyright:
+* Disclaimer: This code is presented "as is" without any guarantees.
+* Details:    Defines the API for the local encryption oracle. The
+              server holds the key and answers batched requests over a
+              UNIX stream socket, the client only sees plaintexts and
+              ciphertexts. A request is an ORACLE_HEADER with the
+              number of blocks followed by the blocks, the response has
+              the same form with the encrypted blocks.
+*********************************************************************/
+
+#ifndef DES_ORACLE_H
+#define DES_ORACLE_H
+
+/*************************** HEADER FILES ***************************/
+#include <pthread.h>
+#include "des.h"
+
+/****************************** MACROS ******************************/
+#define ORACLE_MAGIC 0x4F524331         // "ORC1"
+#define ORACLE_MAX_BATCH 65536          // blocks per request
+#define ORACLE_MAX_CLIENTS 16
+#define ORACLE_BATCH 4096               // default blocks per request of oracle_collect()
+#define ORACLE_DEPTH 4                  // default requests in flight of oracle_collect()
+
+/**************************** DATA TYPES ****************************/
+typedef struct {
+	WORD magic;
+	WORD count;
+} ORACLE_HEADER;
+
+typedef struct {
+	int listen_fd;
+	int client_fd[ORACLE_MAX_CLIENTS];  // -1 for a free entry
+	int clients;
+	int stop;
+	BYTE schedule[16][6];
+	int rounds;
+	QWORD requests;                     // answered so far
+	QWORD blocks;
+	char path[108];
+	pthread_t accept_thread;
+	pthread_mutex_t lock;
+	pthread_cond_t idle;
+} ORACLE_SERVER;
+
+// Called once per response in request order with the plaintexts and their ciphertexts
+typedef void (*ORACLE_CONSUMER)(const BYTE plain[][DES_BLOCK_SIZE], const BYTE cipher[][DES_BLOCK_SIZE], int number_of_plains, void *arg);
+
+typedef struct {
+	QWORD requests;
+	QWORD blocks;
+	double seconds;                     // wall time of the collection
+	double wait_seconds;                // time the consumer side waited for responses
+	double consume_seconds;             // time spent in the consumer
+	double latency_mean;                // from sending a request to its response
+	double latency_max;
+} ORACLE_STATS;
+
+/*********************** FUNCTION DECLARATIONS **********************/
+// Listens on the socket "path" and answers with the "rounds" round encryption under key
+// in background threads until oracle_stop()
+int oracle_start(ORACLE_SERVER *server, const char *path, const BYTE key[], int rounds);
+void oracle_stop(ORACLE_SERVER *server);
+
+// Returns the socket or -1
+int oracle_connect(const char *path);
+// One request, waits for the response
+int oracle_encrypt(int fd, const BYTE in[][DES_BLOCK_SIZE], BYTE out[][DES_BLOCK_SIZE], int number_of_plains);
+// Gets the encryptions of the plaintexts 0 .. number_of_plains-1 of the data set "seed": a
+// thread sends requests of "batch" blocks while up to "depth" of them are unanswered,
+// the calling thread receives the responses and hands them to the consumer
+int oracle_collect(int fd, const BYTE seed[], int number_of_plains, int batch, int depth, ORACLE_CONSUMER consume, void *arg, ORACLE_STATS *stats);
+
+#endif   // DES_ORACLE_H
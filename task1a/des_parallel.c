@@ -0,0 +1,220 @@
+/*********************************************************************
+* Filename:   des_parallel.c
+* Copyright:
+* Disclaimer: This code is presented "as is" without any guarantees.
+* Details:    Multi-threaded algorithm 1 and algorithm 2. The work is
+              split into (key guess, plaintext chunk) items that the
+              threads of parallel_run() take from a shared counter.
+              Every thread counts into its own cache line aligned T0/T1
+              counters, which are summed up after all threads have
+              finished. parallel_run() is the worker pool of all the
+              other multi-threaded parts as well.
+*********************************************************************/
+
+/*************************** HEADER FILES ***************************/
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <pthread.h>
+#include "des_parallel.h"
+#include "des_stats.h"
+
+/**************************** DATA TYPES ****************************/
+typedef struct {
+	PARALLEL_ITEM_FUNC func;
+	void *arg;
+	QWORD number_of_items;
+	QWORD next_item;                    // shared, taken with an atomic add
+	int stop;                           // set once an item asked to start no more items
+	int error;
+} PARALLEL_POOL;
+
+typedef struct {
+	PARALLEL_POOL *pool;
+	int worker;
+} __attribute__ ((aligned (CACHE_LINE_SIZE))) POOL_THREAD;
+
+typedef struct {
+	unsigned int count_T0;
+	unsigned int count_T1;
+} COUNTERS;
+
+typedef struct {
+	const BYTE (*plain)[DES_BLOCK_SIZE];
+	const BYTE (*key)[6];
+	const BYTE *keyguess;               // used if there is only one guess
+	int number_of_plains;
+	int rounds;
+	int keyguesses;
+	int number_of_chunks;
+	size_t counters_size;               // bytes per worker, a multiple of the cache line
+	BYTE *counters;                     // one block of keyguesses COUNTERS per worker
+} PARALLEL_JOB;
+
+/*********************** FUNCTION DEFINITIONS ***********************/
+int parallel_threads(int threads)
+{
+	if (threads <= 0)
+		threads = (int)sysconf(_SC_NPROCESSORS_ONLN);
+	if (threads < 1)
+		threads = 1;
+	if (threads > PARALLEL_MAX_THREADS)
+		threads = PARALLEL_MAX_THREADS;
+	return threads;
+}
+
+static void *pool_run(void *arg)
+{
+	POOL_THREAD *thread = arg;
+	PARALLEL_POOL *pool = thread->pool;
+	QWORD item;
+	int result;
+
+	while (!__atomic_load_n(&pool->stop, __ATOMIC_RELAXED)
+	       && (item = __atomic_fetch_add(&pool->next_item, 1, __ATOMIC_RELAXED)) < pool->number_of_items) {
+		result = pool->func(pool->arg, thread->worker, item);
+		if (result < 0)
+			__atomic_store_n(&pool->error, 1, __ATOMIC_RELAXED);
+		else if (result > 0)
+			__atomic_store_n(&pool->stop, 1, __ATOMIC_RELAXED);
+	}
+	return NULL;
+}
+
+int parallel_run(PARALLEL_ITEM_FUNC func, void *arg, QWORD number_of_items, int threads)
+{
+	PARALLEL_POOL pool;
+	POOL_THREAD thread[PARALLEL_MAX_THREADS];
+	pthread_t id[PARALLEL_MAX_THREADS];
+	int i, started;
+
+	pool.func = func;
+	pool.arg = arg;
+	pool.number_of_items = number_of_items;
+	pool.next_item = 0;
+	pool.stop = 0;
+	pool.error = 0;
+	if (number_of_items == 0)
+		return 0;
+	threads = parallel_threads(threads);
+	if ((QWORD)threads > number_of_items)
+		threads = (int)number_of_items;
+
+	for (i = 0; i < threads; ++i) {
+		thread[i].pool = &pool;
+		thread[i].worker = i;
+	}
+	for (started = 1; started < threads; ++started)
+		if (pthread_create(&id[started], NULL, pool_run, &thread[started]) != 0)
+			break;
+	// the calling thread is worker 0, so the items are run even if no thread could be started
+	pool_run(&thread[0]);
+	for (i = 1; i < started; ++i)
+		pthread_join(id[i], NULL);
+
+	return pool.error ? -1 : 0;
+}
+
+static int job_item(void *arg, int worker, QWORD item)
+{
+	PARALLEL_JOB *job = arg;
+	COUNTERS *counters = (COUNTERS *)(job->counters + worker * job->counters_size);
+	BYTE keyguess[6] = {0x00,0x00,0x00,0x00,0x00,0x00};
+	const BYTE *guess;
+	unsigned int t0 = 0, t1 = 0;
+	int chunk, start, count, g;
+
+	g = (int)(item / job->number_of_chunks);
+	chunk = (int)(item % job->number_of_chunks);
+	start = chunk * PARALLEL_CHUNK_SIZE;
+	count = job->number_of_plains - start;
+	if (count > PARALLEL_CHUNK_SIZE)
+		count = PARALLEL_CHUNK_SIZE;
+
+	if (job->keyguess != NULL) {
+		guess = job->keyguess;
+	}
+	else {
+		// same guesses as algorithm2(), only 6 bits are effective (???? ??00)
+		keyguess[0] = (g << 2) & 0xFC;
+		guess = keyguess;
+	}
+
+	algorithm1(&job->plain[start], job->key, &t0, &t1, count, job->rounds, guess);
+	if ((t0 == -1) && (t1 == -1))
+		return -1;
+	counters[g].count_T0 += t0;
+	counters[g].count_T1 += t1;
+	return 0;
+}
+
+// Runs the job on "threads" threads and sums the per-thread counters into count_T0/count_T1
+static int run_job(PARALLEL_JOB *job, unsigned int count_T0[], unsigned int count_T1[], int threads)
+{
+	COUNTERS *counters;
+	int i, g, error;
+
+	job->number_of_chunks = (job->number_of_plains + PARALLEL_CHUNK_SIZE - 1) / PARALLEL_CHUNK_SIZE;
+	job->counters_size = (job->keyguesses * sizeof(COUNTERS) + CACHE_LINE_SIZE - 1) & ~(size_t)(CACHE_LINE_SIZE - 1);
+	threads = parallel_threads(threads);
+	job->counters = aligned_alloc(CACHE_LINE_SIZE, threads * job->counters_size);
+	if (job->counters == NULL)
+		return -1;
+	memset(job->counters, 0, threads * job->counters_size);
+
+	error = parallel_run(job_item, job, (QWORD)job->number_of_chunks * job->keyguesses, threads);
+
+	for (i = 0; i < threads; ++i) {
+		counters = (COUNTERS *)(job->counters + i * job->counters_size);
+		for (g = 0; g < job->keyguesses; ++g) {
+			count_T0[g] += counters[g].count_T0;
+			count_T1[g] += counters[g].count_T1;
+		}
+	}
+	free(job->counters);
+	return error;
+}
+
+void algorithm1_parallel(const BYTE plain[][DES_BLOCK_SIZE], const BYTE key[][6], unsigned int* count_T0, unsigned int* count_T1, int number_of_plains, int rounds, const BYTE keyguess[], int threads)
+{
+	PARALLEL_JOB job;
+
+	job.plain = plain;
+	job.key = key;
+	job.keyguess = keyguess;
+	job.number_of_plains = number_of_plains;
+	job.rounds = rounds;
+	job.keyguesses = 1;
+
+	if (run_job(&job, count_T0, count_T1, threads) != 0) {
+		*count_T0 = -1;
+		*count_T1 = -1;
+	}
+}
+
+int algorithm2_parallel(const BYTE plain[][DES_BLOCK_SIZE], const BYTE keyschedule[][6], BYTE key8bits[], unsigned int count_T0[], unsigned int count_T1[], int number_of_plains, int keyguesses, int threads)
+{
+	PARALLEL_JOB job;
+	int correct_keyguess;
+	STATS_TIMER(timer);
+
+	STATS_BEGIN(timer);
+	job.plain = plain;
+	job.key = keyschedule;
+	job.keyguess = NULL;
+	job.number_of_plains = number_of_plains;
+	job.rounds = 8;
+	job.keyguesses = keyguesses;
+
+	memset(count_T0, 0, keyguesses * sizeof(unsigned int));
+	memset(count_T1, 0, keyguesses * sizeof(unsigned int));
+	if (run_job(&job, count_T0, count_T1, threads) != 0) {
+		// the counts of a failed job are not used, no blocks are reported for it
+		STATS_END(STATS_ALGORITHM2, timer, 0, 0, 0);
+		return -1;
+	}
+
+	correct_keyguess = select_keyguess(key8bits, count_T0, count_T1, keyguesses);
+	STATS_END(STATS_ALGORITHM2, timer, (QWORD)number_of_plains * keyguesses, keyguesses, 0);
+	return correct_keyguess;
+}
@@ -0,0 +1,36 @@
+/*********************************************************************
+* Filename:   des_parallel.h
+* Copyright:
+* Disclaimer: This code is presented "as is" without any guarantees.
+* Details:    Defines the API for the multi-threaded versions of
+              algorithm 1 and algorithm 2. The counts are the same as
+              the ones of the serial functions in des.c. parallel_run()
+              is the worker pool all multi-threaded parts use.
+*********************************************************************/
+
+#ifndef DES_PARALLEL_H
+#define DES_PARALLEL_H
+
+/*************************** HEADER FILES ***************************/
+#include "des.h"
+
+/****************************** MACROS ******************************/
+#define CACHE_LINE_SIZE 64
+#define PARALLEL_CHUNK_SIZE 16384       // plaintexts per work item
+#define PARALLEL_MAX_THREADS 256
+
+/**************************** DATA TYPES ****************************/
+// Runs work item "item" on thread "worker" (0 .. threads-1, the calling thread is 0).
+// Returns 0 to go on, a negative value for an error and a positive value to start no more items.
+typedef int (*PARALLEL_ITEM_FUNC)(void *arg, int worker, QWORD item);
+
+/*********************** FUNCTION DECLARATIONS **********************/
+// threads = 0 uses one thread per online core
+int parallel_threads(int threads);
+// Runs the items 0 .. number_of_items-1 on at most parallel_threads(threads) threads, every thread
+// takes the next item with an atomic add. Returns -1 if an item failed, 0 otherwise.
+int parallel_run(PARALLEL_ITEM_FUNC func, void *arg, QWORD number_of_items, int threads);
+void algorithm1_parallel(const BYTE plain[][DES_BLOCK_SIZE], const BYTE key[][6], unsigned int* count_T0, unsigned int* count_T1, int number_of_plains, int rounds, const BYTE keyguess[], int threads);
+int algorithm2_parallel(const BYTE plain[][DES_BLOCK_SIZE], const BYTE keyschedule[][6], BYTE key8bits[], unsigned int count_T0[], unsigned int count_T1[], int number_of_plains, int keyguesses, int threads);
+
+#endif   // DES_PARALLEL_H
@@ -0,0 +1,397 @@
+/*********************************************************************
+* Filename:   des_rainbow.c
+* Copyright:
+* Disclaimer: This code is presented "as is" without any guarantees.
+* Details:    Rainbow tables over reduced DES key spaces. The chains
+              are computed in parallel with the table-driven key setup
+              and des_crypt, then sorted by their end and written to a
+              file that is mapped for the lookups. A lookup walks every
+              column from the last one to the first, looks the end up
+              with a binary search and regenerates the chain from its
+              start to check the key.
+*********************************************************************/
+
+/*************************** HEADER FILES ***************************/
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "des_rainbow.h"
+#include "des_linear.h"
+#include "des_parallel.h"
+#include "des_table.h"
+
+/**************************** DATA TYPES ****************************/
+typedef struct {
+	QWORD end;
+	WORD start;
+} RAINBOW_ENTRY;
+
+// The parameters of one set of tables
+typedef struct {
+	BYTE plain[DES_BLOCK_SIZE];
+	QWORD base_key;
+	QWORD key_mask;                     // the searched key bits
+	QWORD index_mask;                   // 2^key_bits - 1
+	int rounds;
+	int chain_length;
+} RAINBOW_CHAIN;
+
+typedef struct {
+	const RAINBOW_CHAIN *chain;
+	RAINBOW_ENTRY *entry;
+	int chains_per_table;
+	int chunks_per_table;
+} RAINBOW_JOB;
+
+_Static_assert(sizeof(RAINBOW_HEADER) == RAINBOW_HEADER_SIZE, "the header has to be RAINBOW_HEADER_SIZE bytes");
+
+/*********************** FUNCTION DEFINITIONS ***********************/
+static double seconds_since(const struct timespec *start)
+{
+	struct timespec now;
+
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return (now.tv_sec - start->tv_sec) + (now.tv_nsec - start->tv_nsec) / 1e9;
+}
+
+static void qword_to_block(QWORD word, BYTE block[])
+{
+	int i;
+
+	for (i = DES_BLOCK_SIZE - 1; i >= 0; --i, word >>= 8)
+		block[i] = word & 0xFF;
+}
+
+// 7 bits of the index per key byte, the lowest bit of a byte is the parity bit
+static QWORD spread_index(QWORD index)
+{
+	QWORD key = 0;
+	int g;
+
+	for (g = 0; g < 8; ++g)
+		key |= ((index >> (7 * g)) & 0x7F) << (8 * g + 1);
+	return key;
+}
+
+QWORD rainbow_key(QWORD base_key, int key_bits, QWORD index)
+{
+	QWORD index_mask = (key_bits >= 64) ? ~0ULL : (1ULL << key_bits) - 1;
+
+	return (base_key & ~spread_index(index_mask)) | spread_index(index & index_mask);
+}
+
+static void chain_setup(RAINBOW_CHAIN *chain, const BYTE plain[], QWORD base_key, int key_bits, int rounds, int chain_length)
+{
+	memcpy(chain->plain, plain, DES_BLOCK_SIZE);
+	chain->index_mask = (1ULL << key_bits) - 1;
+	chain->key_mask = spread_index(chain->index_mask);
+	chain->base_key = base_key & ~chain->key_mask;
+	chain->rounds = rounds;
+	chain->chain_length = chain_length;
+}
+
+static QWORD chain_encrypt(const RAINBOW_CHAIN *chain, QWORD index)
+{
+	BYTE key[DES_BLOCK_SIZE], out[DES_BLOCK_SIZE], schedule[16][6];
+
+	qword_to_block(chain->base_key | spread_index(index), key);
+	des_key_setup_table(key, schedule, DES_ENCRYPT, chain->rounds);
+	des_crypt_table(chain->plain, out, (const BYTE (*)[6])schedule, chain->rounds);
+	return block_to_qword(out);
+}
+
+// The ciphertext mixed with the column and the table, the low bits are the next key index
+static QWORD chain_reduce(const RAINBOW_CHAIN *chain, QWORD cipher, int table, int column)
+{
+	QWORD x = cipher ^ (((QWORD)table << 32) | (QWORD)column);
+
+	x ^= x >> 31;
+	x *= 0x9E3779B97F4A7C15ULL;
+	x ^= x >> 29;
+	return x & chain->index_mask;
+}
+
+// Key index of the chain from "index" in column "from" after the columns from .. to-1
+static QWORD chain_walk(const RAINBOW_CHAIN *chain, QWORD index, int table, int from, int to)
+{
+	int column;
+
+	for (column = from; column < to; ++column)
+		index = chain_reduce(chain, chain_encrypt(chain, index), table, column);
+	return index;
+}
+
+double rainbow_coverage(int key_bits, int chain_length, QWORD chains_per_table, int number_of_tables)
+{
+	double keys = ldexp(1.0, key_bits);
+	double distinct, missed, table_missed;
+	int column;
+
+	// every column holds a random subset of about "distinct" keys, the next column the
+	// images of them under a random function
+	table_missed = 1;
+	distinct = (double)chains_per_table;
+	for (column = 0; column < chain_length; ++column) {
+		table_missed *= 1 - distinct / keys;
+		distinct = keys * (1 - exp(-distinct / keys));
+	}
+	missed = pow(table_missed, number_of_tables);
+	return 1 - missed;
+}
+
+double rainbow_table_coverage(int key_bits, int chain_length, const QWORD offset[], int number_of_tables)
+{
+	double keys = ldexp(1.0, key_bits);
+	double missed = 1;
+	int t;
+
+	// the chains left in a table never share a key in the same column, so every column
+	// holds exactly as many distinct keys as the table has distinct ends
+	for (t = 0; t < number_of_tables; ++t)
+		missed *= pow(1 - (double)(offset[t + 1] - offset[t]) / keys, chain_length);
+	return 1 - missed;
+}
+
+// Walks the chains of chunk "item", the chunks of table t come before the ones of table t+1
+static int rainbow_chunk(void *arg, int worker, QWORD item)
+{
+	RAINBOW_JOB *job = arg;
+	RAINBOW_ENTRY *entry;
+	int table, start, count, j;
+
+	table = (int)item / job->chunks_per_table;
+	start = ((int)item % job->chunks_per_table) * RAINBOW_CHUNK_SIZE;
+	count = job->chains_per_table - start;
+	if (count > RAINBOW_CHUNK_SIZE)
+		count = RAINBOW_CHUNK_SIZE;
+	entry = &job->entry[(size_t)table * job->chains_per_table + start];
+	for (j = 0; j < count; ++j) {
+		entry[j].start = start + j;
+		entry[j].end = chain_walk(job->chain, start + j, table, 0, job->chain->chain_length);
+	}
+	return 0;
+}
+
+static int compare_entries(const void *a, const void *b)
+{
+	const RAINBOW_ENTRY *x = a, *y = b;
+
+	if (x->end != y->end)
+		return (x->end < y->end) ? -1 : 1;
+	return (x->start < y->start) ? -1 : (x->start > y->start);
+}
+
+static size_t rainbow_size(int number_of_tables, QWORD number_of_entries)
+{
+	return RAINBOW_HEADER_SIZE + (number_of_tables + 1) * sizeof(QWORD) + number_of_entries * (sizeof(QWORD) + sizeof(WORD));
+}
+
+int rainbow_build(const char *filename, const BYTE plain[], QWORD base_key, int key_bits, int rounds, int chain_length,
+                  int chains_per_table, int number_of_tables, int threads, RAINBOW_BUILD_STATS *stats)
+{
+	RAINBOW_CHAIN chain;
+	RAINBOW_JOB job;
+	RAINBOW_HEADER *header;
+	RAINBOW_ENTRY *entry;
+	QWORD offset[RAINBOW_MAX_TABLES + 1], *end;
+	WORD *start;
+	struct timespec begin;
+	size_t size, n, i, first;
+	BYTE *map;
+	int fd, t, result = 0;
+
+	if (rounds < 1 || rounds > 16 || key_bits < 1 || key_bits > 56 || chain_length < 1 || chain_length > 0xFFFF
+	    || chains_per_table < 1 || (QWORD)chains_per_table > (1ULL << key_bits)
+	    || number_of_tables < 1 || number_of_tables > RAINBOW_MAX_TABLES)
+		return -1;
+	entry = malloc((size_t)number_of_tables * chains_per_table * sizeof(RAINBOW_ENTRY));
+	if (entry == NULL)
+		return -1;
+	clock_gettime(CLOCK_MONOTONIC, &begin);
+
+	chain_setup(&chain, plain, base_key, key_bits, rounds, chain_length);
+	job.chain = &chain;
+	job.entry = entry;
+	job.chains_per_table = chains_per_table;
+	job.chunks_per_table = (chains_per_table + RAINBOW_CHUNK_SIZE - 1) / RAINBOW_CHUNK_SIZE;
+	parallel_run(rainbow_chunk, &job, (QWORD)job.chunks_per_table * number_of_tables, threads);
+
+	// sort every table by the ends and keep one chain of the ones that merged
+	n = 0;
+	for (t = 0; t < number_of_tables; ++t) {
+		first = (size_t)t * chains_per_table;
+		qsort(&entry[first], chains_per_table, sizeof(RAINBOW_ENTRY), compare_entries);
+		offset[t] = n;
+		for (i = first; i < first + chains_per_table; ++i) {
+			if (i == first || entry[i].end != entry[i - 1].end)
+				entry[n++] = entry[i];
+		}
+	}
+	offset[number_of_tables] = n;
+
+	size = rainbow_size(number_of_tables, n);
+	fd = open(filename, O_RDWR | O_CREAT | O_TRUNC, 0644);
+	if (fd < 0 || ftruncate(fd, size) != 0) {
+		if (fd >= 0)
+			close(fd);
+		free(entry);
+		return -1;
+	}
+	map = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	close(fd);
+	if (map == MAP_FAILED) {
+		free(entry);
+		return -1;
+	}
+
+	header = (RAINBOW_HEADER *)map;
+	memset(header, 0, sizeof(RAINBOW_HEADER));
+	memcpy(header->magic, RAINBOW_MAGIC, sizeof(header->magic));
+	header->rounds = rounds;
+	header->key_bits = key_bits;
+	header->chain_length = chain_length;
+	header->number_of_tables = number_of_tables;
+	memcpy(header->plain, plain, DES_BLOCK_SIZE);
+	header->base_key = chain.base_key;
+	header->chains_per_table = chains_per_table;
+	header->number_of_entries = n;
+	memcpy(map + RAINBOW_HEADER_SIZE, offset, (number_of_tables + 1) * sizeof(QWORD));
+	end = (QWORD *)(map + RAINBOW_HEADER_SIZE + (number_of_tables + 1) * sizeof(QWORD));
+	start = (WORD *)(end + n);
+	for (i = 0; i < n; ++i) {
+		end[i] = entry[i].end;
+		start[i] = entry[i].start;
+	}
+	free(entry);
+
+	if (msync(map, size, MS_SYNC) != 0)
+		result = -1;
+	munmap(map, size);
+
+	if (stats != NULL) {
+		stats->encryptions = (QWORD)number_of_tables * chains_per_table * chain_length;
+		stats->number_of_entries = n;
+		stats->coverage = rainbow_table_coverage(key_bits, chain_length, offset, number_of_tables);
+		stats->seconds = seconds_since(&begin);
+	}
+	return result;
+}
+
+int rainbow_open(const char *filename, RAINBOW_TABLE *table)
+{
+	const RAINBOW_HEADER *header;
+	const QWORD *offset;
+	struct stat st;
+	void *map;
+	int fd, t;
+
+	memset(table, 0, sizeof(RAINBOW_TABLE));
+	fd = open(filename, O_RDONLY);
+	if (fd < 0)
+		return -1;
+	if (fstat(fd, &st) != 0 || st.st_size < RAINBOW_HEADER_SIZE) {
+		close(fd);
+		return -1;
+	}
+	map = mmap(NULL, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+	close(fd);
+	if (map == MAP_FAILED)
+		return -1;
+
+	header = map;
+	offset = (const QWORD *)((const BYTE *)map + RAINBOW_HEADER_SIZE);
+	if (memcmp(header->magic, RAINBOW_MAGIC, sizeof(header->magic)) != 0 || header->rounds < 1 || header->rounds > 16
+	    || header->key_bits < 1 || header->key_bits > 56 || header->chain_length < 1
+	    || header->number_of_tables < 1 || header->number_of_tables > RAINBOW_MAX_TABLES
+	    || header->number_of_entries > (QWORD)header->number_of_tables * header->chains_per_table
+	    || rainbow_size(header->number_of_tables, header->number_of_entries) != (size_t)st.st_size)
+		goto invalid;
+	for (t = 0; t < header->number_of_tables; ++t) {
+		if (offset[t] > offset[t + 1])
+			goto invalid;
+	}
+	if (offset[0] != 0 || offset[header->number_of_tables] != header->number_of_entries)
+		goto invalid;
+
+	table->header = header;
+	table->offset = offset;
+	table->end = offset + header->number_of_tables + 1;
+	table->start = (const WORD *)(table->end + header->number_of_entries);
+	table->map = map;
+	table->size = st.st_size;
+	return 0;
+
+invalid:
+	munmap(map, st.st_size);
+	return -1;
+}
+
+void rainbow_close(RAINBOW_TABLE *table)
+{
+	if (table->map != NULL)
+		munmap(table->map, table->size);
+	memset(table, 0, sizeof(RAINBOW_TABLE));
+}
+
+// Position of "end" in the ends of table t or -1
+static long long find_end(const RAINBOW_TABLE *table, int t, QWORD end)
+{
+	QWORD low = table->offset[t], high = table->offset[t + 1], middle;
+
+	while (low < high) {
+		middle = low + (high - low) / 2;
+		if (table->end[middle] < end)
+			low = middle + 1;
+		else
+			high = middle;
+	}
+	return (low < table->offset[t + 1] && table->end[low] == end) ? (long long)low : -1;
+}
+
+int rainbow_lookup(const RAINBOW_TABLE *table, const BYTE cipher[], BYTE key[], RAINBOW_LOOKUP_STATS *stats)
+{
+	const RAINBOW_HEADER *header = table->header;
+	RAINBOW_CHAIN chain;
+	struct timespec begin;
+	QWORD c = block_to_qword(cipher), encryptions = 0, false_alarms = 0, index;
+	long long position;
+	int column, t, found = 0;
+
+	clock_gettime(CLOCK_MONOTONIC, &begin);
+	chain_setup(&chain, header->plain, header->base_key, header->key_bits, header->rounds, header->chain_length);
+
+	// the short walks of the last columns first, for every table
+	for (column = header->chain_length - 1; column >= 0 && !found; --column) {
+		for (t = 0; t < header->number_of_tables && !found; ++t) {
+			index = chain_walk(&chain, chain_reduce(&chain, c, t, column), t, column + 1, header->chain_length);
+			encryptions += header->chain_length - 1 - column;
+			position = find_end(table, t, index);
+			if (position < 0)
+				continue;
+			// the key of column "column" of the stored chain
+			index = chain_walk(&chain, table->start[position], t, 0, column);
+			encryptions += column + 1;
+			if (chain_encrypt(&chain, index) == c) {
+				qword_to_block(chain.base_key | spread_index(index), key);
+				found = 1;
+			}
+			else {
+				++false_alarms;
+			}
+		}
+	}
+
+	if (stats != NULL) {
+		++stats->lookups;
+		stats->found += found;
+		stats->encryptions += encryptions;
+		stats->false_alarms += false_alarms;
+		stats->seconds += seconds_since(&begin);
+	}
+	return found;
+}
@@ -0,0 +1,89 @@
+/*********************************************************************
+* Filename:   des_rainbow.h
+* Copyright:
+* Disclaimer: This code is presented "as is" without any guarantees.
+* Details:    Defines the API for the rainbow tables over DES keys
+              with a reduced key space. Only the lowest key_bits of the
+              56 key bits vary (7 per key byte, from the last byte on),
+              the other bits are the ones of a fixed base key. A chain
+              step encrypts the chosen plaintext under the key and
+              reduces the ciphertext to the next key with a function
+              of the column and the table. A master key is handled as a
+              64-bit word like in des_linear.h.
+*********************************************************************/
+
+#ifndef DES_RAINBOW_H
+#define DES_RAINBOW_H
+
+/*************************** HEADER FILES ***************************/
+#include <stddef.h>
+#include "des.h"
+
+/****************************** MACROS ******************************/
+#define RAINBOW_MAGIC "DESRT01"         // with the terminating 0 the 8 magic bytes
+#define RAINBOW_HEADER_SIZE 64
+#define RAINBOW_MAX_TABLES 256
+#define RAINBOW_CHUNK_SIZE 1024         // chains per work item of rainbow_build()
+
+/**************************** DATA TYPES ****************************/
+// The file is the header, QWORD offset[number_of_tables + 1] (first entry of every table),
+// QWORD end[number_of_entries] sorted within every table and WORD start[number_of_entries].
+// Chains that merged into the same end are only stored once.
+typedef struct {
+	char magic[8];
+	WORD rounds;
+	WORD key_bits;
+	WORD chain_length;
+	WORD number_of_tables;
+	BYTE plain[DES_BLOCK_SIZE];         // the chosen plaintext
+	QWORD base_key;                     // the key bits that are not searched
+	QWORD chains_per_table;             // before merged chains were removed
+	QWORD number_of_entries;
+	BYTE padding[RAINBOW_HEADER_SIZE - 56];
+} RAINBOW_HEADER;
+
+typedef struct {
+	const RAINBOW_HEADER *header;
+	const QWORD *offset;
+	const QWORD *end;
+	const WORD *start;
+	void *map;
+	size_t size;
+} RAINBOW_TABLE;
+
+typedef struct {
+	QWORD encryptions;
+	QWORD number_of_entries;            // distinct ends of all tables
+	double coverage;                    // rainbow_table_coverage() of the tables written
+	double seconds;
+} RAINBOW_BUILD_STATS;
+
+// Added up over all lookups made with the same stats
+typedef struct {
+	QWORD lookups;
+	QWORD found;
+	QWORD encryptions;
+	QWORD false_alarms;                 // chains regenerated without finding the key
+	double seconds;
+} RAINBOW_LOOKUP_STATS;
+
+/*********************** FUNCTION DECLARATIONS **********************/
+// The master key of the key index "index" (< 2^key_bits)
+QWORD rainbow_key(QWORD base_key, int key_bits, QWORD index);
+// Probability that a key is in one of the tables, from the expected number of distinct keys
+// in every column. rainbow_build() drops the chains that merged and with them the keys
+// before the merge, so this is an upper bound for the tables it writes.
+double rainbow_coverage(int key_bits, int chain_length, QWORD chains_per_table, int number_of_tables);
+// Coverage of built tables from the distinct ends of every table (offset[] of the file)
+double rainbow_table_coverage(int key_bits, int chain_length, const QWORD offset[], int number_of_tables);
+// Builds the tables in parallel and writes them to the file, the start of chain j is key index j
+int rainbow_build(const char *filename, const BYTE plain[], QWORD base_key, int key_bits, int rounds, int chain_length,
+                  int chains_per_table, int number_of_tables, int threads, RAINBOW_BUILD_STATS *stats);
+// Maps a table file, returns -1 if it cannot be read or is no valid table file
+int rainbow_open(const char *filename, RAINBOW_TABLE *table);
+void rainbow_close(RAINBOW_TABLE *table);
+// Searches the key that encrypts the plaintext of the tables to "cipher", returns 1 and the key
+// if it was found or 0, stats may be NULL
+int rainbow_lookup(const RAINBOW_TABLE *table, const BYTE cipher[], BYTE key[], RAINBOW_LOOKUP_STATS *stats);
+
+#endif   // DES_RAINBOW_H
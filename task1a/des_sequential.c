@@ -0,0 +1,123 @@
+/*********************************************************************
+* Filename:   des_sequential.c
+* Copyright:
+* Disclaimer: This code is presented "as is" without any guarantees.
+* Details:    Early-stopping algorithm 1 and algorithm 2. Algorithm 1
+              uses Wald's test: the log likelihood ratio of the two
+              right sides after T0 + T1 texts is (T0 - T1) ln((1 + 2e) /
+              (1 - 2e)), so the test is a threshold on |T0 - T1|.
+              For algorithm 2 T0 - T1 of a wrong key guess is about
+              normal with the standard deviation sqrt(n), the search
+              stops when the best guess leaves the interval that holds
+              all wrong guesses with the probability 1 - error. The
+              error is also spread over all tests that may be made.
+              The tests are only made at chunk boundaries.
+*********************************************************************/
+
+/*************************** HEADER FILES ***************************/
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "des_sequential.h"
+#include "des_stats.h"
+
+/*********************** FUNCTION DEFINITIONS ***********************/
+static int chunk_size(const SEQUENTIAL_TEST *test)
+{
+	return (test->chunk_size > 0) ? test->chunk_size : SEQUENTIAL_CHUNK_SIZE;
+}
+
+// z with P(N(0,1) > z) = q
+static double normal_quantile(double q)
+{
+	double low = -40, high = 40, z;
+	int i;
+
+	for (i = 0; i < 100; ++i) {
+		z = (low + high) / 2;
+		if (0.5 * erfc(z / sqrt(2.0)) > q)
+			low = z;
+		else
+			high = z;
+	}
+	return (low + high) / 2;
+}
+
+double sequential_threshold(const SEQUENTIAL_TEST *test)
+{
+	return log((1 - test->error) / test->error) / log((1 + 2 * test->bias) / (1 - 2 * test->bias));
+}
+
+int algorithm1_sequential(const BYTE plain[][DES_BLOCK_SIZE], const BYTE key[][6], unsigned int* count_T0, unsigned int* count_T1, int number_of_plains,
+                          int rounds, const BYTE keyguess[], const SEQUENTIAL_TEST *test, SEQUENTIAL_RESULT *result)
+{
+	double threshold = sequential_threshold(test);
+	int done, batch;
+
+	result->stopped = 0;
+	for (done = 0; done < number_of_plains; done += batch) {
+		batch = number_of_plains - done;
+		if (batch > chunk_size(test))
+			batch = chunk_size(test);
+		algorithm1(&plain[done], key, count_T0, count_T1, batch, rounds, keyguess);
+		if ((*count_T0 == -1) && (*count_T1 == -1))
+			return -1;
+		if (fabs((double)*count_T0 - (double)*count_T1) >= threshold) {
+			result->stopped = (done + batch < number_of_plains);
+			done += batch;
+			break;
+		}
+	}
+	result->number_of_plains = done;
+	return (*count_T0 > *count_T1) ? 0 : 1;
+}
+
+int algorithm2_sequential(const BYTE plain[][DES_BLOCK_SIZE], const BYTE keyschedule[][6], BYTE key8bits[], unsigned int count_T0[], unsigned int count_T1[],
+                          int number_of_plains, int keyguesses, const SEQUENTIAL_TEST *test, SEQUENTIAL_RESULT *result)
+{
+	BYTE (*cipher)[DES_BLOCK_SIZE];
+	unsigned int counter[ALGORITHM2_COUNTER_SIZE];
+	int tests = (number_of_plains + chunk_size(test) - 1) / chunk_size(test);
+	double z = normal_quantile(test->error / (2.0 * ((keyguesses > 1) ? keyguesses - 1 : 1) * ((tests > 1) ? tests : 1)));
+	double d, best;
+	int done, batch, i, correct_keyguess;
+	STATS_TIMER(timer);
+
+	STATS_BEGIN(timer);
+	cipher = malloc((size_t)chunk_size(test) * DES_BLOCK_SIZE);
+	if (cipher == NULL || keyguesses < 2) {
+		STATS_END(STATS_ALGORITHM2, timer, 0, 0, 0);
+		free(cipher);
+		return -1;
+	}
+	memset(counter, 0, sizeof(counter));
+	result->stopped = 0;
+
+	for (done = 0; done < number_of_plains; done += batch) {
+		batch = number_of_plains - done;
+		if (batch > chunk_size(test))
+			batch = chunk_size(test);
+		// 8 rounds are always valid, the encryption can't fail
+		encrypt_plaintexts(&plain[done], cipher, keyschedule, batch, 8);
+		compress_pairs(&plain[done], (const BYTE (*)[DES_BLOCK_SIZE])cipher, counter, batch);
+
+		evaluate_keyguesses(counter, count_T0, count_T1, keyguesses);
+		for (i = 0, best = 0; i < keyguesses; ++i) {
+			d = fabs((double)count_T0[i] - (double)count_T1[i]);
+			best = (d > best) ? d : best;
+		}
+		if (best >= z * sqrt((double)(done + batch))) {
+			result->stopped = (done + batch < number_of_plains);
+			done += batch;
+			break;
+		}
+	}
+	free(cipher);
+
+	result->number_of_plains = done;
+	if (done == 0)
+		evaluate_keyguesses(counter, count_T0, count_T1, keyguesses);
+	correct_keyguess = select_keyguess(key8bits, count_T0, count_T1, keyguesses);
+	STATS_END(STATS_ALGORITHM2, timer, done, keyguesses, (QWORD)chunk_size(test) * DES_BLOCK_SIZE);
+	return correct_keyguess;
+}
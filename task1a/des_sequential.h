@@ -0,0 +1,47 @@
+/*********************************************************************
+* Filename:   des_sequential.h
+* Copyright:
+* Disclaimer: This code is presented "as is" without any guarantees.
+* Details:    Defines the API for the early-stopping versions of
+              algorithm 1 and algorithm 2. The texts are counted chunk
+              by chunk and after every chunk a test on the running
+              counts decides whether enough texts were seen. The counts
+              and guesses are the ones of the serial functions on the
+              texts used so far.
+*********************************************************************/
+
+#ifndef DES_SEQUENTIAL_H
+#define DES_SEQUENTIAL_H
+
+/*************************** HEADER FILES ***************************/
+#include "des.h"
+
+/****************************** MACROS ******************************/
+#define SEQUENTIAL_CHUNK_SIZE 4096      // texts between two tests if the test gives none
+
+/**************************** DATA TYPES ****************************/
+typedef struct {
+	double bias;                        // design bias |p - 1/2| of the approximation
+	double error;                       // allowed probability of a wrong decision
+	int chunk_size;                     // texts between two tests, 0 for SEQUENTIAL_CHUNK_SIZE
+} SEQUENTIAL_TEST;
+
+typedef struct {
+	int number_of_plains;               // texts counted up to the decision
+	int stopped;                        // 1 if the test decided before all texts were used
+} SEQUENTIAL_RESULT;
+
+/*********************** FUNCTION DECLARATIONS **********************/
+// |T0 - T1| at which Wald's sequential probability ratio test between the right sides 0
+// (p = 1/2 + bias) and 1 (p = 1/2 - bias) decides
+double sequential_threshold(const SEQUENTIAL_TEST *test);
+// algorithm1() that stops once |T0 - T1| reaches sequential_threshold(), returns the right
+// side (0 if T0 > T1 like the attacks in des_test.c) or -1 for other round counts
+int algorithm1_sequential(const BYTE plain[][DES_BLOCK_SIZE], const BYTE key[][6], unsigned int* count_T0, unsigned int* count_T1, int number_of_plains,
+                          int rounds, const BYTE keyguess[], const SEQUENTIAL_TEST *test, SEQUENTIAL_RESULT *result);
+// algorithm2_cached() that stops once |T0 - T1| of the best key guess is outside the confidence
+// interval of the wrong guesses for the error probability (spread over all wrong guesses)
+int algorithm2_sequential(const BYTE plain[][DES_BLOCK_SIZE], const BYTE keyschedule[][6], BYTE key8bits[], unsigned int count_T0[], unsigned int count_T1[],
+                          int number_of_plains, int keyguesses, const SEQUENTIAL_TEST *test, SEQUENTIAL_RESULT *result);
+
+#endif   // DES_SEQUENTIAL_H
@@ -0,0 +1,205 @@
+/*********************************************************************
+* Filename:   des_shard.c
+* Copyright:
+* Disclaimer: This code is presented "as is" without any guarantees.
+* Details:    Counting of the 8 round attack for one shard and merging
+              of the counter files. The threads of parallel_run() take
+              the chunks of the shard, every thread counts into its own
+              cache line aligned counters.
+*********************************************************************/
+
+/*************************** HEADER FILES ***************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "des_shard.h"
+#include "des_dataset.h"
+#include "des_parallel.h"
+#include "des_stream.h"
+#include "des_table.h"
+
+/**************************** DATA TYPES ****************************/
+typedef struct {
+	QWORD counter[ALGORITHM2_COUNTER_SIZE];
+	BYTE (*plain)[DES_BLOCK_SIZE];      // SHARD_CHUNK_SIZE plaintexts, then as many ciphertexts
+} __attribute__ ((aligned (CACHE_LINE_SIZE))) SHARD_WORKER;
+
+typedef struct {
+	const BYTE (*key)[6];
+	const BYTE *seed;
+	QWORD first_index;
+	QWORD number_of_texts;
+	SHARD_WORKER *worker;
+} SHARD_JOB;
+
+_Static_assert(sizeof(SHARD_HEADER) == SHARD_HEADER_SIZE, "the header has to be SHARD_HEADER_SIZE bytes");
+
+/*********************** FUNCTION DEFINITIONS ***********************/
+// Encrypts and counts chunk "item" of the shard into the counters of the worker
+static int shard_chunk(void *arg, int thread, QWORD item)
+{
+	SHARD_JOB *job = arg;
+	SHARD_WORKER *worker = &job->worker[thread];
+	BYTE (*plain)[DES_BLOCK_SIZE] = worker->plain, (*cipher)[DES_BLOCK_SIZE] = worker->plain + SHARD_CHUNK_SIZE;
+	unsigned int counter[ALGORITHM2_COUNTER_SIZE];
+	QWORD start = item * SHARD_CHUNK_SIZE;
+	int count, i;
+
+	count = (job->number_of_texts - start < SHARD_CHUNK_SIZE) ? (int)(job->number_of_texts - start) : SHARD_CHUNK_SIZE;
+	counter_plaintexts(job->seed, job->first_index + start, count, plain);
+	if (encrypt_plaintexts((const BYTE (*)[DES_BLOCK_SIZE])plain, cipher, job->key, count, 8) != 0)
+		return -1;
+	memset(counter, 0, sizeof(counter));
+	compress_pairs((const BYTE (*)[DES_BLOCK_SIZE])plain, (const BYTE (*)[DES_BLOCK_SIZE])cipher, counter, count);
+	for (i = 0; i < ALGORITHM2_COUNTER_SIZE; ++i)
+		worker->counter[i] += counter[i];
+	return 0;
+}
+
+int shard_count(QWORD key_id, const BYTE seed[], QWORD first_index, QWORD number_of_texts, int threads, SHARD_COUNTERS *shard)
+{
+	SHARD_JOB job;
+	SHARD_WORKER *worker;
+	BYTE key[DES_BLOCK_SIZE], schedule[8][6];
+	int t, i, error = 0;
+
+	threads = parallel_threads(threads);
+	worker = aligned_alloc(CACHE_LINE_SIZE, threads * sizeof(SHARD_WORKER));
+	if (worker == NULL)
+		return -1;
+	dataset_key(key_id, key);
+	des_key_setup_table(key, schedule, DES_ENCRYPT, 8);
+	job.key = (const BYTE (*)[6])schedule;
+	job.seed = seed;
+	job.first_index = first_index;
+	job.number_of_texts = number_of_texts;
+	job.worker = worker;
+
+	for (t = 0; t < threads; ++t) {
+		memset(&worker[t], 0, sizeof(SHARD_WORKER));
+		worker[t].plain = malloc(2 * SHARD_CHUNK_SIZE * DES_BLOCK_SIZE);
+		if (worker[t].plain == NULL)
+			error = -1;
+	}
+	if (error == 0)
+		error = parallel_run(shard_chunk, &job, (number_of_texts + SHARD_CHUNK_SIZE - 1) / SHARD_CHUNK_SIZE, threads);
+
+	memset(shard, 0, sizeof(SHARD_COUNTERS));
+	for (t = 0; t < threads; ++t) {
+		for (i = 0; i < ALGORITHM2_COUNTER_SIZE; ++i)
+			shard->counter[i] += worker[t].counter[i];
+		free(worker[t].plain);
+	}
+	free(worker);
+
+	memcpy(shard->header.magic, SHARD_MAGIC, sizeof(shard->header.magic));
+	shard->header.rounds = 8;
+	shard->header.buckets = ALGORITHM2_COUNTER_SIZE;
+	shard->header.key_id = key_id;
+	memcpy(shard->header.seed, seed, DES_BLOCK_SIZE);
+	shard->header.first_index = first_index;
+	shard->header.number_of_texts = number_of_texts;
+	return error ? -1 : 0;
+}
+
+int shard_write(const char *filename, const SHARD_COUNTERS *shard)
+{
+	char temporary[4096];
+	FILE *file;
+	int result = 0;
+
+	if (snprintf(temporary, sizeof(temporary), "%s.tmp", filename) >= (int)sizeof(temporary))
+		return -1;
+	file = fopen(temporary, "wb");
+	if (file == NULL)
+		return -1;
+	if (fwrite(shard, sizeof(SHARD_COUNTERS), 1, file) != 1)
+		result = -1;
+	if (fclose(file) != 0)
+		result = -1;
+	if (result == 0 && rename(temporary, filename) != 0)
+		result = -1;
+	if (result != 0)
+		remove(temporary);
+	return result;
+}
+
+int shard_read(const char *filename, SHARD_COUNTERS *shard)
+{
+	FILE *file = fopen(filename, "rb");
+	QWORD sum = 0;
+	int i, result = 0;
+
+	if (file == NULL)
+		return -1;
+	if (fread(shard, sizeof(SHARD_COUNTERS), 1, file) != 1 || fgetc(file) != EOF)
+		result = -1;
+	fclose(file);
+	if (result != 0 || memcmp(shard->header.magic, SHARD_MAGIC, sizeof(shard->header.magic)) != 0
+	    || shard->header.rounds != 8 || shard->header.buckets != ALGORITHM2_COUNTER_SIZE)
+		return -1;
+	// every text is counted once
+	for (i = 0; i < ALGORITHM2_COUNTER_SIZE; ++i)
+		sum += shard->counter[i];
+	return (sum == shard->header.number_of_texts) ? 0 : -1;
+}
+
+static int compare_first_index(const void *a, const void *b)
+{
+	const SHARD_COUNTERS *x = *(const SHARD_COUNTERS * const *)a, *y = *(const SHARD_COUNTERS * const *)b;
+
+	if (x->header.first_index != y->header.first_index)
+		return (x->header.first_index < y->header.first_index) ? -1 : 1;
+	return 0;
+}
+
+int shard_merge(const SHARD_COUNTERS shards[], int number_of_shards, SHARD_COUNTERS *total)
+{
+	const SHARD_COUNTERS **order;
+	QWORD end = 0;
+	int s, i, result = 0;
+
+	if (number_of_shards < 1)
+		return -1;
+	order = malloc(number_of_shards * sizeof(SHARD_COUNTERS *));
+	if (order == NULL)
+		return -1;
+	for (s = 0; s < number_of_shards; ++s)
+		order[s] = &shards[s];
+	qsort(order, number_of_shards, sizeof(SHARD_COUNTERS *), compare_first_index);
+
+	memset(total, 0, sizeof(SHARD_COUNTERS));
+	total->header = order[0]->header;
+	total->header.number_of_texts = 0;
+	for (s = 0; s < number_of_shards; ++s) {
+		if (order[s]->header.key_id != total->header.key_id || memcmp(order[s]->header.seed, total->header.seed, DES_BLOCK_SIZE) != 0
+		    || (s > 0 && order[s]->header.first_index < end)) {
+			result = -1;
+			break;
+		}
+		end = order[s]->header.first_index + order[s]->header.number_of_texts;
+		total->header.number_of_texts += order[s]->header.number_of_texts;
+		for (i = 0; i < ALGORITHM2_COUNTER_SIZE; ++i)
+			total->counter[i] += order[s]->counter[i];
+	}
+	free(order);
+	return result;
+}
+
+int shard_keyguess(const SHARD_COUNTERS *total, KEY_CANDIDATE candidates[64])
+{
+	const BYTE sbox[1] = {1};
+	long long histogram[64];
+	int i;
+
+	if (total->header.number_of_texts == 0)
+		return -1;
+	for (i = 0; i < 64; ++i)
+		histogram[i] = (long long)total->counter[i] - (long long)total->counter[64 + i];
+	// fwht_keyguess() normalizes by an int, so the bias is taken over the QWORD text count here
+	if (fwht_keyguess(histogram, 0x00008000, sbox, 1, 1, candidates) != 0)
+		return -1;
+	for (i = 0; i < 64; ++i)
+		candidates[i].bias /= (double)total->header.number_of_texts;
+	return 0;
+}
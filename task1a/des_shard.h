@@ -0,0 +1,58 @@
+/*********************************************************************
+* Filename:   des_shard.h
+* Copyright:
+* Disclaimer: This code is presented "as is" without any guarantees.
+* Details:    Defines the API for the sharded 8 round attack. A shard
+              is a range of plaintext indices of the counter mode
+              plaintexts of a seed, encrypted under dataset_key(key_id)
+              like the data set files. Every worker process counts its
+              shard into the algorithm 2 histogram (compress_pairs())
+              and writes a counter file, the counter files of all
+              shards are summed and ranked afterwards. The file system
+              is the only coordination between the workers.
+*********************************************************************/
+
+#ifndef DES_SHARD_H
+#define DES_SHARD_H
+
+/*************************** HEADER FILES ***************************/
+#include "des.h"
+#include "des_keyguess.h"
+
+/****************************** MACROS ******************************/
+#define SHARD_MAGIC "DESCNT1"           // with the terminating 0 the 8 magic bytes
+#define SHARD_HEADER_SIZE 64
+#define SHARD_CHUNK_SIZE 65536          // texts per work item of shard_count()
+
+/**************************** DATA TYPES ****************************/
+// A counter file is the header followed by the ALGORITHM2_COUNTER_SIZE QWORD counters
+typedef struct {
+	char magic[8];
+	WORD rounds;
+	WORD buckets;                       // ALGORITHM2_COUNTER_SIZE
+	QWORD key_id;
+	BYTE seed[DES_BLOCK_SIZE];
+	QWORD first_index;                  // texts first_index .. first_index+number_of_texts-1
+	QWORD number_of_texts;
+	BYTE padding[SHARD_HEADER_SIZE - 48];
+} SHARD_HEADER;
+
+typedef struct {
+	SHARD_HEADER header;
+	QWORD counter[ALGORITHM2_COUNTER_SIZE];     // [parity << 6 | S-Box 1 input of round 8]
+} SHARD_COUNTERS;
+
+/*********************** FUNCTION DECLARATIONS **********************/
+// Generates, encrypts and counts the texts of one shard on "threads" threads (0 for all cores)
+int shard_count(QWORD key_id, const BYTE seed[], QWORD first_index, QWORD number_of_texts, int threads, SHARD_COUNTERS *shard);
+// The file is written under a temporary name and renamed, so a complete file means a finished shard
+int shard_write(const char *filename, const SHARD_COUNTERS *shard);
+int shard_read(const char *filename, SHARD_COUNTERS *shard);
+// Sorts the shards by their first index and sums them into total, returns -1 if they are of
+// different keys or seeds or if their ranges overlap. Gaps between the ranges are allowed,
+// total then covers the lowest to the highest index with number_of_texts the texts counted.
+int shard_merge(const SHARD_COUNTERS shards[], int number_of_shards, SHARD_COUNTERS *total);
+// Ranks the 64 guesses for K8 bits 42-47 like the 8 round attack (fwht_keyguess() for S-Box 1)
+int shard_keyguess(const SHARD_COUNTERS *total, KEY_CANDIDATE candidates[64]);
+
+#endif   // DES_SHARD_H
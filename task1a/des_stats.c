@@ -0,0 +1,144 @@
+/*********************************************************************
+* Filename:   des_stats.c
+* Copyright:
+* Disclaimer: This code is presented "as is" without any guarantees.
+* Details:    Phase statistics of the attacks. The counters are added
+              with relaxed atomics because the parallel workers run
+              algorithm 1 at the same time.
+*********************************************************************/
+
+/*************************** HEADER FILES ***************************/
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include "des_stats.h"
+
+/**************************** VARIABLES *****************************/
+static STATS_COUNTERS counters[STATS_PHASES];
+static const char *phase_names[STATS_PHASES] = {"create_plaintexts", "des_key_setup", "algorithm1", "algorithm2"};
+static char dump_filename[256];
+
+/*********************** FUNCTION DEFINITIONS ***********************/
+static QWORD ns_since(const struct timespec *start, const struct timespec *end)
+{
+	return (QWORD)(end->tv_sec - start->tv_sec) * 1000000000ULL + end->tv_nsec - start->tv_nsec;
+}
+
+void stats_begin(STATS_START *start)
+{
+	clock_gettime(CLOCK_MONOTONIC, &start->wall);
+	clock_gettime(CLOCK_THREAD_CPUTIME_ID, &start->cpu);
+}
+
+void stats_end(STATS_PHASE phase, const STATS_START *start, QWORD blocks, QWORD keyguesses, QWORD bytes)
+{
+	STATS_COUNTERS *c = &counters[phase];
+	struct timespec wall, cpu;
+
+	clock_gettime(CLOCK_THREAD_CPUTIME_ID, &cpu);
+	clock_gettime(CLOCK_MONOTONIC, &wall);
+	__atomic_fetch_add(&c->calls, 1, __ATOMIC_RELAXED);
+	__atomic_fetch_add(&c->wall_ns, ns_since(&start->wall, &wall), __ATOMIC_RELAXED);
+	__atomic_fetch_add(&c->cpu_ns, ns_since(&start->cpu, &cpu), __ATOMIC_RELAXED);
+	__atomic_fetch_add(&c->blocks, blocks, __ATOMIC_RELAXED);
+	__atomic_fetch_add(&c->keyguesses, keyguesses, __ATOMIC_RELAXED);
+	__atomic_fetch_add(&c->bytes, bytes, __ATOMIC_RELAXED);
+}
+
+const char *stats_phase_name(STATS_PHASE phase)
+{
+	return ((unsigned int)phase < STATS_PHASES) ? phase_names[phase] : "unknown";
+}
+
+int stats_enabled(void)
+{
+#ifdef DES_STATS
+	return 1;
+#else
+	return 0;
+#endif
+}
+
+void stats_get(STATS_PHASE phase, STATS_COUNTERS *out)
+{
+	out->calls = __atomic_load_n(&counters[phase].calls, __ATOMIC_RELAXED);
+	out->wall_ns = __atomic_load_n(&counters[phase].wall_ns, __ATOMIC_RELAXED);
+	out->cpu_ns = __atomic_load_n(&counters[phase].cpu_ns, __ATOMIC_RELAXED);
+	out->blocks = __atomic_load_n(&counters[phase].blocks, __ATOMIC_RELAXED);
+	out->keyguesses = __atomic_load_n(&counters[phase].keyguesses, __ATOMIC_RELAXED);
+	out->bytes = __atomic_load_n(&counters[phase].bytes, __ATOMIC_RELAXED);
+}
+
+void stats_reset(void)
+{
+	memset(counters, 0, sizeof(counters));
+}
+
+void stats_write_json(FILE *file)
+{
+	STATS_COUNTERS c;
+	int p;
+
+	fprintf(file, "{\n  \"enabled\": %s,\n  \"phases\": [\n", stats_enabled() ? "true" : "false");
+	for (p = 0; p < STATS_PHASES; ++p) {
+		stats_get(p, &c);
+		fprintf(file, "    {\"phase\": \"%s\", \"calls\": %llu, \"wall_seconds\": %.6f, \"cpu_seconds\": %.6f, "
+		        "\"blocks\": %llu, \"keyguesses\": %llu, \"bytes\": %llu}%s\n", phase_names[p], c.calls, c.wall_ns / 1e9,
+		        c.cpu_ns / 1e9, c.blocks, c.keyguesses, c.bytes, (p + 1 < STATS_PHASES) ? "," : "");
+	}
+	fprintf(file, "  ]\n}\n");
+}
+
+static void write_metric(FILE *file, const char *name, const char *help, int seconds, size_t offset)
+{
+	STATS_COUNTERS c;
+	QWORD value;
+	int p;
+
+	fprintf(file, "# HELP des_phase_%s %s\n# TYPE des_phase_%s counter\n", name, help, name);
+	for (p = 0; p < STATS_PHASES; ++p) {
+		stats_get(p, &c);
+		value = *(const QWORD *)((const BYTE *)&c + offset);
+		if (seconds)
+			fprintf(file, "des_phase_%s{phase=\"%s\"} %.9f\n", name, phase_names[p], value / 1e9);
+		else
+			fprintf(file, "des_phase_%s{phase=\"%s\"} %llu\n", name, phase_names[p], value);
+	}
+}
+
+void stats_write_prometheus(FILE *file)
+{
+	write_metric(file, "calls_total", "Calls of the phase.", 0, offsetof(STATS_COUNTERS, calls));
+	write_metric(file, "wall_seconds_total", "Wall time of the calls, summed over all threads.", 1, offsetof(STATS_COUNTERS, wall_ns));
+	write_metric(file, "cpu_seconds_total", "CPU time of the calling threads.", 1, offsetof(STATS_COUNTERS, cpu_ns));
+	write_metric(file, "blocks_total", "Plaintexts generated or blocks encrypted.", 0, offsetof(STATS_COUNTERS, blocks));
+	write_metric(file, "keyguesses_total", "Key guesses evaluated.", 0, offsetof(STATS_COUNTERS, keyguesses));
+	write_metric(file, "bytes_total", "Bytes allocated.", 0, offsetof(STATS_COUNTERS, bytes));
+}
+
+static void dump(void)
+{
+	size_t length = strlen(dump_filename);
+	int prometheus = (length >= 5 && strcmp(&dump_filename[length - 5], ".prom") == 0);
+	FILE *file = (strcmp(dump_filename, "-") == 0) ? stdout : fopen(dump_filename, "w");
+
+	if (file == NULL)
+		return;
+	if (prometheus)
+		stats_write_prometheus(file);
+	else
+		stats_write_json(file);
+	if (file != stdout)
+		fclose(file);
+}
+
+int stats_dump_at_exit(const char *filename)
+{
+	if (filename == NULL || filename[0] == '\0' || strlen(filename) >= sizeof(dump_filename))
+		return -1;
+	// only registered once, a later call just changes the file
+	if (dump_filename[0] == '\0' && atexit(dump) != 0)
+		return -1;
+	strcpy(dump_filename, filename);
+	return 0;
+}
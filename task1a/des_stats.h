@@ -0,0 +1,72 @@
+/*********************************************************************
+* Filename:   des_stats.h
+* Copyright:
+* Disclaimer: This code is presented "as is" without any guarantees.
+* Details:    Defines the API for the phase statistics of the attacks.
+              The plaintext generation, des_key_setup(), algorithm 1
+              and algorithm 2 add their calls, wall and CPU time,
+              encrypted blocks, evaluated key guesses and allocated
+              bytes to global counters. The counters are only updated
+              if DES_STATS is defined at compile time, otherwise the
+              STATS_* macros compile to nothing. Phases can nest (the
+              algorithm 2 functions run algorithm 1), every phase
+              counts everything inside its calls.
+*********************************************************************/
+
+#ifndef DES_STATS_H
+#define DES_STATS_H
+
+/*************************** HEADER FILES ***************************/
+#include <stdio.h>
+#include <time.h>
+#include "des.h"
+
+/****************************** MACROS ******************************/
+#ifdef DES_STATS
+#define STATS_TIMER(timer) STATS_START timer
+#define STATS_BEGIN(timer) stats_begin(&(timer))
+#define STATS_END(phase, timer, blocks, keyguesses, bytes) stats_end((phase), &(timer), (blocks), (keyguesses), (bytes))
+#else
+#define STATS_TIMER(timer)
+#define STATS_BEGIN(timer) ((void)0)
+#define STATS_END(phase, timer, blocks, keyguesses, bytes) ((void)0)
+#endif
+
+/**************************** DATA TYPES ****************************/
+typedef enum {
+	STATS_PLAINTEXTS,                   // counter_plaintexts(), also under create_plaintexts()
+	STATS_KEY_SETUP,                    // des_key_setup()
+	STATS_ALGORITHM1,
+	STATS_ALGORITHM2,
+	STATS_PHASES
+} STATS_PHASE;
+
+typedef struct {
+	struct timespec wall;
+	struct timespec cpu;                // CPU time of the calling thread
+} STATS_START;
+
+typedef struct {
+	QWORD calls;
+	QWORD wall_ns;
+	QWORD cpu_ns;
+	QWORD blocks;                       // plaintexts generated or blocks encrypted
+	QWORD keyguesses;
+	QWORD bytes;                        // memory allocated for the phase
+} STATS_COUNTERS;
+
+/*********************** FUNCTION DECLARATIONS **********************/
+void stats_begin(STATS_START *start);
+void stats_end(STATS_PHASE phase, const STATS_START *start, QWORD blocks, QWORD keyguesses, QWORD bytes);
+const char *stats_phase_name(STATS_PHASE phase);
+// 1 if the counters are compiled in
+int stats_enabled(void);
+void stats_get(STATS_PHASE phase, STATS_COUNTERS *counters);
+void stats_reset(void);
+void stats_write_json(FILE *file);
+void stats_write_prometheus(FILE *file);
+// Writes the counters when the program exits, as Prometheus text if the file name ends in
+// ".prom", else as JSON. "-" is stdout, NULL does nothing.
+int stats_dump_at_exit(const char *filename);
+
+#endif   // DES_STATS_H
@@ -0,0 +1,174 @@
+/*********************************************************************
+* Filename:   des_stream.c
+* Copyright:
+* Disclaimer: This code is presented "as is" without any guarantees.
+* Details:    Counter mode plaintext generator and producer/consumer
+              pipeline for the plaintexts of the attacks. The producer
+              thread fills the chunk buffers of a ring, the calling
+              thread hands every filled chunk to the consumer function
+              and gives the buffer back afterwards. A failed consumer
+              stops the producer and the stream.
+*********************************************************************/
+
+/*************************** HEADER FILES ***************************/
+#include <stdlib.h>
+#include <pthread.h>
+#include "des_stats.h"
+#include "des_stream.h"
+#include "des_table.h"
+
+/**************************** DATA TYPES ****************************/
+typedef struct {
+	BYTE (*buffer[STREAM_BUFFERS])[DES_BLOCK_SIZE];
+	int count[STREAM_BUFFERS];
+	int head;                           // next buffer to fill
+	int tail;                           // next buffer to consume
+	int filled;
+	int number_of_plains;
+	int stop;                           // the consumer failed, no more buffers are filled
+	BYTE seed[DES_BLOCK_SIZE];
+	pthread_mutex_t lock;
+	pthread_cond_t not_empty;
+	pthread_cond_t not_full;
+} STREAM;
+
+/*********************** FUNCTION DEFINITIONS ***********************/
+void counter_plaintexts(const BYTE seed[], QWORD first_index, int number_of_plains, BYTE plaintexts[][DES_BLOCK_SIZE])
+{
+	BYTE schedule[16][6];
+	QWORD index;
+	int i, k;
+	STATS_TIMER(timer);
+
+	STATS_BEGIN(timer);
+	for(i = 0; i < number_of_plains; i++)
+	{
+		index = first_index + i;
+		for(k = 0; k < DES_BLOCK_SIZE; k++)
+		{
+			plaintexts[i][k] = (index >> (8 * (7 - k))) & 0xFF;
+		}
+	}
+	//every counter block is replaced by its encryption
+	des_key_setup_table(seed, schedule, DES_ENCRYPT, 16);
+	des_crypt_blocks((const BYTE (*)[DES_BLOCK_SIZE])plaintexts, plaintexts, (const BYTE (*)[6])schedule, number_of_plains, 16);
+	STATS_END(STATS_PLAINTEXTS, timer, number_of_plains, 0, 0);
+}
+
+static void *producer_run(void *arg)
+{
+	STREAM *stream = arg;
+	int produced = 0;
+	int count, idx;
+
+	while(produced < stream->number_of_plains)
+	{
+		pthread_mutex_lock(&stream->lock);
+		while(stream->filled == STREAM_BUFFERS && !stream->stop)
+		{
+			pthread_cond_wait(&stream->not_full, &stream->lock);
+		}
+		if(stream->stop)
+		{
+			pthread_mutex_unlock(&stream->lock);
+			break;
+		}
+		idx = stream->head;
+		pthread_mutex_unlock(&stream->lock);
+
+		count = stream->number_of_plains - produced;
+		if(count > STREAM_CHUNK_SIZE)
+		{
+			count = STREAM_CHUNK_SIZE;
+		}
+		counter_plaintexts(stream->seed, produced, count, stream->buffer[idx]);
+		produced += count;
+
+		pthread_mutex_lock(&stream->lock);
+		stream->count[idx] = count;
+		stream->head = (idx + 1) % STREAM_BUFFERS;
+		stream->filled++;
+		pthread_cond_signal(&stream->not_empty);
+		pthread_mutex_unlock(&stream->lock);
+	}
+	return NULL;
+}
+
+int stream_plaintexts(const BYTE seed[], int number_of_plains, STREAM_CONSUMER consume, void *arg)
+{
+	STREAM stream;
+	pthread_t producer;
+	int consumed = 0;
+	int i, idx, result = 0;
+
+	for(i = 0; i < STREAM_BUFFERS; i++)
+	{
+		stream.buffer[i] = malloc(STREAM_CHUNK_SIZE * DES_BLOCK_SIZE);
+		if(stream.buffer[i] == NULL)
+		{
+			while(i-- > 0)
+			{
+				free(stream.buffer[i]);
+			}
+			return -1;
+		}
+	}
+	for(i = 0; i < DES_BLOCK_SIZE; i++)
+	{
+		stream.seed[i] = seed[i];
+	}
+	stream.head = 0;
+	stream.tail = 0;
+	stream.filled = 0;
+	stream.number_of_plains = number_of_plains;
+	stream.stop = 0;
+	pthread_mutex_init(&stream.lock, NULL);
+	pthread_cond_init(&stream.not_empty, NULL);
+	pthread_cond_init(&stream.not_full, NULL);
+
+	if(pthread_create(&producer, NULL, producer_run, &stream) != 0)
+	{
+		pthread_cond_destroy(&stream.not_full);
+		pthread_cond_destroy(&stream.not_empty);
+		pthread_mutex_destroy(&stream.lock);
+		for(i = 0; i < STREAM_BUFFERS; i++)
+		{
+			free(stream.buffer[i]);
+		}
+		return -1;
+	}
+	while(result == 0 && consumed < number_of_plains)
+	{
+		pthread_mutex_lock(&stream.lock);
+		while(stream.filled == 0)
+		{
+			pthread_cond_wait(&stream.not_empty, &stream.lock);
+		}
+		idx = stream.tail;
+		pthread_mutex_unlock(&stream.lock);
+
+		if(consume((const BYTE (*)[DES_BLOCK_SIZE])stream.buffer[idx], stream.count[idx], arg) != 0)
+		{
+			result = -1;
+		}
+		consumed += stream.count[idx];
+
+		pthread_mutex_lock(&stream.lock);
+		stream.tail = (idx + 1) % STREAM_BUFFERS;
+		stream.filled--;
+		//the producer may be waiting for a free buffer
+		stream.stop = (result != 0);
+		pthread_cond_signal(&stream.not_full);
+		pthread_mutex_unlock(&stream.lock);
+	}
+	pthread_join(producer, NULL);
+
+	pthread_cond_destroy(&stream.not_full);
+	pthread_cond_destroy(&stream.not_empty);
+	pthread_mutex_destroy(&stream.lock);
+	for(i = 0; i < STREAM_BUFFERS; i++)
+	{
+		free(stream.buffer[i]);
+	}
+	return result;
+}
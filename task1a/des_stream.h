@@ -0,0 +1,34 @@
+/*********************************************************************
+* Filename:   des_stream.h
+* Copyright:
+* Disclaimer: This code is presented "as is" without any guarantees.
+* Details:    Defines the API for the streaming plaintext pipeline.
+              A producer thread generates the counter mode plaintexts into a
+              fixed ring of chunk buffers while the caller counts the
+              previous chunks, so the memory use does not depend on the
+              number of plaintexts.
+*********************************************************************/
+
+#ifndef DES_STREAM_H
+#define DES_STREAM_H
+
+/*************************** HEADER FILES ***************************/
+#include "des.h"
+
+/****************************** MACROS ******************************/
+#define STREAM_CHUNK_SIZE 65536         // plaintexts per chunk buffer
+#define STREAM_BUFFERS 4                // chunk buffers in the ring
+
+/**************************** DATA TYPES ****************************/
+// Called once per chunk, in plaintext order. Returns 0, anything else stops the stream
+typedef int (*STREAM_CONSUMER)(const BYTE plain[][DES_BLOCK_SIZE], int number_of_plains, void *arg);
+
+/*********************** FUNCTION DECLARATIONS **********************/
+// Plaintext i of a data set is the 16 round DES encryption of the 64-bit index i under
+// the key "seed", so any range of plaintexts can be generated independently
+void counter_plaintexts(const BYTE seed[], QWORD first_index, int number_of_plains, BYTE plaintexts[][DES_BLOCK_SIZE]);
+// Streams the plaintexts 0 .. number_of_plains-1 of the data set "seed". Returns -1 if the
+// stream could not be started or the consumer failed, no chunk is consumed after the failure
+int stream_plaintexts(const BYTE seed[], int number_of_plains, STREAM_CONSUMER consume, void *arg);
+
+#endif   // DES_STREAM_H
@@ -0,0 +1,206 @@
+/*********************************************************************
+* Filename:   des_table.c
+* Copyright:
+* Disclaimer: This code is presented "as is" without any guarantees.
+* Details:    Table-driven DES round function and key schedule. The
+              S-Boxes are combined with the P-Box into SP tables, so
+              f() is eight lookups with the 6 expanded bits of every
+              S-Box. PC-1 and PC-2 are looked up byte by byte (7 bits
+              for PC-2). The tables are computed from the permutations
+              in des.c on first use.
+*********************************************************************/
+
+/*************************** HEADER FILES ***************************/
+#include <pthread.h>
+#include "des_table.h"
+
+/****************************** MACROS ******************************/
+// The 6 expanded bits of the right half "a" that enter S-Box "s" (0..7), a rotation of R
+#define EXPANDED(a,s) ((((a) << ((4*(s)+31) & 31)) | ((a) >> ((33-4*(s)) & 31))) >> 26)
+
+/**************************** VARIABLES *****************************/
+static pthread_once_t tables_once = PTHREAD_ONCE_INIT;
+static WORD sp[8][64];                  // P(S_s(x)) at its place in f()
+static WORD pc1_c[8][256];              // C and D bits (28 bits from bit 31 down) of every key byte
+static WORD pc1_d[8][256];
+static QWORD pc2[8][128];               // subkey bits (48 bits from bit 47 down) of every 7 bits of C and D
+
+/*********************** FUNCTION DEFINITIONS ***********************/
+static void build_tables(void)
+{
+	WORD out, y;
+	int s, x, i, b, v, c;
+
+	for (s = 0; s < 8; ++s) {
+		for (x = 0; x < 64; ++x) {
+			out = (WORD)des_sbox(s + 1, x) << (28 - 4 * s);
+			for (i = 0, y = 0; i < 32; ++i)
+				y |= ((out >> (31 - des_pbox[i])) & 0x01) << (31 - i);
+			sp[s][x] = y;
+		}
+	}
+
+	for (i = 0; i < 8; ++i) {
+		for (v = 0; v < 256; ++v) {
+			pc1_c[i][v] = 0;
+			pc1_d[i][v] = 0;
+			for (b = 0; b < 28; ++b) {
+				if (des_key_perm_c[b] / 8 == i)
+					pc1_c[i][v] |= (WORD)((v >> (7 - des_key_perm_c[b] % 8)) & 0x01) << (31 - b);
+				if (des_key_perm_d[b] / 8 == i)
+					pc1_d[i][v] |= (WORD)((v >> (7 - des_key_perm_d[b] % 8)) & 0x01) << (31 - b);
+			}
+		}
+	}
+
+	// chunk c covers the bits 7c .. 7c+6 of C (c = 0..3) and D (c = 4..7)
+	for (c = 0; c < 8; ++c) {
+		for (v = 0; v < 128; ++v) {
+			pc2[c][v] = 0;
+			for (b = 0; b < 48; ++b) {
+				i = des_key_compression[b] - 7 * c;
+				if (i >= 0 && i < 7)
+					pc2[c][v] |= (QWORD)((v >> (6 - i)) & 0x01) << (47 - b);
+			}
+		}
+	}
+}
+
+static inline QWORD subkey_word(const BYTE key[])
+{
+	return ((QWORD)key[0] << 40) | ((QWORD)key[1] << 32) | ((QWORD)key[2] << 24) |
+	       ((QWORD)key[3] << 16) | ((QWORD)key[4] << 8) | key[5];
+}
+
+static inline __attribute__ ((always_inline)) WORD f_sp(WORD state, QWORD k)
+{
+	return sp[0][(EXPANDED(state, 0) ^ (k >> 42)) & 0x3F] | sp[1][(EXPANDED(state, 1) ^ (k >> 36)) & 0x3F] |
+	       sp[2][(EXPANDED(state, 2) ^ (k >> 30)) & 0x3F] | sp[3][(EXPANDED(state, 3) ^ (k >> 24)) & 0x3F] |
+	       sp[4][(EXPANDED(state, 4) ^ (k >> 18)) & 0x3F] | sp[5][(EXPANDED(state, 5) ^ (k >> 12)) & 0x3F] |
+	       sp[6][(EXPANDED(state, 6) ^ (k >> 6)) & 0x3F] | sp[7][(EXPANDED(state, 7) ^ k) & 0x3F];
+}
+
+// The rounds of des_crypt() on a block given as 64-bit word. With a constant "rounds"
+// the loop is unrolled and the halves are never switched, they only change their roles.
+static inline __attribute__ ((always_inline)) QWORD crypt_rounds(QWORD block, const QWORD k[], const int rounds)
+{
+	WORD l = block >> 32, r = (WORD)block;
+	int idx;
+
+#pragma GCC unroll 16
+	for (idx = 0; idx + 1 < rounds; idx += 2) {
+		l ^= f_sp(r, k[idx]);
+		if (idx + 1 == rounds - 1)
+			return ((QWORD)(r ^ f_sp(l, k[idx + 1])) << 32) | l;
+		r ^= f_sp(l, k[idx + 1]);
+	}
+	// an odd number of rounds ends with the halves in place
+	return ((QWORD)(l ^ f_sp(r, k[rounds - 1])) << 32) | r;
+}
+
+static inline __attribute__ ((always_inline)) void crypt_blocks(const BYTE in[][DES_BLOCK_SIZE], BYTE out[][DES_BLOCK_SIZE], const BYTE key[][6], int number_of_blocks, const int rounds)
+{
+	QWORD k[16], block;
+	int i, j;
+
+	pthread_once(&tables_once, build_tables);
+	for (i = 0; i < rounds; ++i)
+		k[i] = subkey_word(key[i]);
+	for (i = 0; i < number_of_blocks; ++i) {
+		for (j = 0, block = 0; j < DES_BLOCK_SIZE; ++j)
+			block = (block << 8) | in[i][j];
+		block = crypt_rounds(block, k, rounds);
+		for (j = 0; j < DES_BLOCK_SIZE; ++j)
+			out[i][j] = (block >> (8 * (7 - j))) & 0xFF;
+	}
+}
+
+// des_crypt_blocks_1() .. des_crypt_blocks_16(): crypt_blocks() for a constant round count
+#define DES_CRYPT_BLOCKS(R) \
+	static void des_crypt_blocks_##R(const BYTE in[][DES_BLOCK_SIZE], BYTE out[][DES_BLOCK_SIZE], const BYTE key[][6], int number_of_blocks) \
+	{ \
+		crypt_blocks(in, out, key, number_of_blocks, R); \
+	}
+
+DES_CRYPT_BLOCKS(1)  DES_CRYPT_BLOCKS(2)  DES_CRYPT_BLOCKS(3)  DES_CRYPT_BLOCKS(4)
+DES_CRYPT_BLOCKS(5)  DES_CRYPT_BLOCKS(6)  DES_CRYPT_BLOCKS(7)  DES_CRYPT_BLOCKS(8)
+DES_CRYPT_BLOCKS(9)  DES_CRYPT_BLOCKS(10) DES_CRYPT_BLOCKS(11) DES_CRYPT_BLOCKS(12)
+DES_CRYPT_BLOCKS(13) DES_CRYPT_BLOCKS(14) DES_CRYPT_BLOCKS(15) DES_CRYPT_BLOCKS(16)
+
+static const DES_CRYPT_BLOCKS_FUNC crypt_blocks_rounds[17] = {
+	NULL,
+	des_crypt_blocks_1,  des_crypt_blocks_2,  des_crypt_blocks_3,  des_crypt_blocks_4,
+	des_crypt_blocks_5,  des_crypt_blocks_6,  des_crypt_blocks_7,  des_crypt_blocks_8,
+	des_crypt_blocks_9,  des_crypt_blocks_10, des_crypt_blocks_11, des_crypt_blocks_12,
+	des_crypt_blocks_13, des_crypt_blocks_14, des_crypt_blocks_15, des_crypt_blocks_16
+};
+
+WORD f_table(WORD state, const BYTE key[])
+{
+	pthread_once(&tables_once, build_tables);
+	return f_sp(state, subkey_word(key));
+}
+
+void des_key_setup_table(const BYTE key[], BYTE schedule[][6], DES_MODE mode, const int rounds)
+{
+	WORD C = 0, D = 0, shift;
+	QWORD k;
+	int i, j, to_gen;
+
+	pthread_once(&tables_once, build_tables);
+	for (i = 0; i < 8; ++i) {
+		C |= pc1_c[i][key[i]];
+		D |= pc1_d[i][key[i]];
+	}
+
+	for (i = 0; i < rounds; ++i) {
+		shift = des_key_rnd_shift[i];
+		C = ((C << shift) | (C >> (28 - shift))) & 0xfffffff0;
+		D = ((D << shift) | (D >> (28 - shift))) & 0xfffffff0;
+
+		k = pc2[0][C >> 25] | pc2[1][(C >> 18) & 0x7F] | pc2[2][(C >> 11) & 0x7F] | pc2[3][(C >> 4) & 0x7F] |
+		    pc2[4][D >> 25] | pc2[5][(D >> 18) & 0x7F] | pc2[6][(D >> 11) & 0x7F] | pc2[7][(D >> 4) & 0x7F];
+
+		to_gen = (mode == DES_DECRYPT) ? (rounds - 1) - i : i;
+		for (j = 0; j < 6; ++j)
+			schedule[to_gen][j] = (k >> (40 - 8 * j)) & 0xFF;
+	}
+}
+
+void des_crypt_table(const BYTE in[], BYTE out[], const BYTE key[][6], const int rounds)
+{
+	WORD state[2], t;
+	int idx;
+
+	Initial_Breakup(state, in);
+	for (idx = 0; idx < rounds - 1; ++idx) {
+		t = state[1];
+		state[1] = f_table(state[1], key[idx]) ^ state[0];
+		state[0] = t;
+	}
+	// the final round doesn't switch sides
+	state[0] = f_table(state[1], key[rounds - 1]) ^ state[0];
+	Final_Assembling(state, out);
+}
+
+void des_crypt_blocks_generic(const BYTE in[][DES_BLOCK_SIZE], BYTE out[][DES_BLOCK_SIZE], const BYTE key[][6], int number_of_blocks, const int rounds)
+{
+	crypt_blocks(in, out, key, number_of_blocks, rounds);
+}
+
+DES_CRYPT_BLOCKS_FUNC des_crypt_blocks_select(int rounds)
+{
+	if (rounds < 1 || rounds > 16)
+		return NULL;
+	return crypt_blocks_rounds[rounds];
+}
+
+int des_crypt_blocks(const BYTE in[][DES_BLOCK_SIZE], BYTE out[][DES_BLOCK_SIZE], const BYTE key[][6], int number_of_blocks, const int rounds)
+{
+	DES_CRYPT_BLOCKS_FUNC crypt = des_crypt_blocks_select(rounds);
+
+	if (crypt == NULL)
+		return -1;
+	crypt(in, out, key, number_of_blocks);
+	return 0;
+}
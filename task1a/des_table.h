@@ -0,0 +1,37 @@
+/*********************************************************************
+* Filename:   des_table.h
+* Copyright:
+* Disclaimer: This code is presented "as is" without any guarantees.
+* Details:    Defines the API for the table-driven versions of f(),
+              des_key_setup() and des_crypt(). They take the same
+              arguments and give the same results as the reference
+              functions in des.c.
+*********************************************************************/
+
+#ifndef DES_TABLE_H
+#define DES_TABLE_H
+
+/*************************** HEADER FILES ***************************/
+#include "des.h"
+
+/****************************** MACROS ******************************/
+#define DES_TABLE_BATCH 256             // blocks per des_crypt_blocks() call in the attack functions
+
+/**************************** DATA TYPES ****************************/
+// Encrypts a data set with a key schedule of a fixed number of rounds
+typedef void (*DES_CRYPT_BLOCKS_FUNC)(const BYTE in[][DES_BLOCK_SIZE], BYTE out[][DES_BLOCK_SIZE], const BYTE key[][6], int number_of_blocks);
+
+/*********************** FUNCTION DECLARATIONS **********************/
+WORD f_table(WORD state, const BYTE key[]);
+void des_key_setup_table(const BYTE key[], BYTE schedule[][6], DES_MODE mode, const int rounds);
+void des_crypt_table(const BYTE in[], BYTE out[], const BYTE key[][6], const int rounds);
+// des_crypt_table() for a whole data set, the subkeys are loaded once. There is a version with
+// the rounds loop unrolled for every round count 1..16, des_crypt_blocks_select() gives it
+// (NULL for other round counts) and des_crypt_blocks() picks it once per call.
+// des_crypt_blocks_generic() is the same code with a runtime round count. des_crypt_blocks()
+// returns -1 and leaves "out" untouched for other round counts.
+void des_crypt_blocks_generic(const BYTE in[][DES_BLOCK_SIZE], BYTE out[][DES_BLOCK_SIZE], const BYTE key[][6], int number_of_blocks, const int rounds);
+DES_CRYPT_BLOCKS_FUNC des_crypt_blocks_select(int rounds);
+int des_crypt_blocks(const BYTE in[][DES_BLOCK_SIZE], BYTE out[][DES_BLOCK_SIZE], const BYTE key[][6], int number_of_blocks, const int rounds);
+
+#endif   // DES_TABLE_H
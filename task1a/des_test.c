@@ -13,8 +13,65 @@
 
 /*************************** HEADER FILES ***************************/
 #include <stdio.h>
+#include <stdlib.h>
 #include <memory.h>
+#include <time.h>
+#include <unistd.h>
 #include "des.h"
+#include "des_bitslice.h"
+#include "des_dataset.h"
+#include "des_differential.h"
+#include "des_keyguess.h"
+#include "des_keysearch.h"
+#include "des_linear.h"
+#include "des_oracle.h"
+#include "des_rainbow.h"
+#include "des_parallel.h"
+#include "des_sequential.h"
+#include "des_shard.h"
+#include "des_stats.h"
+#include "des_stream.h"
+#include "des_table.h"
+#include "linear_ciphers.h"
+
+/****************************** MACROS ******************************/
+#define KEYSEARCH_DEMO_UNKNOWN_BITS 30  // key bits the rate benchmark searches, the others are taken from the actual key
+#define KEYSEARCH_DEMO_CANDIDATES 4     // best ranked K8 guesses tried
+
+/**************************** DATA TYPES ****************************/
+// Running state of the streamed 7 round attack
+typedef struct {
+	const BYTE (*key_schedule)[6];
+	int rounds;
+	unsigned int count_T0;
+	unsigned int count_T1;
+	int error;                          // set by the first failed chunk, the counts are -1 from then on
+} ALGORITHM1_STREAM;
+
+// Running state of the streamed 8 round attack
+typedef struct {
+	const BYTE (*keyschedule)[6];
+	BYTE (*ciphertexts)[DES_BLOCK_SIZE];
+	unsigned int counter[ALGORITHM2_COUNTER_SIZE];
+} ALGORITHM2_STREAM;
+
+// Pairs of the oracle test and the running counts of the oracle 7 round attack
+typedef struct {
+	const BYTE (*key_schedule)[6];
+	int rounds;
+	int mismatches;
+	unsigned int count_T0;
+	unsigned int count_T1;
+} ORACLE_COUNTS;
+
+// Running state of the streamed multiple linear 8 round attack
+typedef struct {
+	const BYTE (*keyschedule)[6];
+	BYTE (*ciphertexts)[DES_BLOCK_SIZE];
+	const LINEAR_APPROXIMATION *approx;
+	int number_of_approx;
+	long long histograms[KEYGUESS_MAX_APPROX * 64];
+} MULTIPLE_STREAM;
 
 /*********************** FUNCTION DEFINITIONS ***********************/
 int des_test(int rounds)
@@ -94,6 +151,209 @@ int des_test(int rounds)
 	return(pass);
 }
 
+int des_bitslice_test(int rounds)
+{
+	int number_of_blocks = DES_BS_BLOCKS + 13; //one full and one partial batch
+	BYTE key[DES_BLOCK_SIZE] = {0x13,0x34,0x57,0x79,0x9B,0xBC,0xDF,0xF1};
+	BYTE pt[number_of_blocks][DES_BLOCK_SIZE];
+	BYTE ct[number_of_blocks][DES_BLOCK_SIZE];
+	BYTE ct_bs[number_of_blocks][DES_BLOCK_SIZE];
+	BYTE schedule[16][6];
+	int pass = 1;
+	int i, j;
+
+	for(j = 0; j < number_of_blocks; j++)
+	{
+		for(i = 0; i < DES_BLOCK_SIZE; i++)
+		{
+			pt[j][i] = (BYTE)(j * 0x9D + i * 0x3B + (j >> 3));
+		}
+	}
+
+	des_key_setup(key, schedule, DES_ENCRYPT, rounds);
+	for(j = 0; j < number_of_blocks; j++)
+	{
+		des_crypt(pt[j], ct[j], schedule, rounds);
+	}
+	des_crypt_bitslice(pt, ct_bs, schedule, rounds, DES_BS_BLOCKS);
+	des_crypt_bitslice(&pt[DES_BS_BLOCKS], &ct_bs[DES_BS_BLOCKS], schedule, rounds, number_of_blocks - DES_BS_BLOCKS);
+
+	pass = pass && !memcmp(ct, ct_bs, sizeof(ct));
+
+	return(pass);
+}
+
+int des_table_test()
+{
+	int number_of_keys = 256;
+	BYTE iv[DES_BLOCK_SIZE] = {0x5A,0x17,0xC3,0x00,0x9E,0x42,0x81,0x3D};
+	BYTE keys[number_of_keys][DES_BLOCK_SIZE];
+	BYTE schedule[16][6], schedule_table[16][6];
+	BYTE ct[DES_BLOCK_SIZE], ct_table[DES_BLOCK_SIZE];
+	BYTE ct_all[number_of_keys][DES_BLOCK_SIZE], ct_blocks[number_of_keys][DES_BLOCK_SIZE];
+	WORD state;
+	int pass = 1;
+	int i, rounds;
+
+	//random keys, also used as plaintexts and right halves
+	counter_plaintexts(iv, 0, number_of_keys, keys);
+	for(i = 0; i < number_of_keys; i++)
+	{
+		state = (keys[i][0] << 24) | (keys[i][3] << 16) | (keys[i][5] << 8) | keys[i][7];
+		pass = pass && (f(state, keys[i]) == f_table(state, keys[i]));
+		for(rounds = 1; rounds <= 16; rounds++)
+		{
+			des_key_setup(keys[i], schedule, DES_ENCRYPT, rounds);
+			des_key_setup_table(keys[i], schedule_table, DES_ENCRYPT, rounds);
+			pass = pass && !memcmp(schedule, schedule_table, rounds * 6);
+			des_crypt(keys[(i + 1) % number_of_keys], ct, schedule, rounds);
+			des_crypt_table(keys[(i + 1) % number_of_keys], ct_table, schedule_table, rounds);
+			pass = pass && !memcmp(ct, ct_table, DES_BLOCK_SIZE);
+
+			des_key_setup(keys[i], schedule, DES_DECRYPT, rounds);
+			des_key_setup_table(keys[i], schedule_table, DES_DECRYPT, rounds);
+			pass = pass && !memcmp(schedule, schedule_table, rounds * 6);
+		}
+	}
+
+	//data set encryption, unrolled for 3, 5, 7, 8 and 16 rounds
+	for(rounds = 1; rounds <= 16; rounds++)
+	{
+		des_key_setup(keys[0], schedule, DES_ENCRYPT, rounds);
+		for(i = 0; i < number_of_keys; i++)
+		{
+			des_crypt(keys[i], ct_all[i], schedule, rounds);
+		}
+		pass = pass && (des_crypt_blocks(keys, ct_blocks, schedule, number_of_keys, rounds) == 0);
+		pass = pass && !memcmp(ct_all, ct_blocks, sizeof(ct_all));
+	}
+	pass = pass && (des_crypt_blocks(keys, ct_blocks, schedule, number_of_keys, 0) == -1);
+	pass = pass && (des_crypt_blocks(keys, ct_blocks, schedule, number_of_keys, 17) == -1);
+
+	return(pass);
+}
+
+//the left sides extracted bit by bit from the blocks, the last round does not switch the halves,
+//so the ciphertext of r rounds is (R_r, L_r)
+BYTE extracted_left_side(const BYTE plaintext[], const BYTE ciphertext[], int rounds, const WORD f)
+{
+	if(rounds == 3)
+	{
+		//R0[15] ^ L3[15] ^ L0[7,18,24,29] ^ R3[7,18,24,29]
+		return (((plaintext[6] >> 7) ^ (ciphertext[6] >> 7) ^ (plaintext[3] >> 7) ^ (plaintext[1] >> 2) ^ plaintext[0] ^ (plaintext[0] >> 5) ^
+		         (ciphertext[3] >> 7) ^ (ciphertext[1] >> 2) ^ ciphertext[0] ^ (ciphertext[0] >> 5)) & 0x01);
+	}
+	else if(rounds == 5)
+	{
+		//L0[15] ^ R0[7,18,24,27,28,29,30,31] ^ R5[15] ^ L5[7,18,24,27,28,29,30,31]
+		return (((plaintext[2] >> 7) ^ (plaintext[7] >> 7) ^ (plaintext[5] >> 2) ^ plaintext[4] ^ (plaintext[4] >> 3) ^ (plaintext[4] >> 4) ^
+		         (plaintext[4] >> 5) ^ (plaintext[4] >> 6) ^ (plaintext[4] >> 7) ^ (ciphertext[2] >> 7) ^ (ciphertext[7] >> 7) ^
+		         (ciphertext[5] >> 2) ^ ciphertext[4] ^ (ciphertext[4] >> 3) ^ (ciphertext[4] >> 4) ^ (ciphertext[4] >> 5) ^
+		         (ciphertext[4] >> 6) ^ (ciphertext[4] >> 7)) & 0x01);
+	}
+	else if(rounds == 7)
+	{
+		//L0[7,18,24] ^ R0[12,16] ^ R7[15] ^ L7[7,18,24,29]
+		return (((plaintext[3] >> 7) ^ (plaintext[1] >> 2) ^ plaintext[0] ^ (plaintext[6] >> 4) ^ plaintext[5] ^
+		         (ciphertext[3] >> 7) ^ (ciphertext[1] >> 2) ^ ciphertext[0] ^ (ciphertext[0] >> 5) ^ (ciphertext[6] >> 7)) & 0x01);
+	}
+	//L0[7,18,24] ^ R0[12,16] ^ L7[15] ^ R7[7,18,24,29] ^ F(R8,K8)[15]
+	return (((plaintext[3] >> 7) ^ (plaintext[1] >> 2) ^ plaintext[0] ^ (plaintext[6] >> 4) ^ plaintext[5] ^
+	         (ciphertext[7] >> 7) ^ (ciphertext[5] >> 2) ^ ciphertext[4] ^ (ciphertext[4] >> 5) ^ (ciphertext[2] >> 7) ^ (f >> 15)) & 0x01);
+}
+
+int des_linear_test()
+{
+	int number_of_blocks = 2048;
+	int round_counts[4] = {3, 5, 7, 8};
+	BYTE iv[DES_BLOCK_SIZE] = {0x4C,0x49,0x4E,0x45,0x41,0x52,0x31,0x36};
+	BYTE blocks[number_of_blocks][DES_BLOCK_SIZE];
+	LINEAR_APPROXIMATION approx[4], loaded[4];
+	const LINEAR_APPROXIMATION *builtin;
+	char filename[] = "/tmp/des_test_linear_XXXXXX";
+	FILE *file;
+	WORD f;
+	int pass = 1;
+	int fd, i, r, k;
+
+	//the masks give the bits the attacks extracted before, (P,C) are pairs of random blocks
+	counter_plaintexts(iv, 0, number_of_blocks, blocks);
+	for(r = 0; r < 4; r++)
+	{
+		builtin = builtin_approximation(round_counts[r]);
+		pass = pass && (builtin != NULL);
+		if(builtin == NULL)
+		{
+			continue;
+		}
+		approx[r] = *builtin;
+		for(i = 0; i < number_of_blocks; i += 2)
+		{
+			f = (blocks[i][1] << 8) | blocks[i + 1][6];
+			pass = pass && (approximation_left_side(builtin, block_to_qword(blocks[i]), block_to_qword(blocks[i + 1]), f)
+			                == extracted_left_side(blocks[i], blocks[i + 1], round_counts[r], f));
+		}
+	}
+	if(!pass)
+	{
+		return(0);
+	}
+
+	//the text format round trip
+	fd = mkstemp(filename);
+	if(fd < 0)
+	{
+		return(0);
+	}
+	close(fd);
+	pass = pass && (save_approximations(filename, approx, 4) == 0) && (load_approximations(filename, loaded, 4) == 4);
+	for(r = 0; r < 4 && pass; r++)
+	{
+		pass = pass && (loaded[r].rounds == approx[r].rounds) && (loaded[r].plain_mask == approx[r].plain_mask);
+		pass = pass && (loaded[r].cipher_mask == approx[r].cipher_mask) && (loaded[r].fmask == approx[r].fmask);
+		for(k = 0; k < approx[r].rounds; k++)
+		{
+			pass = pass && (loaded[r].key_mask[k] == approx[r].key_mask[k]);
+		}
+	}
+
+	//blank and comment lines are skipped, a line that does not parse is an error
+	file = fopen(filename, "w");
+	pass = pass && (file != NULL);
+	if(file != NULL)
+	{
+		fprintf(file, "# comment\n\n   \n3 0 0 0 0 0 0 # trailing comment\n");
+		fclose(file);
+		pass = pass && (load_approximations(filename, loaded, 4) == 1);
+	}
+	file = fopen(filename, "w");
+	pass = pass && (file != NULL);
+	if(file != NULL)
+	{
+		fprintf(file, "3 0 0 0 0 0 0\n3 0 0 0 0 0\n");
+		fclose(file);
+		pass = pass && (load_approximations(filename, loaded, 4) == -1);
+	}
+	file = fopen(filename, "w");
+	pass = pass && (file != NULL);
+	if(file != NULL)
+	{
+		fprintf(file, "3 0 0 0 0 0 0 0\nthree rounds\n");
+		fclose(file);
+		pass = pass && (load_approximations(filename, loaded, 4) == -1);
+	}
+
+	unlink(filename);
+	return(pass);
+}
+
+double seconds_since(const struct timespec *start)
+{
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return (now.tv_sec - start->tv_sec) + (now.tv_nsec - start->tv_nsec) / 1e9;
+}
+
 void print_plaintexts(int number_of_plains, const BYTE text_array[][DES_BLOCK_SIZE])
 {
 	int j, i;
@@ -111,27 +371,625 @@ void print_plaintexts(int number_of_plains, const BYTE text_array[][DES_BLOCK_SI
 
 void create_plaintexts(BYTE iv[], int number_of_plains, BYTE plaintexts[][DES_BLOCK_SIZE])
 {
-   BYTE key[DES_BLOCK_SIZE];
-   BYTE state[DES_BLOCK_SIZE];
-   BYTE random_plaintext[DES_BLOCK_SIZE];
-   int i = 0;
-   int j = 0;
    printf("Creating %d plaintexts...\n", number_of_plains);
-   for(i = 0; i < DES_BLOCK_SIZE; i++)
-   {
-	   key[i] = iv[i];
-   }
+   counter_plaintexts(iv, 0, number_of_plains, plaintexts);
+}
 
-   for(j = 0; j < number_of_plains; j++)
-   {
-   	   rand_plaintext(key, state, random_plaintext);
+int algorithm1_consume(const BYTE plain[][DES_BLOCK_SIZE], int number_of_plains, void *arg)
+{
+	ALGORITHM1_STREAM *stream = arg;
+	unsigned int count_T0 = 0, count_T1 = 0;
 
-   	   for(i = 0; i<DES_BLOCK_SIZE;i++)
-	   {
-   		   key[i] = state[i];
-   		   plaintexts[j][i] = random_plaintext[i];
-	   }
-   }
+	if(stream->error)
+	{
+		return(-1);
+	}
+	algorithm1_parallel(plain, stream->key_schedule, &count_T0, &count_T1, number_of_plains, stream->rounds, stream->key_schedule[0], 0);
+	if((count_T0 == -1)&&(count_T1 == -1))
+	{
+		//the -1 of a failed chunk must not be added to the counts of the others
+		stream->error = 1;
+		stream->count_T0 = -1;
+		stream->count_T1 = -1;
+		return(-1);
+	}
+	stream->count_T0 += count_T0;
+	stream->count_T1 += count_T1;
+	return(0);
+}
+
+int algorithm2_consume(const BYTE plain[][DES_BLOCK_SIZE], int number_of_plains, void *arg)
+{
+	ALGORITHM2_STREAM *stream = arg;
+	if(encrypt_plaintexts(plain, stream->ciphertexts, stream->keyschedule, number_of_plains, 8) != 0)
+	{
+		return(-1);
+	}
+	compress_pairs(plain, stream->ciphertexts, stream->counter, number_of_plains);
+	return(0);
+}
+
+int multiple_consume(const BYTE plain[][DES_BLOCK_SIZE], int number_of_plains, void *arg)
+{
+	MULTIPLE_STREAM *stream = arg;
+	BYTE target_sboxes[1] = {1};
+	if(encrypt_plaintexts(plain, stream->ciphertexts, stream->keyschedule, number_of_plains, 8) != 0)
+	{
+		return(-1);
+	}
+	add_histograms(plain, stream->ciphertexts, number_of_plains, stream->approx, stream->number_of_approx, target_sboxes, 1, stream->histograms);
+	return(0);
+}
+
+void oracle_consume(const BYTE plain[][DES_BLOCK_SIZE], const BYTE cipher[][DES_BLOCK_SIZE], int number_of_plains, void *arg)
+{
+	ORACLE_COUNTS *counts = arg;
+	BYTE keyguess[6] = {0x00,0x00,0x00,0x00,0x00,0x00};
+	BYTE expected[DES_BLOCK_SIZE];
+	int i;
+
+	if(counts->key_schedule != NULL)
+	{
+		for(i = 0; i < number_of_plains; i += 101)
+		{
+			des_crypt(plain[i], expected, counts->key_schedule, counts->rounds);
+			counts->mismatches += (memcmp(expected, cipher[i], DES_BLOCK_SIZE) != 0);
+		}
+	}
+	count_left_side(plain, cipher, &counts->count_T0, &counts->count_T1, number_of_plains, counts->rounds, keyguess);
+}
+
+int parallel_test()
+{
+	int number_of_plains = 20000; //more than one chunk
+	BYTE plaintexts[number_of_plains][DES_BLOCK_SIZE];
+	BYTE iv[DES_BLOCK_SIZE] = {0x11,0x22,0x33,0x44,0x55,0x66,0x77,0x88};
+	BYTE key[DES_BLOCK_SIZE] = {0x96,0x4B,0xEA,0x19,0x50,0xF0,0x1F,0x36};
+	BYTE schedule[8][6];
+	BYTE key8bits[6];
+	unsigned int count_T0 = 0, count_T1 = 0;
+	unsigned int par_T0 = 0, par_T1 = 0;
+	unsigned int guess_T0[64], guess_T1[64];
+	unsigned int par_guess_T0[64], par_guess_T1[64];
+	unsigned int cached_T0[64], cached_T1[64];
+	int guess;
+	int pass = 1;
+
+	create_plaintexts(iv, number_of_plains, plaintexts);
+
+	des_key_setup(key, schedule, DES_ENCRYPT, 7);
+	algorithm1(plaintexts, schedule, &count_T0, &count_T1, number_of_plains, 7, schedule[0]);
+	algorithm1_parallel(plaintexts, schedule, &par_T0, &par_T1, number_of_plains, 7, schedule[0], 4);
+	pass = pass && (count_T0 == par_T0) && (count_T1 == par_T1);
+
+	des_key_setup(key, schedule, DES_ENCRYPT, 8);
+	guess = algorithm2(plaintexts, schedule, key8bits, guess_T0, guess_T1, number_of_plains, 64);
+	pass = pass && (guess == algorithm2_parallel(plaintexts, schedule, key8bits, par_guess_T0, par_guess_T1, number_of_plains, 64, 4));
+	pass = pass && !memcmp(guess_T0, par_guess_T0, sizeof(guess_T0)) && !memcmp(guess_T1, par_guess_T1, sizeof(guess_T1));
+
+	//the encrypt-once algorithm 2 gives the same counts, the later attacks are checked against it
+	pass = pass && (guess == algorithm2_cached(plaintexts, schedule, key8bits, cached_T0, cached_T1, number_of_plains, 64));
+	pass = pass && !memcmp(guess_T0, cached_T0, sizeof(guess_T0)) && !memcmp(guess_T1, cached_T1, sizeof(guess_T1));
+
+	return(pass);
+}
+
+int stream_test()
+{
+	int number_of_plains = 4096;
+	BYTE seed[DES_BLOCK_SIZE] = {0x53,0x54,0x52,0x45,0x41,0x4D,0x30,0x31};
+	BYTE all[number_of_plains][DES_BLOCK_SIZE], slice[number_of_plains][DES_BLOCK_SIZE];
+	BYTE schedule[16][6], index[DES_BLOCK_SIZE];
+	int first[4] = {0, 1, 1000, 4000};
+	int count[4] = {4096, 7, 3000, 96}; //k + n stays within the arrays
+	ALGORITHM1_STREAM stream;
+	int pass = 1;
+	int i, k, n;
+
+	//plaintext i is the encryption of the counter i under the seed
+	counter_plaintexts(seed, 0, number_of_plains, all);
+	des_key_setup(seed, schedule, DES_ENCRYPT, 16);
+	memset(index, 0, sizeof(index));
+	index[6] = 0x0A;
+	index[7] = 0xBC;
+	des_crypt(index, slice[0], schedule, 16);
+	pass = pass && !memcmp(slice[0], all[0x0ABC], DES_BLOCK_SIZE);
+
+	//plaintexts k .. k+n-1 generated on their own are the same slice of plaintexts 0 .. k+n-1
+	for(i = 0; i < 4; i++)
+	{
+		k = first[i];
+		n = count[i];
+		counter_plaintexts(seed, 0, k + n, all);
+		counter_plaintexts(seed, k, n, slice);
+		pass = pass && !memcmp(slice, all[k], n * DES_BLOCK_SIZE);
+	}
+
+	//a failed chunk stops the stream, the counts stay at -1 instead of adding up the later chunks
+	des_key_setup(seed, schedule, DES_ENCRYPT, 4);
+	stream.key_schedule = (const BYTE (*)[6])schedule;
+	stream.rounds = 4;
+	stream.count_T0 = 0;
+	stream.count_T1 = 0;
+	stream.error = 0;
+	pass = pass && (stream_plaintexts(seed, 3 * STREAM_CHUNK_SIZE, algorithm1_consume, &stream) == -1);
+	pass = pass && stream.error && (stream.count_T0 == -1) && (stream.count_T1 == -1);
+
+	return(pass);
+}
+
+int keyguess_test()
+{
+	int number_of_plains = 8192;
+	BYTE plaintexts[number_of_plains][DES_BLOCK_SIZE];
+	BYTE iv[DES_BLOCK_SIZE] = {0x4B,0x45,0x59,0x47,0x55,0x45,0x53,0x53};
+	BYTE key[DES_BLOCK_SIZE] = {0x40,0x31,0xEC,0xC4,0xA8,0xF6,0x92,0x88};
+	BYTE target_sboxes[1] = {1};
+	BYTE schedule[8][6];
+	BYTE key8bits[6];
+	unsigned int count_T0[64], count_T1[64];
+	long long histogram[64];
+	KEY_CANDIDATE candidates[64];
+	int seen[64] = {0};
+	double difference;
+	int pass = 1;
+	int k, g;
+
+	counter_plaintexts(iv, 0, number_of_plains, plaintexts);
+	des_key_setup(key, schedule, DES_ENCRYPT, 8);
+	algorithm2(plaintexts, schedule, key8bits, count_T0, count_T1, number_of_plains, 64);
+
+	//the bias of every ranked guess is T0 - T1 of algorithm 2 for the same K8 bits
+	pass = pass && (lastround_histogram(plaintexts, schedule, histogram, number_of_plains, 8, target_sboxes, 1) == 0);
+	pass = pass && (fwht_keyguess(histogram, builtin_approximation(8)->fmask, target_sboxes, 1, number_of_plains, candidates) == 0);
+	for(k = 0; k < 64 && pass; k++)
+	{
+		g = candidates[k].guess;
+		pass = pass && (g < 64) && !seen[g];
+		if(!pass)
+		{
+			break;
+		}
+		seen[g] = 1;
+		difference = candidates[k].bias * 2.0 * number_of_plains - ((double)count_T0[g] - (double)count_T1[g]);
+		pass = pass && (difference > -0.5) && (difference < 0.5);
+	}
+
+	return(pass);
+}
+
+int key_search_test()
+{
+	BYTE key[DES_BLOCK_SIZE] = {0x96,0x4B,0xEA,0x19,0x50,0xF0,0x1F,0x36};
+	BYTE iv[DES_BLOCK_SIZE] = {0x01,0x02,0x03,0x04,0x05,0x06,0x07,0x08};
+	BYTE plain[2][DES_BLOCK_SIZE], cipher[2][DES_BLOCK_SIZE];
+	BYTE schedule[16][6], map[16][48];
+	BYTE found[DES_BLOCK_SIZE];
+	KEY_EQUATION equations[KEYSEARCH_MAX_EQUATIONS];
+	QWORD master = block_to_qword(key);
+	int number_of_equations = 0;
+	int pass = 1;
+	int r, i, b;
+
+	//every subkey bit comes from the mapped master key bit
+	des_key_setup(key, schedule, DES_ENCRYPT, 16);
+	key_bit_map(map, 16);
+	for(r = 0; r < 16; r++)
+	{
+		for(i = 0; i < 48; i++)
+		{
+			pass = pass && (((schedule[r][i/8] >> (7 - (i%8))) & 0x01) == ((master >> (63 - map[r][i])) & 0x01));
+		}
+	}
+
+	//the right side of the 8 round approximation over the master key
+	equations[0] = approximation_key_equation(builtin_approximation(8), 0);
+	pass = pass && (__builtin_parityll(master & equations[0].mask) == approximation_right_side(builtin_approximation(8), (const BYTE (*)[6])schedule));
+	equations[0].value = __builtin_parityll(master & equations[0].mask);
+	number_of_equations = 1;
+
+	//all but 16 key bits known, the 8 round search has to find the key again
+	for(b = 24; b < 64; b++)
+	{
+		if((KEYSEARCH_KEY_BITS >> (63 - b)) & 0x01)
+		{
+			equations[number_of_equations].mask = 1ULL << (63 - b);
+			equations[number_of_equations].value = (master >> (63 - b)) & 0x01;
+			number_of_equations++;
+		}
+	}
+	counter_plaintexts(iv, 0, 2, plain);
+	for(i = 0; i < 2; i++)
+	{
+		des_crypt(plain[i], cipher[i], schedule, 8);
+	}
+	pass = pass && (key_search(plain, cipher, 2, 8, equations, number_of_equations, 4, found, NULL) == 1);
+	pass = pass && ((block_to_qword(found) & KEYSEARCH_KEY_BITS) == (master & KEYSEARCH_KEY_BITS));
+
+	//contradicting equations
+	equations[number_of_equations] = equations[number_of_equations - 1];
+	equations[number_of_equations].value ^= 1;
+	pass = pass && (key_search(plain, cipher, 2, 8, equations, number_of_equations + 1, 4, found, NULL) == -1);
+
+	return(pass);
+}
+
+int differential_test()
+{
+	BYTE iv[DES_BLOCK_SIZE] = {0x01,0x02,0x03,0x04,0x05,0x06,0x07,0x08};
+	BYTE text[16][DES_BLOCK_SIZE];
+	WORD x;
+	QWORD e;
+	int pass = 1;
+	int i, b, s, in, out, sum;
+
+	//the expansion of a difference against the expansion table
+	counter_plaintexts(iv, 0, 16, text);
+	for(i = 0; i < 16; i++)
+	{
+		x = (WORD)block_to_qword(text[i]);
+		for(b = 0, e = 0; b < 48; b++)
+		{
+			e = (e << 1) | ((x >> (31 - des_expansion[b])) & 0x01);
+		}
+		pass = pass && (expansion_difference(x) == e);
+	}
+
+	//every row of the difference distribution tables counts all 64 inputs
+	for(s = 1; s <= 8; s++)
+	{
+		for(in = 0; in < 64; in++)
+		{
+			for(out = 0, sum = 0; out < 16; out++)
+			{
+				sum += sbox_ddt(s, in, out);
+			}
+			pass = pass && (sum == 64);
+		}
+		pass = pass && (sbox_ddt(s, 0, 0) == 64);
+	}
+
+	//the probabilities of Biham and Shamir
+	pass = pass && (characteristic_probability(builtin_characteristic(4)) == 1.0);
+	pass = pass && (characteristic_probability(builtin_characteristic(6)) == 1.0 / 16);
+	pass = pass && (characteristic_probability(builtin_characteristic(8)) > 1.0 / 10500);
+	pass = pass && (characteristic_probability(builtin_characteristic(8)) < 1.0 / 10400);
+
+	return(pass);
+}
+
+int dataset_test()
+{
+	BYTE seed[DES_BLOCK_SIZE] = {0x01,0x02,0x03,0x04,0x05,0x06,0x07,0x08};
+	BYTE key[DES_BLOCK_SIZE], keyschedule[8][6], cipher[DES_BLOCK_SIZE];
+	BYTE keyguess[6] = {0x28,0x00,0x00,0x00,0x00,0x00};
+	BYTE bits[6], bits_dataset[6];
+	BYTE (*plain)[DES_BLOCK_SIZE];
+	unsigned int t0 = 0, t1 = 0, t0_dataset = 0, t1_dataset = 0;
+	unsigned int count_T0[64], count_T1[64], count_T0_dataset[64], count_T1_dataset[64];
+	char filename[] = "/tmp/des_test_dataset_XXXXXX";
+	int number_of_pairs = 70000; //more than one chunk of the generator
+	DES_DATASET dataset;
+	int pass = 1;
+	int fd, i;
+
+	fd = mkstemp(filename);
+	if(fd < 0)
+	{
+		return(0);
+	}
+	close(fd);
+	plain = malloc(number_of_pairs * DES_BLOCK_SIZE);
+	if(plain == NULL || dataset_create(filename, 5, 8, seed, number_of_pairs, 2) != 0 || dataset_open(filename, &dataset) != 0)
+	{
+		free(plain);
+		unlink(filename);
+		return(0);
+	}
+
+	//the header and the pairs are the ones of the data set
+	dataset_key(5, key);
+	des_key_setup(key, keyschedule, DES_ENCRYPT, 8);
+	counter_plaintexts(seed, 0, number_of_pairs, plain);
+	pass = pass && (dataset.number_of_pairs == number_of_pairs) && (dataset.header->rounds == 8) && (dataset.header->key_id == 5);
+	for(i = 0; i < number_of_pairs; i += 997)
+	{
+		des_crypt(plain[i], cipher, keyschedule, 8);
+		pass = pass && (memcmp(dataset.plain[i], plain[i], DES_BLOCK_SIZE) == 0) && (memcmp(dataset.cipher[i], cipher, DES_BLOCK_SIZE) == 0);
+	}
+
+	//the attacks give the same counts on the mapped pairs
+	algorithm1(plain, keyschedule, &t0, &t1, number_of_pairs, 8, keyguess);
+	algorithm1_dataset(&dataset, &t0_dataset, &t1_dataset, keyguess);
+	pass = pass && (t0 == t0_dataset) && (t1 == t1_dataset);
+	algorithm2_cached(plain, keyschedule, bits, count_T0, count_T1, number_of_pairs, 64);
+	algorithm2_dataset(&dataset, bits_dataset, count_T0_dataset, count_T1_dataset, 64);
+	pass = pass && (memcmp(count_T0, count_T0_dataset, sizeof(count_T0)) == 0) && (memcmp(count_T1, count_T1_dataset, sizeof(count_T1)) == 0);
+	pass = pass && (memcmp(bits, bits_dataset, sizeof(bits)) == 0);
+
+	dataset_close(&dataset);
+	free(plain);
+	unlink(filename);
+	return(pass);
+}
+
+int oracle_test()
+{
+	BYTE seed[DES_BLOCK_SIZE] = {0x01,0x02,0x03,0x04,0x05,0x06,0x07,0x08};
+	BYTE key[DES_BLOCK_SIZE] = {0x40,0x31,0xEC,0xC4,0xA8,0xF6,0x92,0x88};
+	BYTE keyschedule[7][6], plain[2][DES_BLOCK_SIZE], cipher[2][DES_BLOCK_SIZE], expected[DES_BLOCK_SIZE];
+	char path[64];
+	ORACLE_SERVER server;
+	ORACLE_STATS stats;
+	ORACLE_COUNTS counts;
+	int pass = 1;
+	int fd, i;
+
+	snprintf(path, sizeof(path), "/tmp/des_test_oracle_%d", (int)getpid());
+	if(oracle_start(&server, path, key, 7) != 0)
+	{
+		return(0);
+	}
+	fd = oracle_connect(path);
+	des_key_setup(key, keyschedule, DES_ENCRYPT, 7);
+
+	//one request, then a pipeline with a short last request
+	counter_plaintexts(seed, 0, 2, plain);
+	pass = pass && (fd >= 0) && (oracle_encrypt(fd, plain, cipher, 2) == 0);
+	for(i = 0; i < 2; i++)
+	{
+		des_crypt(plain[i], expected, keyschedule, 7);
+		pass = pass && (memcmp(expected, cipher[i], DES_BLOCK_SIZE) == 0);
+	}
+	counts.key_schedule = (const BYTE (*)[6])keyschedule;
+	counts.rounds = 7;
+	counts.mismatches = 0;
+	counts.count_T0 = 0;
+	counts.count_T1 = 0;
+	pass = pass && (oracle_collect(fd, seed, 10000, 1000 - 7, 3, oracle_consume, &counts, &stats) == 0);
+	pass = pass && (counts.mismatches == 0) && (stats.blocks == 10000) && (counts.count_T0 + counts.count_T1 == 10000);
+
+	if(fd >= 0)
+	{
+		close(fd);
+	}
+	oracle_stop(&server);
+	return(pass);
+}
+
+int rainbow_test()
+{
+	BYTE plain[DES_BLOCK_SIZE] = {0x4E,0x6F,0x77,0x20,0x69,0x73,0x20,0x74};
+	BYTE seed[DES_BLOCK_SIZE] = {0x52,0x41,0x49,0x4E,0x42,0x4F,0x57,0x31};
+	BYTE index[1][DES_BLOCK_SIZE], key[DES_BLOCK_SIZE], found[DES_BLOCK_SIZE], keyschedule[16][6], cipher[DES_BLOCK_SIZE], check[DES_BLOCK_SIZE];
+	QWORD base_key = 0x0123456789ABCDEFULL, k;
+	char filename[] = "/tmp/des_test_rainbow_XXXXXX";
+	RAINBOW_TABLE table;
+	RAINBOW_BUILD_STATS build_stats;
+	RAINBOW_LOOKUP_STATS stats;
+	int pass = 1;
+	int fd, i, b;
+
+	fd = mkstemp(filename);
+	if(fd < 0)
+	{
+		return(0);
+	}
+	close(fd);
+
+	//16 key bits, 4 tables with 2^17 keys each, about half of the chains merge, about 98% coverage
+	pass = pass && (rainbow_build(filename, plain, base_key, 16, 16, 64, 2048, 4, 0, &build_stats) == 0);
+	pass = pass && (build_stats.coverage > 0.95) && (build_stats.coverage < rainbow_coverage(16, 64, 2048, 4));
+	pass = pass && (rainbow_open(filename, &table) == 0);
+	memset(&stats, 0, sizeof(stats));
+	for(i = 0; pass && i < 64; i++)
+	{
+		counter_plaintexts(seed, i, 1, index);
+		k = rainbow_key(base_key, 16, block_to_qword(index[0]));
+		for(b = DES_BLOCK_SIZE - 1; b >= 0; b--, k >>= 8)
+			key[b] = k & 0xFF;
+		des_key_setup(key, keyschedule, DES_ENCRYPT, 16);
+		des_crypt(plain, cipher, (const BYTE (*)[6])keyschedule, 16);
+		if(rainbow_lookup(&table, cipher, found, &stats))
+		{
+			des_key_setup(found, keyschedule, DES_ENCRYPT, 16);
+			des_crypt(plain, check, (const BYTE (*)[6])keyschedule, 16);
+			pass = pass && (memcmp(check, cipher, DES_BLOCK_SIZE) == 0);
+		}
+	}
+	pass = pass && (stats.found >= 60);
+	rainbow_close(&table);
+
+	unlink(filename);
+	return(pass);
+}
+
+int shard_test()
+{
+	BYTE seed[DES_BLOCK_SIZE] = {0x01,0x02,0x03,0x04,0x05,0x06,0x07,0x08};
+	BYTE key[DES_BLOCK_SIZE], keyschedule[8][6];
+	BYTE (*plain)[DES_BLOCK_SIZE], (*cipher)[DES_BLOCK_SIZE];
+	unsigned int counter[ALGORITHM2_COUNTER_SIZE];
+	char filename[] = "/tmp/des_test_shard_XXXXXX";
+	SHARD_COUNTERS shards[3], whole, total, read_back;
+	KEY_CANDIDATE candidates[64];
+	int number_of_texts = 150000; //the shards split chunks of shard_count()
+	int pass = 1;
+	int fd, i;
+
+	fd = mkstemp(filename);
+	if(fd < 0)
+	{
+		return(0);
+	}
+	close(fd);
+	plain = malloc(2 * number_of_texts * DES_BLOCK_SIZE);
+	if(plain == NULL)
+	{
+		unlink(filename);
+		return(0);
+	}
+	cipher = plain + number_of_texts;
+
+	//the shards are counted out of order and sum up to the counters of all texts
+	pass = pass && (shard_count(5, seed, 100000, 50000, 2, &shards[0]) == 0);
+	pass = pass && (shard_count(5, seed, 0, 70000, 1, &shards[1]) == 0);
+	pass = pass && (shard_count(5, seed, 70000, 30000, 2, &shards[2]) == 0);
+	pass = pass && (shard_merge(shards, 3, &total) == 0) && (total.header.first_index == 0) && (total.header.number_of_texts == number_of_texts);
+	pass = pass && (shard_count(5, seed, 0, number_of_texts, 0, &whole) == 0);
+	pass = pass && (memcmp(whole.counter, total.counter, sizeof(whole.counter)) == 0);
+
+	//and to the counters of compress_pairs()
+	dataset_key(5, key);
+	des_key_setup(key, keyschedule, DES_ENCRYPT, 8);
+	counter_plaintexts(seed, 0, number_of_texts, plain);
+	encrypt_plaintexts((const BYTE (*)[DES_BLOCK_SIZE])plain, cipher, (const BYTE (*)[6])keyschedule, number_of_texts, 8);
+	memset(counter, 0, sizeof(counter));
+	compress_pairs((const BYTE (*)[DES_BLOCK_SIZE])plain, (const BYTE (*)[DES_BLOCK_SIZE])cipher, counter, number_of_texts);
+	for(i = 0; i < ALGORITHM2_COUNTER_SIZE; i++)
+	{
+		pass = pass && (total.counter[i] == counter[i]);
+	}
+
+	//overlapping shards or other keys are refused
+	shards[2].header.first_index = 60000;
+	pass = pass && (shard_merge(shards, 3, &total) != 0);
+	shards[2].header.first_index = 70000;
+	shards[2].header.key_id = 6;
+	pass = pass && (shard_merge(shards, 3, &total) != 0);
+
+	//the counter file round trip, a biased ranking
+	pass = pass && (shard_write(filename, &whole) == 0) && (shard_read(filename, &read_back) == 0);
+	pass = pass && (memcmp(&whole, &read_back, sizeof(whole)) == 0);
+	pass = pass && (shard_keyguess(&read_back, candidates) == 0) && (candidates[0].bias != 0.0);
+
+	free(plain);
+	unlink(filename);
+	return(pass);
+}
+
+int linear_engine_test()
+{
+	BYTE seed[DES_BLOCK_SIZE] = {0x01,0x02,0x03,0x04,0x05,0x06,0x07,0x08};
+	BYTE des_key[DES_BLOCK_SIZE] = {0x40,0x31,0xEC,0xC4,0xA8,0xF6,0x92,0x88};
+	BYTE spn_key[SPN_KEY_SIZE] = {0x3A,0x94,0xD6,0x3F,0x12,0x7C,0x88,0x01,0xE5,0x2B};
+	BYTE keyschedule[8][6], bits[6];
+	BYTE (*plain)[DES_BLOCK_SIZE];
+	WORD *spn_plain;
+	unsigned int count_T0[SPN_LINEAR_KEYGUESSES], count_T1[SPN_LINEAR_KEYGUESSES], expected_T0[64], expected_T1[64];
+	KEY_CANDIDATE candidates[SPN_LINEAR_KEYGUESSES];
+	int number_of_plains = 20000;
+	int pass = 1;
+	int expected, i;
+
+	plain = malloc(number_of_plains * DES_BLOCK_SIZE);
+	spn_plain = malloc(number_of_plains * sizeof(WORD));
+	if(plain == NULL || spn_plain == NULL)
+	{
+		free(plain);
+		free(spn_plain);
+		return(0);
+	}
+	counter_plaintexts(seed, 0, number_of_plains, plain);
+
+	//the DES instance gives the counts of algorithm2_cached()
+	des_key_setup(des_key, keyschedule, DES_ENCRYPT, 8);
+	expected = algorithm2_cached(plain, keyschedule, bits, expected_T0, expected_T1, number_of_plains, 64);
+	pass = pass && (des8_linear_attack(des_key, plain, number_of_plains, count_T0, count_T1, candidates) == expected);
+	pass = pass && (memcmp(count_T0, expected_T0, sizeof(expected_T0)) == 0) && (memcmp(count_T1, expected_T1, sizeof(expected_T1)) == 0);
+
+	//the SPN instance finds the bits 5-8 and 13-16 of K5
+	for(i = 0; i < number_of_plains; i++)
+	{
+		spn_plain[i] = (plain[i][0] << 8) | plain[i][1];
+	}
+	expected = ((spn_key[8] & 0x0F) << 4) | (spn_key[9] & 0x0F);
+	pass = pass && (spn_linear_attack(spn_key, spn_plain, number_of_plains, count_T0, count_T1, candidates) == expected);
+	pass = pass && (candidates[0].bias > 1.0 / 64 || candidates[0].bias < -1.0 / 64);
+
+	free(plain);
+	free(spn_plain);
+	return(pass);
+}
+
+//Measures the rate of the key search after the 8 round attack. Only the K8 bits and the right side
+//come from the attack, all but KEYSEARCH_DEMO_UNKNOWN_BITS of the other key bits are taken from the
+//actual key, so this is no full key recovery.
+void key_search_benchmark(const BYTE enc_key[], const BYTE iv[], const KEY_CANDIDATE candidates[], BYTE right_side)
+{
+	BYTE target_sboxes[1] = {1};
+	BYTE plain[2][DES_BLOCK_SIZE], cipher[2][DES_BLOCK_SIZE];
+	BYTE schedule[8][6], map[8][48];
+	BYTE key[DES_BLOCK_SIZE];
+	KEY_EQUATION equations[KEYSEARCH_MAX_EQUATIONS];
+	KEY_SEARCH_STATS stats;
+	QWORD master = block_to_qword(enc_key);
+	QWORD unknown = 0;
+	double rate;
+	int number_of_equations = 0;
+	int unknown_bits = 0;
+	int i, b;
+
+	printf("Key search rate benchmark (%d key bits taken from the actual key)...\n", 56 - KEYSEARCH_DEMO_UNKNOWN_BITS);
+	des_key_setup(enc_key, schedule, DES_ENCRYPT, 8);
+	counter_plaintexts(iv, 0, 2, plain);
+	for(i = 0; i < 2; i++)
+	{
+		des_crypt(plain[i], cipher[i], schedule, 8);
+	}
+
+	//the recovered bits: K8 bits of S-Box 1 (set per candidate) and the right side of the approximation
+	equations[number_of_equations++] = approximation_key_equation(builtin_approximation(8), right_side);
+	key_bit_map(map, 8);
+	unknown = equations[0].mask;
+	for(i = 0; i < 6; i++)
+	{
+		unknown |= 1ULL << (63 - map[7][i]);
+	}
+
+	//the benchmark leaves only some more key bits to the search, the rest is taken from the actual key
+	for(b = 0; b < 64; b++)
+	{
+		if((KEYSEARCH_KEY_BITS >> (63 - b)) & 0x01 & ~(unknown >> (63 - b)))
+		{
+			if(__builtin_popcountll(unknown) < KEYSEARCH_DEMO_UNKNOWN_BITS)
+			{
+				unknown |= 1ULL << (63 - b);
+			}
+			else
+			{
+				equations[number_of_equations].mask = 1ULL << (63 - b);
+				equations[number_of_equations].value = (master >> (63 - b)) & 0x01;
+				number_of_equations++;
+			}
+		}
+	}
+	unknown_bits = __builtin_popcountll(unknown);
+
+	memset(&stats, 0, sizeof(stats));
+	if(key_search_ranked(plain, cipher, 2, 8, candidates, KEYSEARCH_DEMO_CANDIDATES, target_sboxes, 1,
+	                     equations, number_of_equations, 0, key, &stats) == 1)
+	{
+		printf("RESULT: Key found with the guess ranked %d (partly given):\t", stats.candidate + 1);
+		for(i = 0; i < DES_BLOCK_SIZE; i++)
+		{
+			printf(" %02X", key[i]);
+		}
+		printf("\n");
+	}
+	else
+	{
+		printf("RESULT: No key found with the best %d guesses\n", KEYSEARCH_DEMO_CANDIDATES);
+	}
+	rate = stats.keys_tested / stats.seconds;
+	printf("\tSearched %d unknown key bits: %llu keys in %.2f s (%.2e keys/s)\n", unknown_bits, stats.keys_tested, stats.seconds, rate);
+	printf("\tExtrapolated at this rate, a real recovery would search 2^49 keys per guess: %.1f hours\n", (double)(1ULL << 49) / rate / 3600.0);
+	printf("\tActual key (without parity bits):\t");
+	for(i = 0; i < DES_BLOCK_SIZE; i++)
+	{
+		printf(" %02X", enc_key[i] & 0xFE);
+	}
+	printf("\n");
 }
 
 int three_round_attack()
@@ -261,7 +1119,7 @@ int seven_round_attack()
 	unsigned int count_T0 = 0;
 	unsigned int count_T1 = 0;
 	int number_of_plaintexts = 300000;
-	BYTE plaintext_array[number_of_plaintexts][DES_BLOCK_SIZE];
+	ALGORITHM1_STREAM stream;
 	BYTE iv[DES_BLOCK_SIZE] = {0x07,0x22,0xEE,0xA2,0x7F,0x60,0x99,0x1A}; //for the random plaintext generation
 	BYTE enc_key[DES_BLOCK_SIZE] = {0x40,0x31,0xEC,0xC4,0xA8,0xF6,0x92,0x88}; //the encryption key
 	BYTE key_schedule[rounds][6];
@@ -274,16 +1132,29 @@ int seven_round_attack()
 	BYTE subkey5[6];
 	BYTE subkey7[6];
 
-	create_plaintexts(iv, number_of_plaintexts, plaintext_array);
-	//print_plaintexts(number_of_plaintexts, plaintext_array);
-
 	des_key_setup(enc_key, key_schedule, DES_ENCRYPT,rounds);
-	algorithm1(plaintext_array, key_schedule, &count_T0, &count_T1, number_of_plaintexts, rounds, key_schedule[0]);
-	if((count_T0 == -1)&&(count_T1 == -1))
+
+	//count the plaintexts chunk by chunk while the next ones are generated
+	printf("Streaming %d plaintexts...\n", number_of_plaintexts);
+	stream.key_schedule = (const BYTE (*)[6])key_schedule;
+	stream.rounds = rounds;
+	stream.count_T0 = 0;
+	stream.count_T1 = 0;
+	stream.error = 0;
+	if(stream_plaintexts(iv, number_of_plaintexts, algorithm1_consume, &stream) != 0)
 	{
-		printf("ERROR: algorithm 1 only works with 3,5 or 7 rounds!\n");
+		if(stream.error)
+		{
+			printf("ERROR: algorithm 1 only works with 3,5 or 7 rounds!\n");
+		}
+		else
+		{
+			printf("ERROR: could not start the plaintext stream!\n");
+		}
 		return 1;
 	}
+	count_T0 = stream.count_T0;
+	count_T1 = stream.count_T1;
 	if(count_T0 > count_T1)
 	{
 		bias = (float)count_T0 / (float)number_of_plaintexts;
@@ -330,9 +1201,14 @@ int eight_round_attack()
 	BYTE guessedkey8bits[6];
 	BYTE keyschedule[8][6];
 	BYTE subkey8[6];
-	BYTE plaintext_array[number_of_plaintexts][DES_BLOCK_SIZE];
+	ALGORITHM2_STREAM stream;
 	BYTE iv[DES_BLOCK_SIZE] = {0x08,0x55,0xA2,0x78,0x87,0xDD,0x2C,0xBC}; //for the random plaintext generation
 	BYTE enc_key[DES_BLOCK_SIZE] = {0x96,0x4B,0xEA,0x19,0x50,0xF0,0x1F,0x36}; //the encryption key
+	BYTE target_sboxes[1] = {1};
+	long long histogram[64];
+	KEY_CANDIDATE candidates[64];
+
+	STATS_TIMER(timer);
 
 	//just for checking the results
 	BYTE subkey1[6];
@@ -341,17 +1217,46 @@ int eight_round_attack()
 	BYTE subkey5[6];
 	BYTE subkey7[6];
 
-	create_plaintexts(iv, number_of_plaintexts, plaintext_array);
-	//print_plaintexts(number_of_plaintexts, plaintext_array);
-
 	des_key_setup(enc_key, keyschedule, DES_ENCRYPT, 8);
 
+	//encrypt and compress the plaintexts chunk by chunk while the next ones are generated
+	STATS_BEGIN(timer);
+	printf("Streaming %d plaintexts...\n", number_of_plaintexts);
+	stream.keyschedule = (const BYTE (*)[6])keyschedule;
+	stream.ciphertexts = malloc(STREAM_CHUNK_SIZE * DES_BLOCK_SIZE);
+	memset(stream.counter, 0, sizeof(stream.counter));
+	if(stream.ciphertexts == NULL || stream_plaintexts(iv, number_of_plaintexts, algorithm2_consume, &stream) != 0)
+	{
+		printf("ERROR: the plaintext stream failed!\n");
+		free(stream.ciphertexts);
+		return 1;
+	}
+	free(stream.ciphertexts);
+
 	printf("Guessing the key...\n");
-    correct_guess = algorithm2(plaintext_array, keyschedule, guessedkey8bits, count_T0, count_T1, number_of_plaintexts, key_guesses);
+	evaluate_keyguesses(stream.counter, count_T0, count_T1, key_guesses);
+    correct_guess = select_keyguess(guessedkey8bits, count_T0, count_T1, key_guesses);
+    STATS_END(STATS_ALGORITHM2, timer, number_of_plaintexts, key_guesses, STREAM_CHUNK_SIZE * DES_BLOCK_SIZE);
 
     printf("RESULT: Guessed bits 42-47 of the SubKey K8:\t%01X %01X %01X %01X %01X %01X\n", guessedkey8bits[0], guessedkey8bits[1], guessedkey8bits[2],
     		guessedkey8bits[3], guessedkey8bits[4], guessedkey8bits[5]);
 
+    //ranking of all guesses for S-Box 1 of round 8, F(R8,K8)[15] is the only F bit used.
+    //The counter already holds the signed histogram over the S-Box 1 input.
+    for(i = 0; i < 64; i++)
+    {
+    	histogram[i] = (long long)stream.counter[i] - (long long)stream.counter[64 + i];
+    }
+    if(fwht_keyguess(histogram, 0x00008000, target_sboxes, 1, number_of_plaintexts, candidates) == 0)
+    {
+    	printf("\tBest ranked guesses (FWHT):");
+    	for(i = 0; i < 4; i++)
+    	{
+    		printf(" %02X (%+f)", candidates[i].guess, candidates[i].bias);
+    	}
+    	printf("\n");
+    }
+
     for(i = 0; i < 6; i++)
     {
     	subkey8[i] = keyschedule[7][i];
@@ -394,16 +1299,268 @@ int eight_round_attack()
     	BYTE result = K1_19 ^ K1_23 ^ K3_22 ^ K5_22 ^ K7_22 ^ K4_44;
     	printf("\tActual result of the right side: %01X\n", result);
 
+    key_search_benchmark(enc_key, iv, candidates, count_T0[correct_guess] > count_T1[correct_guess] ? 0 : 1);
+
+	return 0;
+}
+
+int multiple_linear_attack()
+{
+	printf("\nStarting multiple linear 8 round attack...\n");
+	int number_of_plaintexts = 262144; //~2^18, a quarter of the data of the single approximation attack
+	LINEAR_APPROXIMATION approx[KEYGUESS_MAX_APPROX];
+	double weight[KEYGUESS_MAX_APPROX];
+	BYTE keyschedule[8][6];
+	BYTE iv[DES_BLOCK_SIZE] = {0x08,0x55,0xA2,0x78,0x87,0xDD,0x2C,0xBC};
+	BYTE enc_key[DES_BLOCK_SIZE] = {0x96,0x4B,0xEA,0x19,0x50,0xF0,0x1F,0x36};
+	BYTE target_sboxes[1] = {1};
+	KEY_CANDIDATE single[64], multiple[64];
+	MULTIPLE_STREAM *stream;
+	WORD actual;
+	int rank_single = 0, rank_multiple = 0;
+	int number_of_approx;
+	int i;
+
+	//the 8 round approximation with all other round 1 approximations of S-Box 5
+	number_of_approx = round1_variants(builtin_approximation(8), approx, weight, KEYGUESS_MAX_APPROX);
+	printf("Combining %d approximations...\n", number_of_approx);
+
+	des_key_setup(enc_key, keyschedule, DES_ENCRYPT, 8);
+	printf("Streaming %d plaintexts...\n", number_of_plaintexts);
+	stream = calloc(1, sizeof(MULTIPLE_STREAM));
+	if(stream == NULL || number_of_approx < 1)
+	{
+		free(stream);
+		return 1;
+	}
+	stream->keyschedule = (const BYTE (*)[6])keyschedule;
+	stream->ciphertexts = malloc(STREAM_CHUNK_SIZE * DES_BLOCK_SIZE);
+	stream->approx = approx;
+	stream->number_of_approx = number_of_approx;
+	if(stream->ciphertexts == NULL || stream_plaintexts(iv, number_of_plaintexts, multiple_consume, stream) != 0)
+	{
+		printf("ERROR: the plaintext stream failed!\n");
+		free(stream->ciphertexts);
+		free(stream);
+		return 1;
+	}
+	free(stream->ciphertexts);
+
+	//histogram 0 belongs to the original approximation
+	if(fwht_keyguess(stream->histograms, approx[0].fmask, target_sboxes, 1, number_of_plaintexts, single) != 0
+	   || multiple_keyguess(stream->histograms, approx, weight, number_of_approx, target_sboxes, 1, number_of_plaintexts, multiple) != 0)
+	{
+		printf("ERROR: could not rank the key guesses!\n");
+		free(stream);
+		return 1;
+	}
+	free(stream);
+
+	actual = keyschedule[7][0] >> 2;
+	for(i = 0; i < 64; i++)
+	{
+		if(single[i].guess == actual)
+		{
+			rank_single = i + 1;
+		}
+		if(multiple[i].guess == actual)
+		{
+			rank_multiple = i + 1;
+		}
+	}
+	printf("RESULT: Best ranked guesses (combined):");
+	for(i = 0; i < 4; i++)
+	{
+		printf(" %02X (%f)", multiple[i].guess, multiple[i].bias);
+	}
+	printf("\n\tRank of the actual K8 bits %02X: %d with one approximation, %d combined\n", actual, rank_single, rank_multiple);
+
+	return 0;
+}
+
+int sequential_attack()
+{
+	printf("\nStarting sequential 7 and 8 round attacks...\n");
+	int number_of_plaintexts = 2097152; //~2^21, the most the tests may use
+	SEQUENTIAL_TEST test;
+	SEQUENTIAL_RESULT result;
+	BYTE (*plaintexts)[DES_BLOCK_SIZE];
+	BYTE keyschedule[8][6];
+	BYTE iv[DES_BLOCK_SIZE] = {0x08,0x55,0xA2,0x78,0x87,0xDD,0x2C,0xBC};
+	BYTE enc_key7[DES_BLOCK_SIZE] = {0x40,0x31,0xEC,0xC4,0xA8,0xF6,0x92,0x88}; //the keys of the 7 and 8 round attacks
+	BYTE enc_key8[DES_BLOCK_SIZE] = {0x96,0x4B,0xEA,0x19,0x50,0xF0,0x1F,0x36};
+	BYTE key8bits[6];
+	unsigned int count_T0[64], count_T1[64];
+	int right_side, guess;
+
+	plaintexts = malloc(number_of_plaintexts * DES_BLOCK_SIZE);
+	if(plaintexts == NULL)
+	{
+		return 1;
+	}
+	counter_plaintexts(iv, 0, number_of_plaintexts, plaintexts);
+
+	//7 rounds, Matsui's bias 1.95 * 2^-10
+	test.bias = 1.95 / 1024;
+	test.error = 0.05;
+	test.chunk_size = 0;
+	des_key_setup(enc_key7, keyschedule, DES_ENCRYPT, 7);
+	count_T0[0] = 0;
+	count_T1[0] = 0;
+	right_side = algorithm1_sequential(plaintexts, keyschedule, &count_T0[0], &count_T1[0], number_of_plaintexts, 7, keyschedule[0], &test, &result);
+	printf("RESULT: 7 round right side %d after %d texts (|T0 - T1| threshold %.0f%s), actual %d\n", right_side, result.number_of_plains,
+			sequential_threshold(&test), result.stopped ? "" : ", not reached", approximation_right_side(builtin_approximation(7), (const BYTE (*)[6])keyschedule));
+
+	//8 rounds, the bias of the 7 round approximation the key guess extends,
+	//tested less often since every test evaluates all key guesses
+	test.chunk_size = 65536;
+	des_key_setup(enc_key8, keyschedule, DES_ENCRYPT, 8);
+	guess = algorithm2_sequential(plaintexts, keyschedule, key8bits, count_T0, count_T1, number_of_plaintexts, 64, &test, &result);
+	printf("RESULT: 8 round K8 guess %02X after %d texts%s, actual %02X\n", guess, result.number_of_plains,
+			result.stopped ? "" : " (all texts used)", keyschedule[7][0] >> 2);
+
+	free(plaintexts);
+	return 0;
+}
+
+int oracle_attack()
+{
+	printf("\nStarting 7 round attack with the texts of the oracle...\n");
+	int number_of_plaintexts = 300000;
+	BYTE iv[DES_BLOCK_SIZE] = {0x07,0x22,0xEE,0xA2,0x7F,0x60,0x99,0x1A};
+	BYTE enc_key[DES_BLOCK_SIZE] = {0x40,0x31,0xEC,0xC4,0xA8,0xF6,0x92,0x88}; //only the oracle knows the key
+	char path[64];
+	ORACLE_SERVER server;
+	ORACLE_STATS stats;
+	ORACLE_COUNTS counts;
+	int fd, result;
+
+	snprintf(path, sizeof(path), "/tmp/des_test_oracle_%d", (int)getpid());
+	if(oracle_start(&server, path, enc_key, 7) != 0)
+	{
+		printf("ERROR: could not start the oracle!\n");
+		return 1;
+	}
+	fd = oracle_connect(path);
+	counts.key_schedule = NULL;
+	counts.rounds = 7;
+	counts.count_T0 = 0;
+	counts.count_T1 = 0;
+	result = (fd >= 0) ? oracle_collect(fd, iv, number_of_plaintexts, ORACLE_BATCH, ORACLE_DEPTH, oracle_consume, &counts, &stats) : -1;
+	if(fd >= 0)
+	{
+		close(fd);
+	}
+	oracle_stop(&server);
+	if(result != 0)
+	{
+		printf("ERROR: the oracle stopped answering!\n");
+		return 1;
+	}
+
+	printf("RESULT: The right side (K1[19,23] XOR K3,5,7[22] XOR K4[44]) is %01X!\n", counts.count_T0 > counts.count_T1 ? 0x00 : 0x01);
+	printf("\tT0: %d - T1: %d\n", counts.count_T0, counts.count_T1);
+	printf("\t%llu blocks in %llu requests: %.2f Mblocks/s, latency mean %.3f ms, max %.3f ms\n", stats.blocks, stats.requests,
+			stats.blocks / stats.seconds / 1e6, 1e3 * stats.latency_mean, 1e3 * stats.latency_max);
+	printf("\tcollection %.3f s (waiting %.3f s), counting %.3f s\n", stats.seconds, stats.wait_seconds, stats.consume_seconds);
+
+	return 0;
+}
+
+int differential_round_attack(int rounds, int number_of_pairs)
+{
+	printf("\nStarting differential %d round attack...\n", rounds);
+	const DIFFERENTIAL_CHARACTERISTIC *characteristic = builtin_characteristic(rounds);
+	DIFFERENTIAL_COUNTERS counters;
+	BYTE keyschedule[16][6];
+	BYTE seed[DES_BLOCK_SIZE] = {0x08,0x55,0xA2,0x78,0x87,0xDD,0x2C,0xBC}; //for the chosen plaintext generation
+	BYTE enc_key[DES_BLOCK_SIZE] = {0x96,0x4B,0xEA,0x19,0x50,0xF0,0x1F,0x36}; //the encryption key
+	BYTE guesses[64];
+	BYTE actual;
+	struct timespec start;
+	int t, s, rank;
+
+	if(characteristic == NULL)
+	{
+		printf("ERROR: no differential attack on %d rounds!\n", rounds);
+		return 1;
+	}
+	printf("Characteristic over %d rounds with probability 1/%.0f, encrypting %d pairs...\n", characteristic->rounds,
+			1.0 / characteristic_probability(characteristic), number_of_pairs);
+	des_key_setup(enc_key, keyschedule, DES_ENCRYPT, rounds);
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	if(differential_attack(seed, (const BYTE (*)[6])keyschedule, rounds, characteristic, number_of_pairs, 0, &counters) != 0)
+	{
+		printf("ERROR: no differential attack on %d rounds!\n", rounds);
+		return 1;
+	}
+	printf("\t%llu of %llu pairs passed the filter (%.2f s)\n", counters.right_pairs, counters.pairs, seconds_since(&start));
+
+	printf("RESULT: Guessed bits of the SubKey K%d (rank of the actual bits):\n", rounds);
+	for(t = 0; t < counters.number_of_sboxes; t++)
+	{
+		s = counters.sboxes[t];
+		actual = (subkey_to_qword(keyschedule[rounds - 1]) >> (42 - 6 * (s - 1))) & 0x3F;
+		differential_keyguess(&counters, t, guesses);
+		for(rank = 0; guesses[rank] != actual; rank++);
+		printf("\tS-Box %d: %02X (%d), actual %02X\n", s, guesses[0], rank + 1, actual);
+	}
+
 	return 0;
 }
 
 int main()
 {
+	int i;
+	int pass = 1;
+
+	//phase statistics of all tests and attacks, DES_STATS_FILE=<file> (.prom for Prometheus text) writes them at exit
+	stats_dump_at_exit(getenv("DES_STATS_FILE"));
+
 	//for checking the correctness of the DES implementation
 	//printf("DES test with 3 rounds: %s\n\n", des_test(3) ? "SUCCEEDED" : "FAILED");
 	//printf("DES test with 5 rounds: %s\n\n", des_test(5) ? "SUCCEEDED" : "FAILED");
 	//printf("DES test with 7 rounds: %s\n\n", des_test(7) ? "SUCCEEDED" : "FAILED");
 
+	//for checking the bitsliced DES against des_crypt
+	for(i = 1; i <= 16; i++)
+	{
+		pass = pass && des_bitslice_test(i);
+	}
+	printf("Bitsliced DES test with 1-16 rounds: %s\n", pass ? "SUCCEEDED" : "FAILED");
+
+	//for checking the table-driven DES against the reference functions
+	printf("Table-driven DES test: %s\n", des_table_test() ? "SUCCEEDED" : "FAILED");
+
+	//for checking the mask based approximations against the bit extraction and the text format
+	printf("Linear approximation test: %s\n", des_linear_test() ? "SUCCEEDED" : "FAILED");
+
+	//for checking the multi-threaded algorithms against the serial ones
+	printf("Parallel algorithm 1/2 test: %s\n", parallel_test() ? "SUCCEEDED" : "FAILED");
+
+	//for checking that any range of the counter mode plaintexts can be generated on its own
+	printf("Plaintext stream test: %s\n", stream_test() ? "SUCCEEDED" : "FAILED");
+
+	//for checking the Walsh-Hadamard key ranking against the counts of algorithm 2
+	printf("Key guess test: %s\n", keyguess_test() ? "SUCCEEDED" : "FAILED");
+
+	//for checking the key bit mapping and the key search
+	printf("Key search test: %s\n", key_search_test() ? "SUCCEEDED" : "FAILED");
+
+	//for checking the difference tables and the characteristics
+	printf("Differential test: %s\n", differential_test() ? "SUCCEEDED" : "FAILED");
+
+	//for checking the oracle against des_crypt
+	printf("Oracle test: %s\n", oracle_test() ? "SUCCEEDED" : "FAILED");
+
+	//for checking the rainbow table lookups of a 16 bit key space
+	printf("Rainbow table test: %s\n", rainbow_test() ? "SUCCEEDED" : "FAILED");
+
+	//for checking the data set files against the generated pairs
+	printf("Data set test: %s\n", dataset_test() ? "SUCCEEDED" : "FAILED");
+	printf("Shard test: %s\n", shard_test() ? "SUCCEEDED" : "FAILED");
+	printf("Linear engine test: %s\n", linear_engine_test() ? "SUCCEEDED" : "FAILED");
+
     //3 ROUND ATTACK
     three_round_attack();
 	//5 ROUND ATTACK
@@ -412,6 +1569,15 @@ int main()
     seven_round_attack();
     //8 ROUND ATTACK
     eight_round_attack();
+    //8 ROUND ATTACK WITH MULTIPLE APPROXIMATIONS
+    multiple_linear_attack();
+    //7 ROUND ATTACK WITH A SEPARATE ORACLE
+    oracle_attack();
+    //7 AND 8 ROUND ATTACKS THAT STOP EARLY
+    sequential_attack();
+    //DIFFERENTIAL 6 AND 8 ROUND ATTACKS
+    differential_round_attack(6, 4096);
+    differential_round_attack(8, 4194304);
 
 	return(0);
 }
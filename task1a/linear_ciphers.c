@@ -0,0 +1,93 @@
+/*********************************************************************
+* Filename:   linear_ciphers.c
+* Copyright:
+* Disclaimer: This code is presented "as is" without any guarantees.
+* Details:    Cipher and approximation policies for linear_engine.h
+              and the instances for 8 round DES and Heys' SPN.
+*********************************************************************/
+
+/*************************** HEADER FILES ***************************/
+#include "linear_ciphers.h"
+#include "des_linear.h"
+#include "des_table.h"
+
+/**************************** DATA TYPES ****************************/
+typedef BYTE DES8_BLOCK[DES_BLOCK_SIZE];
+typedef BYTE DES8_SCHEDULE[8][6];
+typedef WORD SPN_SCHEDULE[SPN_ROUNDS + 1];
+
+/*********************** FUNCTION DEFINITIONS ***********************/
+// The 6 bits of R8 entering S-Box 1 (SBOX1_INPUT() in des.c)
+static inline WORD des8_sbox1_input(const BYTE cipher[])
+{
+	WORD r = ((WORD)cipher[4] << 24) | (cipher[5] << 16) | (cipher[6] << 8) | cipher[7];
+
+	return ((r & 0x01) << 5) | (r >> 27);
+}
+
+// F(R8,K8) for the S-Box 1 input bits and the guess of K8 bits 42-47, the other F bits are 0
+static inline WORD des8_f_sbox1(WORD input, WORD guess)
+{
+	const BYTE keyguess[6] = {(guess << 2) & 0xFC, 0x00, 0x00, 0x00, 0x00, 0x00};
+
+	return f(((input >> 5) & 0x01) | ((input & 0x1F) << 27), keyguess);
+}
+
+static inline WORD spn_active_bits(WORD cipher)
+{
+	return ((cipher >> 4) & 0xF0) | (cipher & 0x0F);
+}
+
+// U4 bits 5-8 and 13-16 from the C bits 5-8 and 13-16 and the K5 guess
+static inline WORD spn_partial_decrypt(WORD active, WORD guess)
+{
+	WORD v = active ^ guess;
+
+	return (spn_sbox_inverse[v >> 4] << 4) | spn_sbox_inverse[v & 0x0F];
+}
+
+/***** 8 round DES *****/
+#define LINEAR_ENGINE_NAME des8_engine
+#define LINEAR_ENGINE_BLOCK DES8_BLOCK
+#define LINEAR_ENGINE_SCHEDULE DES8_SCHEDULE
+#define LINEAR_ENGINE_KEY_SETUP(k, s) des_key_setup_table((k), *(s), DES_ENCRYPT, 8)
+#define LINEAR_ENGINE_ENCRYPT_BLOCKS(p, c, s, n) des_crypt_blocks((p), (c), *(s), (n), 8)
+#define LINEAR_ENGINE_PARITY(b, m) __builtin_parityll(block_to_qword(b) & (m))
+#define LINEAR_ENGINE_ACTIVE_BITS 6
+#define LINEAR_ENGINE_EXTRACT(c) des8_sbox1_input(c)
+#define LINEAR_ENGINE_GUESS_BITS 6
+#define LINEAR_ENGINE_PARTIAL_DECRYPT(a, g) des8_f_sbox1((a), (g))
+// L0[7,18,24] ^ R0[12,16] ^ L7[15] ^ R7[7,18,24,29] ^ F(R8,K8)[15], builtin_approximation(8)
+#define LINEAR_ENGINE_PLAIN_MASK (1ULL << 39 | 1ULL << 50 | 1ULL << 56 | 1ULL << 12 | 1ULL << 16)
+#define LINEAR_ENGINE_CIPHER_MASK (1ULL << 47 | 1ULL << 7 | 1ULL << 18 | 1ULL << 24 | 1ULL << 29)
+#define LINEAR_ENGINE_PARTIAL_MASK 0x00008000
+#include "linear_engine.h"
+
+int des8_linear_attack(const BYTE key[], const BYTE plain[][DES_BLOCK_SIZE], int number_of_plains,
+                       unsigned int count_T0[], unsigned int count_T1[], KEY_CANDIDATE candidates[])
+{
+	return des8_engine_attack(key, plain, number_of_plains, count_T0, count_T1, candidates);
+}
+
+/***** Heys' SPN *****/
+#define LINEAR_ENGINE_NAME spn_engine
+#define LINEAR_ENGINE_BLOCK WORD
+#define LINEAR_ENGINE_SCHEDULE SPN_SCHEDULE
+#define LINEAR_ENGINE_KEY_SETUP(k, s) spn_key_setup((k), *(s))
+#define LINEAR_ENGINE_ENCRYPT_BLOCKS(p, c, s, n) spn_encrypt_blocks((p), (c), *(s), (n))
+#define LINEAR_ENGINE_PARITY(b, m) __builtin_parity((b) & (m))
+#define LINEAR_ENGINE_ACTIVE_BITS 8
+#define LINEAR_ENGINE_EXTRACT(c) spn_active_bits(c)
+#define LINEAR_ENGINE_GUESS_BITS 8
+#define LINEAR_ENGINE_PARTIAL_DECRYPT(a, g) spn_partial_decrypt((a), (g))
+// P5 ^ P7 ^ P8 ^ U4[6,8,14,16]
+#define LINEAR_ENGINE_PLAIN_MASK 0x0B00
+#define LINEAR_ENGINE_CIPHER_MASK 0x0000
+#define LINEAR_ENGINE_PARTIAL_MASK 0x55
+#include "linear_engine.h"
+
+int spn_linear_attack(const BYTE key[], const WORD plain[], int number_of_plains,
+                      unsigned int count_T0[], unsigned int count_T1[], KEY_CANDIDATE candidates[])
+{
+	return spn_engine_attack(key, plain, number_of_plains, count_T0, count_T1, candidates);
+}
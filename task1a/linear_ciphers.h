@@ -0,0 +1,34 @@
+/*********************************************************************
+* Filename:   linear_ciphers.h
+* Copyright:
+* Disclaimer: This code is presented "as is" without any guarantees.
+* Details:    Defines the API for the instances of the cipher
+              independent linear attack (linear_engine.h). Every
+              function encrypts the plaintexts under the key once,
+              counts them and ranks all guesses of the last round key
+              bits, it returns the best guess.
+*********************************************************************/
+
+#ifndef LINEAR_CIPHERS_H
+#define LINEAR_CIPHERS_H
+
+/*************************** HEADER FILES ***************************/
+#include "des.h"
+#include "des_keyguess.h"
+#include "spn.h"
+
+/****************************** MACROS ******************************/
+#define DES8_LINEAR_KEYGUESSES 64
+#define SPN_LINEAR_KEYGUESSES 256
+
+/*********************** FUNCTION DECLARATIONS **********************/
+// 8 round DES with the approximation of compute_left_side(), the guesses are the bits 42-47
+// of K8 and the counts are the ones of algorithm2_cached()
+int des8_linear_attack(const BYTE key[], const BYTE plain[][DES_BLOCK_SIZE], int number_of_plains,
+                       unsigned int count_T0[], unsigned int count_T1[], KEY_CANDIDATE candidates[]);
+// Heys' SPN with P5 ^ P7 ^ P8 ^ U4[6,8,14,16] (bias 1/32), U4 being the input of the round 4
+// S-Boxes. A guess is the bits 5-8 of K5 in its high and the bits 13-16 in its low nibble.
+int spn_linear_attack(const BYTE key[], const WORD plain[], int number_of_plains,
+                      unsigned int count_T0[], unsigned int count_T1[], KEY_CANDIDATE candidates[]);
+
+#endif   // LINEAR_CIPHERS_H
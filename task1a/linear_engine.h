@@ -0,0 +1,155 @@
+/*********************************************************************
+* Filename:   linear_engine.h
+* Copyright:
+* Disclaimer: This code is presented "as is" without any guarantees.
+* Details:    Cipher independent version of the encrypt-once algorithm
+              2 (encrypt_plaintexts(), compress_pairs() and
+              evaluate_keyguesses()). The file is a template: it is
+              included once per cipher and approximation with the
+              LINEAR_ENGINE_* macros below defined, and generates static
+              inline functions whose names start with LINEAR_ENGINE_NAME.
+              The hooks are expanded in the generated code, so every
+              instance is compiled for its cipher without function
+              pointers. The macros are undefined at the end.
+
+              Cipher policy:
+              LINEAR_ENGINE_BLOCK                 type of one block
+              LINEAR_ENGINE_SCHEDULE              type of the key schedule
+              LINEAR_ENGINE_KEY_SETUP(k, s)       key bytes k into *s
+              LINEAR_ENGINE_ENCRYPT_BLOCKS(p, c, s, n)
+              LINEAR_ENGINE_PARITY(b, m)          parity of the bits of block b in mask m
+              LINEAR_ENGINE_ACTIVE_BITS           ciphertext bits the partial decryption reads
+              LINEAR_ENGINE_EXTRACT(c)            these bits of c, 0 .. 2^ACTIVE_BITS-1
+              LINEAR_ENGINE_GUESS_BITS            guessed last round key bits
+              LINEAR_ENGINE_PARTIAL_DECRYPT(a, g) state bits before the last round
+                                                  for the extracted bits a and guess g
+              Approximation policy:
+              LINEAR_ENGINE_PLAIN_MASK, LINEAR_ENGINE_CIPHER_MASK
+              LINEAR_ENGINE_PARTIAL_MASK          mask on PARTIAL_DECRYPT()
+
+              P[plain mask] ^ C[cipher mask] ^ PARTIAL_DECRYPT(C, K)[partial mask]
+              is counted like the 8 round approximation of DES.
+*********************************************************************/
+
+/*************************** HEADER FILES ***************************/
+#include <stdlib.h>
+#include "des.h"
+#include "des_keyguess.h"
+
+/****************************** MACROS ******************************/
+#ifndef LINEAR_ENGINE_H
+#define LINEAR_ENGINE_H
+
+#define LINEAR_ENGINE_BATCH 256         // blocks encrypted per call of the cipher in *_count()
+#define LINEAR_ENGINE_PASTE(a, b) a##_##b
+#define LINEAR_ENGINE_EXPAND(a, b) LINEAR_ENGINE_PASTE(a, b)
+#define LINEAR_ENGINE_FUNC(name) LINEAR_ENGINE_EXPAND(LINEAR_ENGINE_NAME, name)
+
+// Fills and ranks the candidates like fwht_keyguess(), bias = (T0 - T1) / (2 * number of texts)
+static inline void linear_engine_rank(const unsigned int count_T0[], const unsigned int count_T1[], int keyguesses,
+                                      int number_of_plains, KEY_CANDIDATE candidates[])
+{
+	int i;
+
+	for (i = 0; i < keyguesses; ++i) {
+		candidates[i].guess = i;
+		candidates[i].bias = ((double)count_T0[i] - (double)count_T1[i]) / (2.0 * number_of_plains);
+	}
+	rank_candidates(candidates, keyguesses);
+}
+#endif   // LINEAR_ENGINE_H
+
+#if !defined(LINEAR_ENGINE_NAME) || !defined(LINEAR_ENGINE_BLOCK) || !defined(LINEAR_ENGINE_SCHEDULE) \
+    || !defined(LINEAR_ENGINE_KEY_SETUP) || !defined(LINEAR_ENGINE_ENCRYPT_BLOCKS) || !defined(LINEAR_ENGINE_PARITY) \
+    || !defined(LINEAR_ENGINE_ACTIVE_BITS) || !defined(LINEAR_ENGINE_EXTRACT) || !defined(LINEAR_ENGINE_GUESS_BITS) \
+    || !defined(LINEAR_ENGINE_PARTIAL_DECRYPT) || !defined(LINEAR_ENGINE_PLAIN_MASK) || !defined(LINEAR_ENGINE_CIPHER_MASK) \
+    || !defined(LINEAR_ENGINE_PARTIAL_MASK)
+#error "linear_engine.h needs the cipher and approximation policy macros"
+#endif
+
+/**************************** DATA TYPES ****************************/
+enum {
+	// [parity << ACTIVE_BITS | extracted bits], like ALGORITHM2_COUNTER_SIZE
+	LINEAR_ENGINE_FUNC(COUNTER_SIZE) = 2 << LINEAR_ENGINE_ACTIVE_BITS,
+	LINEAR_ENGINE_FUNC(KEYGUESSES) = 1 << LINEAR_ENGINE_GUESS_BITS
+};
+
+/*********************** FUNCTION DEFINITIONS ***********************/
+// Adds the already encrypted pairs to the counter (compress_pairs())
+static inline void LINEAR_ENGINE_FUNC(compress)(const LINEAR_ENGINE_BLOCK plain[], const LINEAR_ENGINE_BLOCK cipher[],
+                                                unsigned int counter[], int number_of_plains)
+{
+	unsigned int parity;
+	int i;
+
+	for (i = 0; i < number_of_plains; ++i) {
+		parity = (LINEAR_ENGINE_PARITY(plain[i], LINEAR_ENGINE_PLAIN_MASK) ^ LINEAR_ENGINE_PARITY(cipher[i], LINEAR_ENGINE_CIPHER_MASK)) & 0x01;
+		counter[(parity << LINEAR_ENGINE_ACTIVE_BITS) | LINEAR_ENGINE_EXTRACT(cipher[i])] += 1;
+	}
+}
+
+// Encrypts the plaintexts batch by batch and adds them to the counter
+static inline void LINEAR_ENGINE_FUNC(count)(const LINEAR_ENGINE_BLOCK plain[], const LINEAR_ENGINE_SCHEDULE *schedule,
+                                             unsigned int counter[], int number_of_plains)
+{
+	LINEAR_ENGINE_BLOCK cipher[LINEAR_ENGINE_BATCH];
+	int i, batch;
+
+	for (i = 0; i < number_of_plains; i += batch) {
+		batch = (number_of_plains - i < LINEAR_ENGINE_BATCH) ? number_of_plains - i : LINEAR_ENGINE_BATCH;
+		LINEAR_ENGINE_ENCRYPT_BLOCKS(&plain[i], cipher, schedule, batch);
+		LINEAR_ENGINE_FUNC(compress)(&plain[i], (const LINEAR_ENGINE_BLOCK *)cipher, counter, batch);
+	}
+}
+
+// T0/T1 of every guess from the counter (evaluate_keyguesses())
+static inline void LINEAR_ENGINE_FUNC(evaluate)(const unsigned int counter[], unsigned int count_T0[], unsigned int count_T1[])
+{
+	unsigned int solution;
+	int guess, idx;
+
+	for (guess = 0; guess < LINEAR_ENGINE_FUNC(KEYGUESSES); ++guess) {
+		count_T0[guess] = 0;
+		count_T1[guess] = 0;
+		for (idx = 0; idx < LINEAR_ENGINE_FUNC(COUNTER_SIZE); ++idx) {
+			solution = ((idx >> LINEAR_ENGINE_ACTIVE_BITS) ^ __builtin_parityll(LINEAR_ENGINE_PARTIAL_DECRYPT(idx & ((1 << LINEAR_ENGINE_ACTIVE_BITS) - 1), guess)
+			            & LINEAR_ENGINE_PARTIAL_MASK)) & 0x01;
+			if (solution == 0)
+				count_T0[guess] += counter[idx];
+			else
+				count_T1[guess] += counter[idx];
+		}
+	}
+}
+
+// Algorithm 2 under the key bytes: returns the best guess, candidates holds all guesses ranked
+static inline int LINEAR_ENGINE_FUNC(attack)(const BYTE key[], const LINEAR_ENGINE_BLOCK plain[], int number_of_plains,
+                                             unsigned int count_T0[], unsigned int count_T1[], KEY_CANDIDATE candidates[])
+{
+	LINEAR_ENGINE_SCHEDULE schedule;
+	unsigned int *counter;
+
+	counter = calloc(LINEAR_ENGINE_FUNC(COUNTER_SIZE), sizeof(unsigned int));
+	if (counter == NULL)
+		return -1;
+	LINEAR_ENGINE_KEY_SETUP(key, &schedule);
+	LINEAR_ENGINE_FUNC(count)(plain, (const LINEAR_ENGINE_SCHEDULE *)&schedule, counter, number_of_plains);
+	LINEAR_ENGINE_FUNC(evaluate)(counter, count_T0, count_T1);
+	free(counter);
+	linear_engine_rank(count_T0, count_T1, LINEAR_ENGINE_FUNC(KEYGUESSES), number_of_plains, candidates);
+	return candidates[0].guess;
+}
+
+#undef LINEAR_ENGINE_NAME
+#undef LINEAR_ENGINE_BLOCK
+#undef LINEAR_ENGINE_SCHEDULE
+#undef LINEAR_ENGINE_KEY_SETUP
+#undef LINEAR_ENGINE_ENCRYPT_BLOCKS
+#undef LINEAR_ENGINE_PARITY
+#undef LINEAR_ENGINE_ACTIVE_BITS
+#undef LINEAR_ENGINE_EXTRACT
+#undef LINEAR_ENGINE_GUESS_BITS
+#undef LINEAR_ENGINE_PARTIAL_DECRYPT
+#undef LINEAR_ENGINE_PLAIN_MASK
+#undef LINEAR_ENGINE_CIPHER_MASK
+#undef LINEAR_ENGINE_PARTIAL_MASK
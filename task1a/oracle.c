@@ -0,0 +1,111 @@
+/*********************************************************************
+* Filename:   oracle.c
+* Copyright:
+* Disclaimer: This code is presented "as is" without any guarantees.
+* Details:    Command line front end of the encryption oracle. "serve"
+              runs the oracle with the key dataset_key(key id) until
+              SIGINT or SIGTERM. "bench" collects texts from a running
+              oracle with the pipelined client, counts the left side of
+              the approximation for the round count like algorithm 1
+              and reports the collection and the counting cost apart.
+              Usage: oracle serve <socket> [rounds] [key id]
+                     oracle bench <socket> [rounds] [texts] [batch] [depth]
+*********************************************************************/
+
+/*************************** HEADER FILES ***************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <signal.h>
+#include <unistd.h>
+#include "des.h"
+#include "des_dataset.h"
+#include "des_oracle.h"
+
+/**************************** DATA TYPES ****************************/
+typedef struct {
+	int rounds;
+	unsigned int count_T0;
+	unsigned int count_T1;
+} BENCH_COUNTS;
+
+/**************************** VARIABLES *****************************/
+static const BYTE bench_seed[DES_BLOCK_SIZE] = {0x4F,0x52,0x41,0x43,0x4C,0x45,0x30,0x31};
+
+/*********************** FUNCTION DEFINITIONS ***********************/
+static void bench_consume(const BYTE plain[][DES_BLOCK_SIZE], const BYTE cipher[][DES_BLOCK_SIZE], int number_of_plains, void *arg)
+{
+	BENCH_COUNTS *counts = arg;
+	BYTE keyguess[6] = {0x00,0x00,0x00,0x00,0x00,0x00};
+
+	count_left_side(plain, cipher, &counts->count_T0, &counts->count_T1, number_of_plains, counts->rounds, keyguess);
+}
+
+static int serve(const char *path, int rounds, QWORD key_id)
+{
+	ORACLE_SERVER server;
+	BYTE key[DES_BLOCK_SIZE];
+	sigset_t signals;
+	int received;
+
+	// the server threads inherit the blocked signals, only sigwait() gets them
+	sigemptyset(&signals);
+	sigaddset(&signals, SIGINT);
+	sigaddset(&signals, SIGTERM);
+	pthread_sigmask(SIG_BLOCK, &signals, NULL);
+
+	dataset_key(key_id, key);
+	if (oracle_start(&server, path, key, rounds) != 0) {
+		printf("ERROR: could not listen on %s\n", path);
+		return 1;
+	}
+	printf("Oracle for %d round DES with key %llu listening on %s\n", rounds, key_id, path);
+	fflush(stdout);
+	sigwait(&signals, &received);
+
+	oracle_stop(&server);
+	printf("Answered %llu requests with %llu blocks\n", server.requests, server.blocks);
+	return 0;
+}
+
+static int bench(const char *path, int rounds, int number_of_plains, int batch, int depth)
+{
+	ORACLE_STATS stats;
+	BENCH_COUNTS counts;
+	int fd;
+
+	fd = oracle_connect(path);
+	if (fd < 0) {
+		printf("ERROR: no oracle on %s\n", path);
+		return 1;
+	}
+	counts.rounds = rounds;
+	counts.count_T0 = 0;
+	counts.count_T1 = 0;
+	if (oracle_collect(fd, bench_seed, number_of_plains, batch, depth, bench_consume, &counts, &stats) != 0) {
+		printf("ERROR: the oracle stopped answering\n");
+		close(fd);
+		return 1;
+	}
+	close(fd);
+
+	printf("Collected %llu blocks in %llu requests in %.3f s: %.2f Mblocks/s\n", stats.blocks, stats.requests, stats.seconds, stats.blocks / stats.seconds / 1e6);
+	printf("\tlatency per request: mean %.3f ms, max %.3f ms\n", 1e3 * stats.latency_mean, 1e3 * stats.latency_max);
+	printf("\twaiting for responses %.3f s, counting %.3f s\n", stats.wait_seconds, stats.consume_seconds);
+	printf("\tT0: %u - T1: %u\n", counts.count_T0, counts.count_T1);
+	return 0;
+}
+
+int main(int argc, char *argv[])
+{
+	int rounds = (argc > 3) ? atoi(argv[3]) : 7;
+
+	if (argc > 2 && strcmp(argv[1], "serve") == 0 && rounds >= 1 && rounds <= 16)
+		return serve(argv[2], rounds, (argc > 4) ? strtoull(argv[4], NULL, 0) : 0);
+	if (argc > 2 && strcmp(argv[1], "bench") == 0 && rounds >= 1 && rounds <= 16)
+		return bench(argv[2], rounds, (argc > 4) ? atoi(argv[4]) : 1 << 20, (argc > 5) ? atoi(argv[5]) : ORACLE_BATCH,
+		             (argc > 6) ? atoi(argv[6]) : ORACLE_DEPTH);
+	printf("Usage: %s serve <socket> [rounds] [key id]\n", argv[0]);
+	printf("       %s bench <socket> [rounds] [texts] [batch] [depth]\n", argv[0]);
+	return 1;
+}
@@ -0,0 +1,108 @@
+/*********************************************************************
+* Filename:   rainbow.c
+* Copyright:
+* Disclaimer: This code is presented "as is" without any guarantees.
+* Details:    Builds rainbow tables for a reduced DES key space (see
+              des_rainbow.h) on all cores and measures the lookups
+              against random keys of that space.
+              Usage: rainbow build <file> [key bits] [chain length]
+                                   [chains per table] [tables]
+                                   [rounds] [threads]
+                     rainbow lookup <file> [keys]
+*********************************************************************/
+
+/*************************** HEADER FILES ***************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "des.h"
+#include "des_linear.h"
+#include "des_parallel.h"
+#include "des_rainbow.h"
+#include "des_stream.h"
+#include "des_table.h"
+
+/**************************** VARIABLES *****************************/
+// the chosen plaintext of the tables and the seed of the keys of the lookups
+static const BYTE chosen_plain[DES_BLOCK_SIZE] = {0x4E,0x6F,0x77,0x20,0x69,0x73,0x20,0x74};
+static const BYTE key_seed[DES_BLOCK_SIZE] = {0x52,0x41,0x49,0x4E,0x42,0x4F,0x57,0x31};
+static const QWORD base_key = 0x0123456789ABCDEFULL;
+
+/*********************** FUNCTION DEFINITIONS ***********************/
+static void key_bytes(QWORD word, BYTE key[])
+{
+	int i;
+
+	for (i = DES_BLOCK_SIZE - 1; i >= 0; --i, word >>= 8)
+		key[i] = word & 0xFF;
+}
+
+static int build(int argc, char *argv[])
+{
+	int key_bits = (argc > 3) ? atoi(argv[3]) : 24;
+	int chain_length = (argc > 4) ? atoi(argv[4]) : 512;
+	int chains = (argc > 5) ? atoi(argv[5]) : 1 << 14;
+	int tables = (argc > 6) ? atoi(argv[6]) : 4;
+	int rounds = (argc > 7) ? atoi(argv[7]) : 16;
+	int threads = parallel_threads((argc > 8) ? atoi(argv[8]) : 0);
+	RAINBOW_BUILD_STATS stats;
+
+	printf("Building %d tables of %d chains of length %d for %d key bits of %d round DES with %d threads...\n",
+	       tables, chains, chain_length, key_bits, rounds, threads);
+	if (rainbow_build(argv[2], chosen_plain, base_key, key_bits, rounds, chain_length, chains, tables, threads, &stats) != 0) {
+		printf("ERROR: could not build %s\n", argv[2]);
+		return 1;
+	}
+	printf("Done in %.2f s (%.2f M encryptions/s)\n", stats.seconds, stats.encryptions / stats.seconds / 1e6);
+	printf("%llu distinct ends of %llu chains, expected coverage %.2f%%\n", stats.number_of_entries, (QWORD)tables * chains, 100 * stats.coverage);
+	return 0;
+}
+
+static int lookup(int argc, char *argv[])
+{
+	int number_of_keys = (argc > 3) ? atoi(argv[3]) : 100;
+	RAINBOW_TABLE table;
+	RAINBOW_LOOKUP_STATS stats;
+	BYTE index[1][DES_BLOCK_SIZE], key[DES_BLOCK_SIZE], found[DES_BLOCK_SIZE], schedule[16][6], cipher[DES_BLOCK_SIZE];
+	const RAINBOW_HEADER *header;
+	int i, wrong = 0;
+
+	if (rainbow_open(argv[2], &table) != 0) {
+		printf("ERROR: %s is no rainbow table file\n", argv[2]);
+		return 1;
+	}
+	header = table.header;
+	printf("%d tables, %llu entries, chains of length %d for %d key bits of %d round DES, expected coverage %.2f%%\n",
+	       header->number_of_tables, header->number_of_entries, header->chain_length, header->key_bits, header->rounds,
+	       100 * rainbow_table_coverage(header->key_bits, header->chain_length, table.offset, header->number_of_tables));
+
+	memset(&stats, 0, sizeof(stats));
+	for (i = 0; i < number_of_keys; ++i) {
+		counter_plaintexts(key_seed, i, 1, index);
+		key_bytes(rainbow_key(header->base_key, header->key_bits, block_to_qword(index[0])), key);
+		des_key_setup_table(key, schedule, DES_ENCRYPT, header->rounds);
+		des_crypt_table(header->plain, cipher, (const BYTE (*)[6])schedule, header->rounds);
+		if (rainbow_lookup(&table, cipher, found, &stats)) {
+			des_key_setup_table(found, schedule, DES_ENCRYPT, header->rounds);
+			des_crypt_table(header->plain, found, (const BYTE (*)[6])schedule, header->rounds);
+			wrong += (memcmp(found, cipher, DES_BLOCK_SIZE) != 0);
+		}
+	}
+	rainbow_close(&table);
+
+	printf("Found %llu of %llu keys (%.2f%%), %d wrong\n", stats.found, stats.lookups, 100.0 * stats.found / stats.lookups, wrong);
+	printf("Per lookup: %.3f ms, %.0f encryptions, %.2f false alarms\n", 1e3 * stats.seconds / stats.lookups,
+	       (double)stats.encryptions / stats.lookups, (double)stats.false_alarms / stats.lookups);
+	return 0;
+}
+
+int main(int argc, char *argv[])
+{
+	if (argc > 2 && strcmp(argv[1], "build") == 0)
+		return build(argc, argv);
+	if (argc > 2 && strcmp(argv[1], "lookup") == 0)
+		return lookup(argc, argv);
+	printf("Usage: %s build <file> [key bits 1-56] [chain length] [chains per table] [tables] [rounds 1-16] [threads]\n", argv[0]);
+	printf("       %s lookup <file> [keys]\n", argv[0]);
+	return 1;
+}
@@ -0,0 +1,122 @@
+/*********************************************************************
+* Filename:   shard.c
+* Copyright:
+* Disclaimer: This code is presented "as is" without any guarantees.
+* Details:    Runs the 8 round attack split over independent processes
+              (see des_shard.h). Every worker counts one range of text
+              indices into a counter file, merge sums the counter files
+              and ranks the guesses for the bits 42-47 of K8.
+              Usage: shard work <counter file> <first index> <texts>
+                                [key id] [seed as 16 hex digits] [threads]
+                     shard merge <counter file>...
+*********************************************************************/
+
+/*************************** HEADER FILES ***************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "des.h"
+#include "des_dataset.h"
+#include "des_shard.h"
+#include "des_table.h"
+
+/*********************** FUNCTION DEFINITIONS ***********************/
+static int usage(const char *program)
+{
+	printf("Usage: %s work <counter file> <first index> <texts> [key id] [seed as 16 hex digits] [threads]\n", program);
+	printf("       %s merge <counter file>...\n", program);
+	return 1;
+}
+
+static int work(int argc, char *argv[])
+{
+	QWORD first_index = strtoull(argv[3], NULL, 0);
+	QWORD number_of_texts = strtoull(argv[4], NULL, 0);
+	QWORD key_id = (argc > 5) ? strtoull(argv[5], NULL, 0) : 0;
+	QWORD seed_word = (argc > 6) ? strtoull(argv[6], NULL, 16) : 0x0855A27887DD2CBCULL;
+	int threads = (argc > 7) ? atoi(argv[7]) : 0;
+	BYTE seed[DES_BLOCK_SIZE];
+	SHARD_COUNTERS shard;
+	struct timespec start, end;
+	double seconds;
+	int i;
+
+	if (number_of_texts == 0)
+		return usage(argv[0]);
+	for (i = 0; i < DES_BLOCK_SIZE; ++i)
+		seed[i] = (seed_word >> (8 * (7 - i))) & 0xFF;
+
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	if (shard_count(key_id, seed, first_index, number_of_texts, threads, &shard) != 0 || shard_write(argv[2], &shard) != 0) {
+		printf("ERROR: could not count the shard into %s\n", argv[2]);
+		return 1;
+	}
+	clock_gettime(CLOCK_MONOTONIC, &end);
+	seconds = (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) / 1e9;
+	printf("Counted texts %llu-%llu into %s in %.2f s (%.2f Mtexts/s)\n", first_index, first_index + number_of_texts - 1,
+	       argv[2], seconds, number_of_texts / seconds / 1e6);
+	return 0;
+}
+
+static int merge(int argc, char *argv[])
+{
+	int number_of_shards = argc - 2;
+	SHARD_COUNTERS *shards, total;
+	KEY_CANDIDATE candidates[64];
+	BYTE key[DES_BLOCK_SIZE], schedule[8][6];
+	QWORD end;
+	int s, i, actual;
+
+	if (number_of_shards < 1)
+		return usage(argv[0]);
+	shards = malloc(number_of_shards * sizeof(SHARD_COUNTERS));
+	if (shards == NULL)
+		return 1;
+	for (s = 0; s < number_of_shards; ++s) {
+		if (shard_read(argv[2 + s], &shards[s]) != 0) {
+			printf("ERROR: %s is not a complete counter file\n", argv[2 + s]);
+			free(shards);
+			return 1;
+		}
+	}
+	if (shard_merge(shards, number_of_shards, &total) != 0) {
+		printf("ERROR: the shards overlap or belong to different keys or seeds\n");
+		free(shards);
+		return 1;
+	}
+	// the shards are disjoint, every index of the span not counted is in a gap
+	end = 0;
+	for (s = 0; s < number_of_shards; ++s) {
+		if (shards[s].header.first_index + shards[s].header.number_of_texts > end)
+			end = shards[s].header.first_index + shards[s].header.number_of_texts;
+	}
+	free(shards);
+	printf("Merged %d shards: %llu texts of key %llu", number_of_shards, total.header.number_of_texts, total.header.key_id);
+	if (end - total.header.first_index > total.header.number_of_texts)
+		printf(", %llu texts missing in gaps", end - total.header.first_index - total.header.number_of_texts);
+	printf("\n");
+	if (shard_keyguess(&total, candidates) != 0)
+		return 1;
+
+	dataset_key(total.header.key_id, key);
+	des_key_setup_table(key, schedule, DES_ENCRYPT, 8);
+	actual = schedule[7][0] >> 2;
+	printf("Best ranked guesses for the bits 42-47 of K8:");
+	for (i = 0; i < 4; ++i)
+		printf(" %02X (%+f)", candidates[i].guess, candidates[i].bias);
+	printf("\n");
+	for (i = 0; i < 64 && candidates[i].guess != actual; ++i)
+		;
+	printf("Actual bits 42-47 of K8: %02X, rank %d\n", actual, i + 1);
+	return 0;
+}
+
+int main(int argc, char *argv[])
+{
+	if (argc > 4 && strcmp(argv[1], "work") == 0)
+		return work(argc, argv);
+	if (argc > 2 && strcmp(argv[1], "merge") == 0)
+		return merge(argc, argv);
+	return usage(argv[0]);
+}
@@ -0,0 +1,65 @@
+/*********************************************************************
+* Filename:   spn.c
+* Copyright:
+* Disclaimer: This code is presented "as is" without any guarantees.
+* Details:    The 16 bit substitution-permutation network of Heys'
+              tutorial, a small cipher for the cipher independent
+              linear attack (linear_engine.h).
+*********************************************************************/
+
+/*************************** HEADER FILES ***************************/
+#include "spn.h"
+
+/**************************** VARIABLES *****************************/
+const BYTE spn_sbox[16] = {
+	0xE, 0x4, 0xD, 0x1, 0x2, 0xF, 0xB, 0x8, 0x3, 0xA, 0x6, 0xC, 0x5, 0x9, 0x0, 0x7
+};
+
+const BYTE spn_sbox_inverse[16] = {
+	0xE, 0x3, 0x4, 0x8, 0x1, 0xC, 0xA, 0xF, 0x7, 0xD, 0x9, 0x6, 0xB, 0x2, 0x0, 0x5
+};
+
+/*********************** FUNCTION DEFINITIONS ***********************/
+static WORD substitute(WORD x)
+{
+	return (spn_sbox[x >> 12] << 12) | (spn_sbox[(x >> 8) & 0xF] << 8) | (spn_sbox[(x >> 4) & 0xF] << 4) | spn_sbox[x & 0xF];
+}
+
+// Bit j of S-Box i goes to bit i of S-Box j
+static WORD transpose(WORD x)
+{
+	WORD y = 0;
+	int i, j;
+
+	for (i = 0; i < 4; ++i) {
+		for (j = 0; j < 4; ++j)
+			y |= ((x >> (15 - 4 * i - j)) & 0x01) << (15 - 4 * j - i);
+	}
+	return y;
+}
+
+void spn_key_setup(const BYTE key[], WORD schedule[])
+{
+	int i;
+
+	for (i = 0; i <= SPN_ROUNDS; ++i)
+		schedule[i] = (key[2 * i] << 8) | key[2 * i + 1];
+}
+
+WORD spn_encrypt(WORD plain, const WORD schedule[])
+{
+	WORD x = plain;
+	int i;
+
+	for (i = 0; i < SPN_ROUNDS - 1; ++i)
+		x = transpose(substitute(x ^ schedule[i]));
+	return substitute(x ^ schedule[SPN_ROUNDS - 1]) ^ schedule[SPN_ROUNDS];
+}
+
+void spn_encrypt_blocks(const WORD plain[], WORD cipher[], const WORD schedule[], int number_of_blocks)
+{
+	int i;
+
+	for (i = 0; i < number_of_blocks; ++i)
+		cipher[i] = spn_encrypt(plain[i], schedule);
+}
@@ -0,0 +1,33 @@
+/*********************************************************************
+* Filename:   spn.h
+* Copyright:
+* Disclaimer: This code is presented "as is" without any guarantees.
+* Details:    Defines the API for the 16 bit substitution-permutation
+              network of Heys' tutorial on linear and differential
+              cryptanalysis: 4 rounds of key mixing, four 4 bit S-Boxes
+              and a bit transposition (no transposition in round 4),
+              then a last key mixing with K5. The 5 subkeys are taken
+              from the 10 key bytes, byte 0 in the highest bits of K1.
+              Bit 1 of a block is the highest bit like in the tutorial.
+*********************************************************************/
+
+#ifndef SPN_H
+#define SPN_H
+
+/*************************** HEADER FILES ***************************/
+#include "des.h"
+
+/****************************** MACROS ******************************/
+#define SPN_ROUNDS 4
+#define SPN_KEY_SIZE (2 * (SPN_ROUNDS + 1))
+
+/**************************** VARIABLES *****************************/
+extern const BYTE spn_sbox[16];
+extern const BYTE spn_sbox_inverse[16];
+
+/*********************** FUNCTION DECLARATIONS **********************/
+void spn_key_setup(const BYTE key[], WORD schedule[]);
+WORD spn_encrypt(WORD plain, const WORD schedule[]);
+void spn_encrypt_blocks(const WORD plain[], WORD cipher[], const WORD schedule[], int number_of_blocks);
+
+#endif   // SPN_H
@@ -0,0 +1,374 @@
+/*********************************************************************
+* Filename:   trail_search.c
+* Copyright:
+* Disclaimer: This code is presented "as is" without any guarantees.
+* Details:    Searches the best linear characteristics of the
+              reduced-round DES from des.c with Matsui's branch and
+              bound algorithm and writes them in the format of
+              load_approximations(). The weight of a characteristic is
+              -log2 of its correlation (2 * bias), so the weights of
+              the S-Box approximations are added up. The best weight W_k
+              of every shorter round count bounds the rounds that are
+              still to be chosen.
+              Usage: trail_search [max rounds] [output file] [threads]
+*********************************************************************/
+
+/*************************** HEADER FILES ***************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <pthread.h>
+#include "des.h"
+#include "des_linear.h"
+#include "des_parallel.h"
+
+/****************************** MACROS ******************************/
+#define MAX_ROUNDS 16
+#define WEIGHT_EPSILON 1e-9
+#define WEIGHT_STEP 0.5                 // the bound is raised by this much until a characteristic is found
+
+/**************************** DATA TYPES ****************************/
+// Approximation of one S-Box: input mask a, output mask b
+typedef struct {
+	BYTE a;
+	BYTE b;
+	signed char sign;
+	double weight;
+} SBOX_APPROX;
+
+// Approximation of one round: X.R ^ Y.F(R,K) = K[k]
+typedef struct {
+	WORD x;
+	WORD y;
+	QWORD k;
+	signed char sign;
+	double weight;
+} ROUND_APPROX;
+
+typedef struct {
+	int rounds;
+	double bound;                       // weight of the best characteristic so far (or the estimate)
+	int found;
+	ROUND_APPROX best[MAX_ROUNDS + 1];
+	ROUND_APPROX *first;                // candidates for round 1, grown while they are collected
+	int number_of_first;
+	int capacity;
+	int out_of_memory;
+	pthread_mutex_t lock;
+} SEARCH_SHARED;
+
+typedef struct {
+	SEARCH_SHARED *shared;
+	ROUND_APPROX trail[MAX_ROUNDS + 1]; // 1-based
+	int collect;                        // only collect the round 1 candidates
+} SEARCH;
+
+/**************************** VARIABLES *****************************/
+static SBOX_APPROX sbox_all[8][64 * 15];        // all approximations with b != 0, sorted by weight
+static int sbox_all_count[8];
+static SBOX_APPROX sbox_out[8][16][64];         // approximations for a fixed b, sorted by weight
+static int sbox_out_count[8][16];
+static double sbox_min_weight[8][16];
+static double best_weight[MAX_ROUNDS + 1];      // W_k, index 0 and 1 are 0 (a suffix may end inactive)
+
+/*********************** FUNCTION DEFINITIONS ***********************/
+static int compare_weight(const void *a, const void *b)
+{
+	const SBOX_APPROX *sa = a, *sb = b;
+
+	if (sa->weight != sb->weight)
+		return sa->weight < sb->weight ? -1 : 1;
+	return (sa->a << 4 | sa->b) - (sb->a << 4 | sb->b);
+}
+
+// Linear approximation tables of sbox1..sbox8
+static void build_tables(void)
+{
+	int s, a, b, count;
+	SBOX_APPROX approx;
+
+	for (s = 0; s < 8; ++s) {
+		sbox_all_count[s] = 0;
+		for (b = 1; b < 16; ++b) {
+			sbox_out_count[s][b] = 0;
+			for (a = 0; a < 64; ++a) {
+				count = sbox_lat(s + 1, a, b);
+				if (count == 0)
+					continue;
+				approx.a = a;
+				approx.b = b;
+				approx.sign = count > 0 ? 1 : -1;
+				approx.weight = -log2(fabs(count / 32.0));
+				sbox_all[s][sbox_all_count[s]++] = approx;
+				sbox_out[s][b][sbox_out_count[s][b]++] = approx;
+			}
+			qsort(sbox_out[s][b], sbox_out_count[s][b], sizeof(SBOX_APPROX), compare_weight);
+			sbox_min_weight[s][b] = sbox_out[s][b][0].weight;
+		}
+		sbox_min_weight[s][0] = 0;
+		qsort(sbox_all[s], sbox_all_count[s], sizeof(SBOX_APPROX), compare_weight);
+	}
+}
+
+static double current_bound(SEARCH_SHARED *shared)
+{
+	double bound;
+
+	__atomic_load(&shared->bound, &bound, __ATOMIC_RELAXED);
+	return bound;
+}
+
+static void record_trail(SEARCH *s, double weight)
+{
+	SEARCH_SHARED *shared = s->shared;
+
+	pthread_mutex_lock(&shared->lock);
+	if (weight < shared->bound - WEIGHT_EPSILON || (!shared->found && weight <= shared->bound + WEIGHT_EPSILON)) {
+		memcpy(shared->best, s->trail, sizeof(s->trail));
+		shared->found = 1;
+		__atomic_store(&shared->bound, &weight, __ATOMIC_RELAXED);
+	}
+	pthread_mutex_unlock(&shared->lock);
+}
+
+static void search_round(SEARCH *s, int i, double w_acc);
+
+// Room for one more round 1 candidate, the candidates are collected by one thread
+static int grow_first(SEARCH_SHARED *shared)
+{
+	ROUND_APPROX *first;
+
+	if (shared->out_of_memory)
+		return -1;
+	if (shared->number_of_first == shared->capacity) {
+		first = realloc(shared->first, 2 * (size_t)shared->capacity * sizeof(ROUND_APPROX));
+		if (first == NULL) {
+			shared->out_of_memory = 1;
+			return -1;
+		}
+		shared->first = first;
+		shared->capacity *= 2;
+	}
+	return 0;
+}
+
+// Chooses the approximations of the S-Boxes j..7 of round i. In rounds 1 and 2 the
+// output masks are free, later rounds have to produce the output mask "target".
+static void choose_sbox(SEARCH *s, int i, int j, WORD target, QWORD a, WORD b, int sign, double w_round, double w_acc)
+{
+	const SBOX_APPROX *list;
+	double rest = 0;
+	int count, n, bj, free_round = (i <= 2);
+	ROUND_APPROX *round;
+
+	if (j == 8) {
+		round = &s->trail[i];
+		round->x = linear_expansion_mask(a);
+		round->y = linear_pbox_mask(b);
+		round->k = a;
+		round->sign = sign;
+		round->weight = w_round;
+		if (i == 1 && s->collect && s->shared->rounds > 1) {
+			if (grow_first(s->shared) == 0)
+				s->shared->first[s->shared->number_of_first++] = *round;
+			return;
+		}
+		// two inactive rounds in a row continue as the all-zero characteristic
+		if ((i == 2 && s->trail[1].y == 0 && b == 0) || (s->shared->rounds == 1 && b == 0))
+			return;
+		search_round(s, i + 1, w_acc + w_round);
+		return;
+	}
+
+	if (free_round) {
+		choose_sbox(s, i, j + 1, target, a, b, sign, w_round, w_acc);
+		list = sbox_all[j];
+		count = sbox_all_count[j];
+	}
+	else {
+		bj = (target >> (4 * (7 - j))) & 0x0F;
+		if (bj == 0) {
+			choose_sbox(s, i, j + 1, target, a, b, sign, w_round, w_acc);
+			return;
+		}
+		for (n = j + 1; n < 8; ++n)
+			rest += sbox_min_weight[n][(target >> (4 * (7 - n))) & 0x0F];
+		list = sbox_out[j][bj];
+		count = sbox_out_count[j][bj];
+	}
+
+	for (n = 0; n < count; ++n) {
+		if (w_acc + w_round + list[n].weight + rest + best_weight[s->shared->rounds - i] > current_bound(s->shared) + WEIGHT_EPSILON)
+			break;
+		choose_sbox(s, i, j + 1, target,
+		            a | ((QWORD)list[n].a << (6 * (7 - j))),
+		            b | ((WORD)list[n].b << (4 * (7 - j))),
+		            sign * list[n].sign, w_round + list[n].weight, w_acc);
+	}
+}
+
+static void search_round(SEARCH *s, int i, double w_acc)
+{
+	WORD y;
+
+	if (i > s->shared->rounds) {
+		record_trail(s, w_acc);
+		return;
+	}
+	if (i <= 2) {
+		choose_sbox(s, i, 0, 0, 0, 0, 1, 0, w_acc);
+		return;
+	}
+	// the masks on R_(i-2) have to cancel: Y_i = X_(i-1) ^ Y_(i-2)
+	y = s->trail[i-1].x ^ s->trail[i-2].y;
+	choose_sbox(s, i, 0, linear_pbox_inverse_mask(y), 0, 0, 1, 0, w_acc);
+}
+
+// Completes round 1 candidate "item", arg is the array of the per-thread searches
+static int search_first(void *arg, int worker, QWORD item)
+{
+	SEARCH *s = (SEARCH *)arg + worker;
+	SEARCH_SHARED *shared = s->shared;
+
+	s->trail[1] = shared->first[item];
+	if (s->trail[1].weight + best_weight[shared->rounds - 1] > current_bound(shared) + WEIGHT_EPSILON)
+		return 0;
+	search_round(s, 2, s->trail[1].weight);
+	return 0;
+}
+
+// Best characteristic for "rounds" rounds, best_weight[] must be known for all shorter ones
+static int search(int rounds, int threads, ROUND_APPROX best[])
+{
+	SEARCH_SHARED shared;
+	SEARCH search[PARALLEL_MAX_THREADS];
+	int t;
+
+	memset(&shared, 0, sizeof(shared));
+	shared.rounds = rounds;
+	shared.bound = best_weight[rounds - 1] + WEIGHT_STEP;
+	shared.capacity = 1 << 20;
+	shared.first = malloc(shared.capacity * sizeof(ROUND_APPROX));
+	if (shared.first == NULL)
+		return -1;
+	pthread_mutex_init(&shared.lock, NULL);
+
+	while (!shared.found) {
+		// round 1 candidates for the current bound, a round 1 beyond the bound can't be completed
+		memset(&search[0], 0, sizeof(SEARCH));
+		search[0].shared = &shared;
+		search[0].collect = 1;
+		shared.number_of_first = 0;
+		choose_sbox(&search[0], 1, 0, 0, 0, 0, 1, 0, 0);
+		// a search over part of the round 1 candidates could miss the best characteristic
+		if (shared.out_of_memory) {
+			pthread_mutex_destroy(&shared.lock);
+			free(shared.first);
+			return -1;
+		}
+
+		for (t = 0; t < threads; ++t) {
+			memset(&search[t], 0, sizeof(SEARCH));
+			search[t].shared = &shared;
+		}
+		parallel_run(search_first, search, shared.number_of_first, threads);
+
+		if (!shared.found)
+			shared.bound += WEIGHT_STEP;
+	}
+
+	memcpy(best, shared.best, sizeof(shared.best));
+	best_weight[rounds] = shared.bound;
+	pthread_mutex_destroy(&shared.lock);
+	free(shared.first);
+	return 0;
+}
+
+// P/C/K masks of a characteristic over "rounds" rounds, with the F term of round "rounds"+1 if last_round is set
+static void to_approximation(const ROUND_APPROX trail[], int rounds, int last_round, LINEAR_APPROXIMATION *approx)
+{
+	WORD y_before = (rounds >= 2) ? trail[rounds-1].y : 0;
+	WORD p_right = trail[1].x ^ ((rounds >= 2) ? trail[2].y : 0);
+	WORD c_right = trail[rounds].x ^ y_before;
+	int i;
+
+	memset(approx, 0, sizeof(LINEAR_APPROXIMATION));
+	approx->plain_mask = ((QWORD)trail[1].y << 32) | p_right;
+	for (i = 1; i <= rounds; ++i)
+		approx->key_mask[i-1] = trail[i].k;
+
+	if (!last_round) {
+		// no switch after the last round: C = (R_r, R_(r-1))
+		approx->rounds = rounds;
+		approx->cipher_mask = ((QWORD)trail[rounds].y << 32) | c_right;
+	}
+	else {
+		// R_r = C_L ^ F(C_R,K_(r+1)) and R_(r+1) = C_R
+		approx->rounds = rounds + 1;
+		approx->cipher_mask = ((QWORD)c_right << 32) | trail[rounds].y;
+		approx->fmask = c_right;
+	}
+}
+
+static double trail_bias(const ROUND_APPROX trail[], int rounds)
+{
+	int i, sign = 1;
+
+	for (i = 1; i <= rounds; ++i)
+		sign *= trail[i].sign;
+	return sign * pow(2.0, -best_weight[rounds] - 1);
+}
+
+int main(int argc, char *argv[])
+{
+	int max_rounds = (argc > 1) ? atoi(argv[1]) : MAX_ROUNDS;
+	const char *filename = (argc > 2) ? argv[2] : "approximations.txt";
+	int threads = parallel_threads((argc > 3) ? atoi(argv[3]) : 0);
+	ROUND_APPROX trails[MAX_ROUNDS + 1][MAX_ROUNDS + 1];
+	LINEAR_APPROXIMATION approx[2 * MAX_ROUNDS];
+	int number_of_approx = 0;
+	int r, i;
+	FILE *file;
+
+	if (max_rounds < 3 || max_rounds > MAX_ROUNDS) {
+		printf("ERROR: the number of rounds has to be 3..%d\n", MAX_ROUNDS);
+		return 1;
+	}
+	build_tables();
+
+	printf("Searching the best characteristics for 1-%d rounds with %d threads...\n", max_rounds, threads);
+	best_weight[0] = 0;
+	best_weight[1] = 0;
+	for (r = 1; r <= max_rounds; ++r) {
+		if (search(r, threads, trails[r]) != 0) {
+			printf("ERROR: out of memory\n");
+			return 1;
+		}
+		printf("%2d rounds: bias %+e (2^%.2f)\n", r, trail_bias(trails[r], r), -best_weight[r] - 1);
+		// a suffix of a characteristic may end with an inactive round, so W_1 only bounds as 0
+		if (r == 1)
+			best_weight[1] = 0;
+	}
+
+	for (r = 3; r <= max_rounds; ++r) {
+		to_approximation(trails[r], r, 0, &approx[number_of_approx++]);
+		to_approximation(trails[r-1], r-1, 1, &approx[number_of_approx++]);
+	}
+	if (save_approximations(filename, approx, number_of_approx) != 0) {
+		printf("ERROR: could not write %s\n", filename);
+		return 1;
+	}
+
+	// the bias of every line as a comment, load_approximations() skips it
+	file = fopen(filename, "a");
+	if (file != NULL) {
+		for (r = 3, i = 0; r <= max_rounds; ++r, i += 2) {
+			fprintf(file, "# approximation %d: %d rounds, bias %+e\n", i + 1, r, trail_bias(trails[r], r));
+			fprintf(file, "# approximation %d: %d rounds + F term of round %d, bias %+e\n", i + 2, r - 1, r, trail_bias(trails[r-1], r-1));
+		}
+		fclose(file);
+	}
+	printf("Wrote %d approximations to %s\n", number_of_approx, filename);
+	return 0;
+}